@@ -0,0 +1,137 @@
+#include "alloccounter.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif // _WIN32
+
+// The standard library's declarations of operator new changed in C++11, and
+// the replacements have to match whichever one the compiler uses.
+
+#if __cplusplus >= 201103L
+    #define ALLOC_THROWS_BAD_ALLOC
+    #define ALLOC_NO_THROW noexcept
+#else
+    #define ALLOC_THROWS_BAD_ALLOC throw(std::bad_alloc)
+    #define ALLOC_NO_THROW throw()
+#endif // __cplusplus
+
+//-----------------------------------------------------------------------------
+// Counters - Plain integers so they are ready before any constructors run.
+//-----------------------------------------------------------------------------
+
+#ifdef _WIN32
+    static volatile LONGLONG numAllocations = 0;
+    static volatile LONGLONG numBytes = 0;
+#else
+    static uint64_t numAllocations = 0;
+    static uint64_t numBytes = 0;
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// countAllocation - Record an allocation of the size given.
+///----------------------------------------------------------------------------
+
+static inline void countAllocation(const size_t& size) {
+#ifdef _WIN32
+    InterlockedIncrement64(&numAllocations);
+    InterlockedExchangeAdd64(&numBytes, static_cast<LONGLONG>(size));
+#else
+    __sync_fetch_and_add(&numAllocations, 1);
+    __sync_fetch_and_add(&numBytes, static_cast<uint64_t>(size));
+#endif // _WIN32
+}
+
+///----------------------------------------------------------------------------
+/// allocate - Allocate and count memory the way operator new must: a size of
+/// 0 still returns a unique pointer, and failure throws bad_alloc.
+///----------------------------------------------------------------------------
+
+static void* allocate(size_t size) {
+
+    countAllocation(size);
+
+    if(size == 0) {
+        size = 1;
+    }
+
+    void* memory = malloc(size);
+
+    if(memory == NULL) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// get - Get the number of allocations and bytes allocated so far. Subtract
+/// two snapshots to get what happened between them.
+/// @return the counts at the time of the call.
+///----------------------------------------------------------------------------
+
+AllocCounter::Snapshot AllocCounter::get() {
+
+    Snapshot snapshot;
+
+#ifdef _WIN32
+    snapshot.numAllocations = static_cast<uint64_t>(InterlockedCompareExchange64(&numAllocations, 0, 0));
+    snapshot.numBytes = static_cast<uint64_t>(InterlockedCompareExchange64(&numBytes, 0, 0));
+#else
+    snapshot.numAllocations = __sync_fetch_and_add(&numAllocations, 0);
+    snapshot.numBytes = __sync_fetch_and_add(&numBytes, 0);
+#endif // _WIN32
+
+    return snapshot;
+}
+
+//=============================================================================
+// Global operator new and delete replacements
+//=============================================================================
+
+void* operator new(size_t size) ALLOC_THROWS_BAD_ALLOC {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) ALLOC_THROWS_BAD_ALLOC {
+    return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) ALLOC_NO_THROW {
+    try {
+        return allocate(size);
+    }
+    catch(const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) ALLOC_NO_THROW {
+    try {
+        return allocate(size);
+    }
+    catch(const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void operator delete(void* memory) ALLOC_NO_THROW {
+    free(memory);
+}
+
+void operator delete[](void* memory) ALLOC_NO_THROW {
+    free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) ALLOC_NO_THROW {
+    free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) ALLOC_NO_THROW {
+    free(memory);
+}
@@ -0,0 +1,25 @@
+#ifndef __ALLOCCOUNTER_H__
+#define __ALLOCCOUNTER_H__
+
+#include "../compat/stdint_compat.h"
+
+///----------------------------------------------------------------------------
+/// AllocCounter - Counts every call to operator new made by the program, and
+/// how many bytes were asked for. The bench replaces the global operator new
+/// and delete to do this, so it only works in the bench itself. The counts
+/// are updated atomically, so allocations made on worker threads are
+/// included.
+///----------------------------------------------------------------------------
+
+namespace AllocCounter {
+
+    struct Snapshot {
+        uint64_t    numAllocations;
+        uint64_t    numBytes;
+    };
+
+    Snapshot get();
+
+}
+
+#endif // __ALLOCCOUNTER_H__
@@ -0,0 +1,322 @@
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchcases.h"
+#include "benchsuite.h"
+#include "benchtimer.h"
+#include "streamreader.h"
+#include "worldgenerator.h"
+#include "../model/gamemap.h"
+#include "../util/frost.h"
+#include "../compat/std_extras_compat.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <sys/stat.h>
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// bench - Runs the benchmark suite over a small, medium and max sized
+/// synthetic world, and writes the results to stdout as CSV. Given world
+/// files, it instead compares the stream based reader against the memory
+/// mapped one on each. With --generate, it only writes the synthetic worlds.
+///----------------------------------------------------------------------------
+
+namespace BenchDefaults {
+    const int Iterations            = 20;
+    const std::string WorldDirectory = "bench_worlds";
+    const uint32_t Seed             = 1;
+}
+
+namespace BenchSizes {
+    const int NumSizes              = 3;
+    const char* const Names[]       = { "SMALL", "MEDIUM", "MAX" };
+
+    // Keys in the JSON document parsed at each size. The built in language
+    // has about 300.
+    const int JsonKeys[]            = { 100, 1000, 10000 };
+}
+
+//=============================================================================
+// Reader Comparison
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// readMapStream - Load a world with the original ifstream reader, which
+/// only the bench still has.
+///----------------------------------------------------------------------------
+
+static void readMapStream(const std::string& filePath, const std::string& fileName) {
+    StreamWorldReader streamReader;
+    streamReader.readMap(filePath, fileName);
+}
+
+///----------------------------------------------------------------------------
+/// readMapMapped - Load a world with the memory mapped reader.
+///----------------------------------------------------------------------------
+
+static void readMapMapped(const std::string& filePath, const std::string& fileName) {
+    GameMap gameMap;
+    gameMap.readMap(filePath, fileName);
+}
+
+///----------------------------------------------------------------------------
+/// timeCase - Run the case given a number of times.
+/// @return the average time each run took in nanoseconds.
+///----------------------------------------------------------------------------
+
+static uint64_t timeCase(void (*benchCase)(const std::string&, const std::string&),
+                         const std::string& filePath, const std::string& fileName,
+                         const int& iterations) {
+
+    // Warm up the file cache so the first run is not an outlier.
+    benchCase(filePath, fileName);
+
+    BenchTimer timer;
+    timer.start();
+
+    for(int i = 0; i < iterations; ++i) {
+        benchCase(filePath, fileName);
+    }
+
+    return timer.getElapsed() / iterations;
+
+}
+
+//=============================================================================
+// Synthetic Worlds
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// makeDirectory - Create a directory if it does not exist yet.
+/// @param directory to create
+/// @throws runtime_error if it could not be created.
+///----------------------------------------------------------------------------
+
+static void makeDirectory(const std::string& directory) {
+
+#ifdef _WIN32
+    if(!CreateDirectoryA(directory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS) {
+#else
+    if(mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+#endif // _WIN32
+        throw std::runtime_error("Could not create the directory " + directory);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// generateWorlds - Write the SMALL, MEDIUM and MAX synthetic worlds.
+/// @param directory to write the worlds to
+/// @param seed to generate them with
+/// @return the directory, ending with a path separator.
+/// @throws runtime_error if any of the files could not be written.
+///----------------------------------------------------------------------------
+
+static std::string generateWorlds(const std::string& directory, const uint32_t& seed) {
+
+    makeDirectory(directory);
+
+    const std::string filePath = Frost::endsWith(directory, "/") || Frost::endsWith(directory, "\\") ?
+                                 directory : directory + "/";
+
+    const WorldGenerator::Settings worldSettings[BenchSizes::NumSizes] = { WorldGenerator::smallWorld(),
+                                                                           WorldGenerator::mediumWorld(),
+                                                                           WorldGenerator::maxWorld() };
+
+    for(int i = 0; i < BenchSizes::NumSizes; ++i) {
+        WorldGenerator::Settings settings = worldSettings[i];
+        settings.seed = seed;
+        WorldGenerator generator(settings);
+        generator.generate(filePath, BenchSizes::Names[i]);
+        fprintf(stderr, "Wrote %s%s.%s\n", filePath.c_str(), BenchSizes::Names[i],
+                AdventureGamerConstants::FileNameExtension.c_str());
+    }
+
+    return filePath;
+
+}
+
+//=============================================================================
+// Modes
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// runSuite - Generate the synthetic worlds and run every case on them.
+/// @return true if every case ran, false if any failed.
+/// @throws runtime_error if the worlds could not be generated.
+///----------------------------------------------------------------------------
+
+static bool runSuite(const std::string& directory, const uint32_t& seed, const int& iterations,
+                     const int& minTimeMS, const std::string& filter, FILE* outFile) {
+
+    const std::string filePath = generateWorlds(directory, seed);
+
+    BenchSuite suite;
+    suite.setIterations(iterations > 0 ? iterations : 0);
+    suite.setFilter(filter);
+
+    if(minTimeMS > 0) {
+        suite.setMinTime(static_cast<uint64_t>(minTimeMS) * 1000000);
+    }
+
+    for(int i = 0; i < BenchSizes::NumSizes; ++i) {
+        BenchCases::addWorldCases(suite, filePath, BenchSizes::Names[i]);
+        BenchCases::addFrostCases(suite, filePath, BenchSizes::Names[i]);
+        BenchCases::addJsonCases(suite, BenchSizes::Names[i], BenchSizes::JsonKeys[i]);
+    }
+
+    BenchCases::addDialogueCases(suite);
+    BenchCases::addLanguageCases(suite);
+
+    return suite.run(outFile);
+
+}
+
+///----------------------------------------------------------------------------
+/// compareReaders - Time the stream and mapped readers on each world given.
+/// @return true if every world could be read, false otherwise.
+///----------------------------------------------------------------------------
+
+static bool compareReaders(const std::vector<std::string>& worldFiles, const int& iterations) {
+
+    printf("%-40s %14s %14s %8s\n", "world", "stream ns/op", "mapped ns/op", "speedup");
+
+    for(size_t i = 0; i < worldFiles.size(); ++i) {
+
+        const std::string& fullPath = worldFiles[i];
+        const size_t separatorPos = fullPath.find_last_of("/\\");
+        const std::string filePath = (separatorPos == std::string::npos) ? "" : fullPath.substr(0, separatorPos + 1);
+        const std::string fileName = fullPath.substr(separatorPos == std::string::npos ? 0 : separatorPos + 1);
+
+        try {
+
+            const uint64_t streamTime = timeCase(readMapStream, filePath, fileName, iterations);
+            const uint64_t mappedTime = timeCase(readMapMapped, filePath, fileName, iterations);
+
+            printf("%-40s %14llu %14llu %7.2fx\n", fullPath.c_str(),
+                   static_cast<unsigned long long>(streamTime), static_cast<unsigned long long>(mappedTime),
+                   mappedTime ? static_cast<double>(streamTime) / mappedTime : 0.0);
+
+        }
+        catch(const std::exception& e) {
+            fprintf(stderr, "%s: %s\n", fullPath.c_str(), e.what());
+            return false;
+        }
+
+    }
+
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// printUsage - Print how to use the program
+///----------------------------------------------------------------------------
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: bench [options]\n"
+            "       bench [--iterations N] <world.SG0>...\n"
+            "       bench --generate <directory> [--seed N]\n"
+            "\n"
+            "With no worlds given, generates a SMALL, MEDIUM and MAX world and runs\n"
+            "the benchmark suite on them. Results are written to stdout as CSV:\n"
+            "case,size,iterations,ns_per_op,allocs_per_op,bytes_per_op,mb_per_s\n"
+            "\n"
+            "Given worlds, compares the stream and memory mapped readers on each.\n"
+            "\n"
+            "Options:\n"
+            "  --dir D          Directory to generate the worlds in (default: bench_worlds)\n"
+            "  --seed N         Seed to generate the worlds with (default: 1)\n"
+            "  --iterations N   Run each case N times (default: as many as fit in the\n"
+            "                   minimum time, or 20 when comparing readers)\n"
+            "  --min-time MS    Minimum time to run each case for (default: 250)\n"
+            "  --filter TEXT    Only run cases whose name contains TEXT\n"
+            "  --help           Show this message\n");
+}
+
+//=============================================================================
+// Entry Point
+//=============================================================================
+
+int main(int argc, char* argv[]) {
+
+    int iterations = 0;
+    int minTimeMS = 0;
+    uint32_t seed = BenchDefaults::Seed;
+    std::string worldDirectory = BenchDefaults::WorldDirectory;
+    std::string generateDirectory;
+    std::string filter;
+    std::vector<std::string> worldFiles;
+
+    try {
+
+        for(int i = 1; i < argc; ++i) {
+
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if((arg == "--iterations" || arg == "-n") && hasValue) {
+                iterations = std::stoi(argv[++i]);
+            }
+            else if(arg == "--min-time" && hasValue) {
+                minTimeMS = std::stoi(argv[++i]);
+            }
+            else if(arg == "--generate" && hasValue) {
+                generateDirectory = argv[++i];
+            }
+            else if(arg == "--dir" && hasValue) {
+                worldDirectory = argv[++i];
+            }
+            else if(arg == "--seed" && hasValue) {
+                seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if(arg == "--filter" && hasValue) {
+                filter = argv[++i];
+            }
+            else if(Frost::startsWith(arg, "-")) {
+                printUsage();
+                return 2;
+            }
+            else {
+                worldFiles.push_back(arg);
+            }
+
+        }
+
+    }
+    catch(const std::exception&) {
+        printUsage();
+        return 2;
+    }
+
+    if(iterations < 0 || minTimeMS < 0) {
+        printUsage();
+        return 2;
+    }
+
+    try {
+
+        if(!generateDirectory.empty()) {
+            generateWorlds(generateDirectory, seed);
+            return 0;
+        }
+
+        if(!worldFiles.empty()) {
+            return compareReaders(worldFiles, iterations ? iterations : BenchDefaults::Iterations) ? 0 : 1;
+        }
+
+        return runSuite(worldDirectory, seed, iterations, minTimeMS, filter, stdout) ? 0 : 1;
+
+    }
+    catch(const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+}
@@ -0,0 +1,1010 @@
+#include "benchcases.h"
+#include <sstream>
+#include <stdexcept>
+#include "benchsuite.h"
+#include "../model/gamemap.h"
+#include "../thirdparty/simpleson/json.h"
+#include "../util/frost.h"
+#include "../util/languagemapper.h"
+#include "../util/linescanner.h"
+#include "../util/mappedfile.h"
+#include "../util/worldstorage.h"
+#include "../compat/std_extras_compat.h"
+
+//=============================================================================
+// World Cases
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// WorldCase - A case that works on a world loaded from disk.
+///----------------------------------------------------------------------------
+
+class WorldCase : public BenchCase {
+
+    public:
+
+        WorldCase(const std::string& inName, const std::string& inFilePath, const std::string& inWorldName) :
+                  BenchCase(inName, inWorldName), filePath(inFilePath),
+                  fileName(inWorldName + "." + AdventureGamerConstants::FileNameExtension) {}
+
+        virtual void setUp() {
+            gameMap = GameMap();
+            gameMap.readMap(filePath, fileName);
+        }
+
+    protected:
+
+        std::string     filePath;
+        std::string     fileName;
+        GameMap         gameMap;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReadMapCase - GameMap::readMap, loading a world and all of its files. The
+/// number of threads it may use can be fixed, so reading on one thread can be
+/// compared against reading in parallel.
+///----------------------------------------------------------------------------
+
+class ReadMapCase : public WorldCase {
+
+    public:
+
+        ReadMapCase(const std::string& inFilePath, const std::string& inWorldName,
+                    const unsigned int& inNumThreads = 0) :
+                    WorldCase(inNumThreads ? "GameMap::readMap (" + std::to_string(static_cast<int>(inNumThreads)) +
+                              (inNumThreads == 1 ? " thread)" : " threads)") : "GameMap::readMap",
+                              inFilePath, inWorldName), numThreads(inNumThreads) {}
+
+        virtual void setUp() {
+            GameMap::setReadThreads(numThreads);
+        }
+
+        virtual void run() {
+            GameMap loadedMap;
+            loadedMap.readMap(filePath, fileName);
+        }
+
+        virtual void tearDown() {
+            GameMap::setReadThreads(0);
+        }
+
+    private:
+
+        unsigned int numThreads;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReadMapLazyCase - GameMap::readMap with lazy text, so only the numbers are
+/// parsed and none of the names or descriptions are decoded.
+///----------------------------------------------------------------------------
+
+class ReadMapLazyCase : public WorldCase {
+
+    public:
+
+        ReadMapLazyCase(const std::string& inFilePath, const std::string& inWorldName) :
+                        WorldCase("GameMap::readMap (lazy text)", inFilePath, inWorldName) {}
+
+        virtual void setUp() {}
+
+        virtual void run() {
+            GameMap loadedMap;
+            loadedMap.setLazyText(true);
+            loadedMap.readMap(filePath, fileName);
+        }
+
+};
+
+///----------------------------------------------------------------------------
+/// ScanMapCase - GameMap::scanMap, reading only the layout of a world. The
+/// same scan is reused, the way a tool going through many worlds would.
+///----------------------------------------------------------------------------
+
+class ScanMapCase : public WorldCase {
+
+    public:
+
+        ScanMapCase(const std::string& inFilePath, const std::string& inWorldName) :
+                    WorldCase("GameMap::scanMap", inFilePath, inWorldName) {}
+
+        virtual void setUp() {
+            GameMap::scanMap(filePath, fileName, mapScan);
+        }
+
+        virtual void run() {
+            GameMap::scanMap(filePath, fileName, mapScan);
+        }
+
+    private:
+
+        GameMapScan mapScan;
+
+};
+
+///----------------------------------------------------------------------------
+/// WriteMapCase - GameMap::writeMap, saving a whole world. It takes turns
+/// saving to two names, so every file is written each time instead of only
+/// the ones that changed.
+///----------------------------------------------------------------------------
+
+class WriteMapCase : public WorldCase {
+
+    public:
+
+        WriteMapCase(const std::string& inFilePath, const std::string& inWorldName) :
+                     WorldCase("GameMap::writeMap", inFilePath, inWorldName), writeCount(0) {
+
+            for(int i = 0; i < 2; ++i) {
+                outFileNames[i] = inWorldName + (i ? "_B." : "_A.") + AdventureGamerConstants::FileNameExtension;
+            }
+
+        }
+
+        virtual void run() {
+            gameMap.writeMap(filePath, outFileNames[writeCount++ & 1]);
+        }
+
+    private:
+
+        std::string     outFileNames[2];
+        unsigned int    writeCount;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReadMapMemoryCase - GameMap::readMap from a MemoryWorldStorage, so the time
+/// is only the parsing, without opening any files.
+///----------------------------------------------------------------------------
+
+class ReadMapMemoryCase : public WorldCase {
+
+    public:
+
+        ReadMapMemoryCase(const std::string& inFilePath, const std::string& inWorldName) :
+                          WorldCase("GameMap::readMap (memory)", inFilePath, inWorldName) {}
+
+        virtual void setUp() {
+            WorldCase::setUp();
+            storage.clear();
+            gameMap.writeMap(storage, fileName);
+        }
+
+        virtual void run() {
+            GameMap loadedMap;
+            loadedMap.readMap(storage, fileName);
+        }
+
+    private:
+
+        MemoryWorldStorage storage;
+
+};
+
+///----------------------------------------------------------------------------
+/// WriteMapMemoryCase - GameMap::writeMap to a MemoryWorldStorage. Like
+/// WriteMapCase, it takes turns between two storages so every part is
+/// written each time.
+///----------------------------------------------------------------------------
+
+class WriteMapMemoryCase : public WorldCase {
+
+    public:
+
+        WriteMapMemoryCase(const std::string& inFilePath, const std::string& inWorldName) :
+                           WorldCase("GameMap::writeMap (memory)", inFilePath, inWorldName), writeCount(0) {}
+
+        virtual void run() {
+            gameMap.writeMap(storages[writeCount++ & 1], fileName);
+        }
+
+    private:
+
+        MemoryWorldStorage  storages[2];
+        unsigned int        writeCount;
+
+};
+
+///----------------------------------------------------------------------------
+/// ResizeMapCase - GameMap::resizeMap. Each operation shrinks the world by a
+/// row and a column and then grows it back, as the largest world cannot be
+/// made any bigger.
+///----------------------------------------------------------------------------
+
+class ResizeMapCase : public WorldCase {
+
+    public:
+
+        ResizeMapCase(const std::string& inFilePath, const std::string& inWorldName) :
+                      WorldCase("GameMap::resizeMap", inFilePath, inWorldName) {}
+
+        virtual void run() {
+            const int numRows = gameMap.getHeight();
+            const int numCols = gameMap.getWidth();
+            gameMap.resizeMap(numRows - 1, numCols - 1);
+            gameMap.resizeMap(numRows, numCols);
+        }
+
+};
+
+///----------------------------------------------------------------------------
+/// ValidateTilesCase - GameMap::validateTileDirections over the whole world.
+///----------------------------------------------------------------------------
+
+class ValidateTilesCase : public WorldCase {
+
+    public:
+
+        ValidateTilesCase(const std::string& inFilePath, const std::string& inWorldName) :
+                          WorldCase("GameMap::validateTileDirections", inFilePath, inWorldName), result(0) {}
+
+        virtual void run() {
+            result += gameMap.validateTileDirections();
+        }
+
+    private:
+
+        // Kept so the call cannot be optimized away.
+        int result;
+
+};
+
+///----------------------------------------------------------------------------
+/// HereListsCase - What the editor looks up to fill its "here" lists, done
+/// for every tile in the world: the objects and characters on the tile, and
+/// each of their names.
+///----------------------------------------------------------------------------
+
+class HereListsCase : public WorldCase {
+
+    public:
+
+        HereListsCase(const std::string& inFilePath, const std::string& inWorldName) :
+                      WorldCase("GameMap here lists", inFilePath, inWorldName), result(0) {}
+
+        virtual void run() {
+
+            const std::vector<GameObject>& objects = gameMap.getGameObjects();
+            const std::vector<GameCharacter>& characters = gameMap.getGameCharacters();
+
+            for(int row = 0; row < gameMap.getHeight(); ++row) {
+                for(int col = 0; col < gameMap.getWidth(); ++col) {
+
+                    const std::vector<size_t>& objectsHere = gameMap.getObjectIndicesAtRowCol(row, col);
+                    const std::vector<size_t>& charactersHere = gameMap.getCharacterIndicesAtRowCol(row, col);
+
+                    for(size_t i = 0; i < objectsHere.size(); ++i) {
+                        result += objects[objectsHere[i]].getName().length();
+                    }
+
+                    for(size_t i = 0; i < charactersHere.size(); ++i) {
+                        result += characters[charactersHere[i]].getName().length();
+                    }
+                }
+            }
+
+        }
+
+    private:
+
+        // Kept so the calls cannot be optimized away.
+        size_t result;
+
+};
+
+///----------------------------------------------------------------------------
+/// EntityIDsCase - What the editor does to find an entity when it is added,
+/// replaced or deleted, done for every object and character: look it up by
+/// its ID, and find the first free ID.
+///----------------------------------------------------------------------------
+
+class EntityIDsCase : public WorldCase {
+
+    public:
+
+        EntityIDsCase(const std::string& inFilePath, const std::string& inWorldName) :
+                      WorldCase("GameMap entity ID lookups", inFilePath, inWorldName), result(0) {}
+
+        virtual void run() {
+
+            const std::vector<GameObject>& objects = gameMap.getGameObjects();
+            const std::vector<GameCharacter>& characters = gameMap.getGameCharacters();
+
+            for(size_t i = 0; i < objects.size(); ++i) {
+                result += gameMap.objectIndexFromID(objects[i].getID());
+                result += gameMap.getFirstUnusedObjectID();
+            }
+
+            for(size_t i = 0; i < characters.size(); ++i) {
+                result += gameMap.characterIndexFromID(characters[i].getID());
+                result += gameMap.getFirstUnusedCharacterID();
+            }
+
+        }
+
+    private:
+
+        // Kept so the calls cannot be optimized away.
+        size_t result;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReferencesCase - What the editor asks before deleting an object or a
+/// character, done for every one of them: which objects are used with the
+/// object, which the character holds, and which are keys to each door.
+///----------------------------------------------------------------------------
+
+class ReferencesCase : public WorldCase {
+
+    public:
+
+        ReferencesCase(const std::string& inFilePath, const std::string& inWorldName) :
+                       WorldCase("GameMap reference lookups", inFilePath, inWorldName), result(0) {}
+
+        virtual void run() {
+
+            const std::vector<GameObject>& objects = gameMap.getGameObjects();
+            const std::vector<GameCharacter>& characters = gameMap.getGameCharacters();
+
+            for(size_t i = 0; i < objects.size(); ++i) {
+                result += gameMap.getReliantObjectsFromID(objects[i].getID()).size();
+                result += gameMap.getDoorKeysAtRowCol(objects[i].getY(), objects[i].getX()).size();
+            }
+
+            for(size_t i = 0; i < characters.size(); ++i) {
+                result += gameMap.getCharacterInventory(characters[i].getID()).size();
+            }
+
+        }
+
+    private:
+
+        // Kept so the calls cannot be optimized away.
+        size_t result;
+
+};
+
+///----------------------------------------------------------------------------
+/// ConnectionsCase - What a full redraw of the map asks about connections:
+/// whether each tile is connected to a switch that is on, and where each
+/// tile's jump goes.
+///----------------------------------------------------------------------------
+
+class ConnectionsCase : public WorldCase {
+
+    public:
+
+        ConnectionsCase(const std::string& inFilePath, const std::string& inWorldName) :
+                        WorldCase("GameMap connection lookups", inFilePath, inWorldName), result(0) {}
+
+        virtual void run() {
+
+            const int numRows = gameMap.getHeight();
+            const int numCols = gameMap.getWidth();
+
+            for(int row = 0; row < numRows; ++row) {
+                for(int col = 0; col < numCols; ++col) {
+                    result += gameMap.isConnectedToOnSwitch(row, col) ? 1 : 0;
+                    result += gameMap.findJumpPoint(row, col) ? 1 : 0;
+                }
+            }
+
+        }
+
+    private:
+
+        // Kept so the calls cannot be optimized away.
+        size_t result;
+
+};
+
+//=============================================================================
+// Frost Cases
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// DescriptionsCase - A case that works on every tile description in a
+/// world, which are the longest strings the editor reads and writes.
+///----------------------------------------------------------------------------
+
+class DescriptionsCase : public WorldCase {
+
+    public:
+
+        DescriptionsCase(const std::string& inName, const std::string& inFilePath, const std::string& inWorldName) :
+                         WorldCase(inName, inFilePath, inWorldName) {}
+
+        virtual void setUp() {
+
+            WorldCase::setUp();
+
+            descriptions.clear();
+            encoded.clear();
+
+            const std::vector<GameTile>& tiles = gameMap.getTiles();
+
+            for(size_t i = 0; i < tiles.size(); ++i) {
+                if(!tiles[i].getDescription().empty()) {
+                    descriptions.push_back(tiles[i].getDescription());
+                    Frost::writeVBString(encoded, tiles[i].getDescription());
+                }
+            }
+
+            // The map is not needed anymore.
+            gameMap = GameMap();
+
+        }
+
+    protected:
+
+        std::vector<std::string>    descriptions;
+        std::string                 encoded;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReadVBStringCase - Frost::readVBString, reading every description.
+///----------------------------------------------------------------------------
+
+class ReadVBStringCase : public DescriptionsCase {
+
+    public:
+
+        ReadVBStringCase(const std::string& inFilePath, const std::string& inWorldName) :
+                         DescriptionsCase("Frost::readVBString", inFilePath, inWorldName) {}
+
+        virtual void setUp() {
+            DescriptionsCase::setUp();
+            stream.str(encoded);
+        }
+
+        virtual void run() {
+
+            stream.clear();
+            stream.seekg(0);
+
+            for(size_t i = 0; i < descriptions.size(); ++i) {
+                Frost::readVBString(stream);
+            }
+
+        }
+
+        virtual uint64_t getBytesPerOp() const { return encoded.size(); }
+
+    private:
+
+        std::istringstream stream;
+
+};
+
+///----------------------------------------------------------------------------
+/// WriteVBStringStreamCase - Frost::writeVBString to a stream, writing every
+/// description.
+///----------------------------------------------------------------------------
+
+class WriteVBStringStreamCase : public DescriptionsCase {
+
+    public:
+
+        WriteVBStringStreamCase(const std::string& inFilePath, const std::string& inWorldName) :
+                                DescriptionsCase("Frost::writeVBString(ostream)", inFilePath, inWorldName) {}
+
+        virtual void run() {
+
+            stream.str(std::string());
+
+            for(size_t i = 0; i < descriptions.size(); ++i) {
+                Frost::writeVBString(stream, descriptions[i]);
+            }
+
+        }
+
+    private:
+
+        std::ostringstream stream;
+
+};
+
+///----------------------------------------------------------------------------
+/// WriteVBStringBufferCase - Frost::writeVBString to a string, writing every
+/// description.
+///----------------------------------------------------------------------------
+
+class WriteVBStringBufferCase : public DescriptionsCase {
+
+    public:
+
+        WriteVBStringBufferCase(const std::string& inFilePath, const std::string& inWorldName) :
+                                DescriptionsCase("Frost::writeVBString(string)", inFilePath, inWorldName) {}
+
+        virtual void run() {
+
+            buffer.clear();
+
+            for(size_t i = 0; i < descriptions.size(); ++i) {
+                Frost::writeVBString(buffer, descriptions[i]);
+            }
+
+        }
+
+    private:
+
+        std::string buffer;
+
+};
+
+///----------------------------------------------------------------------------
+/// SplitCase - Frost::split, splitting every description into words.
+///----------------------------------------------------------------------------
+
+class SplitCase : public DescriptionsCase {
+
+    public:
+
+        SplitCase(const std::string& inFilePath, const std::string& inWorldName) :
+                  DescriptionsCase("Frost::split", inFilePath, inWorldName), numTokens(0) {}
+
+        virtual void run() {
+            for(size_t i = 0; i < descriptions.size(); ++i) {
+                numTokens += Frost::split(descriptions[i], ' ').size();
+            }
+        }
+
+    private:
+
+        size_t numTokens;
+
+};
+
+///----------------------------------------------------------------------------
+/// WorldTextCase - A case that works on the raw text of a world's SG0 file.
+///----------------------------------------------------------------------------
+
+class WorldTextCase : public BenchCase {
+
+    public:
+
+        WorldTextCase(const std::string& inName, const std::string& inFilePath, const std::string& inWorldName) :
+                      BenchCase(inName, inWorldName),
+                      fullPath(inFilePath + inWorldName + "." + AdventureGamerConstants::FileNameExtension) {}
+
+        virtual void setUp() {
+
+            MappedFile mapFile;
+
+            if(!mapFile.open(fullPath)) {
+                throw std::runtime_error("Could not open " + fullPath + " for reading.");
+            }
+
+            text.assign(mapFile.getData(), mapFile.getSize());
+
+        }
+
+        virtual uint64_t getBytesPerOp() const { return text.size(); }
+
+    protected:
+
+        std::string     fullPath;
+        std::string     text;
+
+};
+
+///----------------------------------------------------------------------------
+/// GetlineCase - Frost::getLineWindows through a stream, splitting the SG0
+/// file into lines the way the stream readers do.
+///----------------------------------------------------------------------------
+
+class GetlineCase : public WorldTextCase {
+
+    public:
+
+        GetlineCase(const std::string& inFilePath, const std::string& inWorldName) :
+                    WorldTextCase("Frost::getLineWindows", inFilePath, inWorldName), numLines(0) {}
+
+        virtual void setUp() {
+            WorldTextCase::setUp();
+            stream.str(text);
+        }
+
+        virtual void run() {
+
+            stream.clear();
+            stream.seekg(0);
+
+            while(stream.peek() != EOF) {
+                Frost::getLineWindows(stream, line);
+                numLines++;
+            }
+
+        }
+
+    private:
+
+        std::istringstream  stream;
+        std::string         line;
+        size_t              numLines;
+
+};
+
+///----------------------------------------------------------------------------
+/// LineScannerCase - A case that runs one implementation of the line scanner
+/// over the SG0 file, putting the one that was in use back afterwards.
+///----------------------------------------------------------------------------
+
+class LineScannerCase : public WorldTextCase {
+
+    public:
+
+        LineScannerCase(const std::string& inName, const LineScanner::Implementation& inImplementation,
+                        const std::string& inFilePath, const std::string& inWorldName) :
+                        WorldTextCase(inName + "(" + LineScanner::getImplementationName(inImplementation) + ")",
+                                      inFilePath, inWorldName),
+                        implementation(inImplementation), previousImplementation(LineScanner::Scalar),
+                        numFound(0) {}
+
+        virtual void setUp() {
+
+            WorldTextCase::setUp();
+
+            previousImplementation = LineScanner::getImplementation();
+
+            if(!LineScanner::setImplementation(implementation)) {
+                throw std::runtime_error("This CPU does not support that implementation.");
+            }
+
+        }
+
+        virtual void tearDown() {
+            LineScanner::setImplementation(previousImplementation);
+        }
+
+    protected:
+
+        LineScanner::Implementation implementation;
+        LineScanner::Implementation previousImplementation;
+        size_t                      numFound;
+
+};
+
+///----------------------------------------------------------------------------
+/// FindNewLineCase - LineScanner::findNewLine, splitting the SG0 file into
+/// lines the way WorldFileReader does.
+///----------------------------------------------------------------------------
+
+class FindNewLineCase : public LineScannerCase {
+
+    public:
+
+        FindNewLineCase(const LineScanner::Implementation& inImplementation, const std::string& inFilePath,
+                        const std::string& inWorldName) :
+                        LineScannerCase("LineScanner::findNewLine", inImplementation, inFilePath, inWorldName) {}
+
+        virtual void run() {
+
+            const char* current = text.data();
+            const char* end = current + text.size();
+
+            while(current != end) {
+
+                const char* newLine = LineScanner::findNewLine(current, static_cast<size_t>(end - current));
+
+                if(newLine == NULL) {
+                    break;
+                }
+
+                current = newLine + 1;
+                numFound++;
+            }
+
+        }
+
+};
+
+///----------------------------------------------------------------------------
+/// FindVBTerminatorCase - LineScanner::findVBTerminator, finding the end of
+/// every quoted line in the SG0 file.
+///----------------------------------------------------------------------------
+
+class FindVBTerminatorCase : public LineScannerCase {
+
+    public:
+
+        FindVBTerminatorCase(const LineScanner::Implementation& inImplementation, const std::string& inFilePath,
+                             const std::string& inWorldName) :
+                             LineScannerCase("LineScanner::findVBTerminator", inImplementation, inFilePath,
+                                             inWorldName) {}
+
+        virtual void run() {
+
+            const char* current = text.data();
+            const char* end = current + text.size();
+
+            while(current != end) {
+
+                const char* terminator = LineScanner::findVBTerminator(current, static_cast<size_t>(end - current));
+
+                if(terminator == NULL) {
+                    break;
+                }
+
+                current = terminator + 3;
+                numFound++;
+            }
+
+        }
+
+};
+
+///----------------------------------------------------------------------------
+/// DialogueCase - A case that works on one long string that is mostly quoted
+/// dialogue, the worst case for escaping and unescaping.
+///----------------------------------------------------------------------------
+
+class DialogueCase : public BenchCase {
+
+    public:
+
+        DialogueCase(const std::string& inName, const std::string& inSizeName, const int& inLength) :
+                     BenchCase(inName, inSizeName), length(inLength) {}
+
+        virtual void setUp() {
+
+            const char* lines[] = { "\"Halt!\" cried the guard. ", "\"Who goes there?\" ",
+                                    "\"A friend,\" you answer.\r\n", "\"Then pass.\" " };
+
+            text.clear();
+
+            for(int i = 0; static_cast<int>(text.size()) < length; ++i) {
+                text += lines[i % 4];
+            }
+
+            text.resize(length);
+
+            encoded.clear();
+            Frost::writeVBString(encoded, text);
+
+        }
+
+        virtual uint64_t getBytesPerOp() const { return encoded.size(); }
+
+    protected:
+
+        int                 length;
+        std::string         text;
+        std::string         encoded;
+
+};
+
+///----------------------------------------------------------------------------
+/// ReadDialogueCase - Frost::readVBString on a string of dialogue.
+///----------------------------------------------------------------------------
+
+class ReadDialogueCase : public DialogueCase {
+
+    public:
+
+        ReadDialogueCase(const std::string& inSizeName, const int& inLength) :
+                         DialogueCase("Frost::readVBString(dialogue)", inSizeName, inLength) {}
+
+        virtual void setUp() {
+            DialogueCase::setUp();
+            stream.str(encoded);
+        }
+
+        virtual void run() {
+            stream.clear();
+            stream.seekg(0);
+            Frost::readVBString(stream);
+        }
+
+    private:
+
+        std::istringstream stream;
+
+};
+
+///----------------------------------------------------------------------------
+/// WriteDialogueCase - Frost::writeVBString to a stream, on a string of
+/// dialogue.
+///----------------------------------------------------------------------------
+
+class WriteDialogueCase : public DialogueCase {
+
+    public:
+
+        WriteDialogueCase(const std::string& inSizeName, const int& inLength) :
+                          DialogueCase("Frost::writeVBString(dialogue)", inSizeName, inLength) {}
+
+        virtual void run() {
+            stream.seekp(0);
+            Frost::writeVBString(stream, text);
+        }
+
+    private:
+
+        std::ostringstream stream;
+
+};
+
+//=============================================================================
+// JSON and Language Cases
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// JsonParseCase - json::jobject::parse on a language file with the number of
+/// keys given. Some of the values have escaped quotes in them, like the real
+/// language files do.
+///----------------------------------------------------------------------------
+
+class JsonParseCase : public BenchCase {
+
+    public:
+
+        JsonParseCase(const std::string& inSizeName, const int& inNumKeys) :
+                      BenchCase("json::jobject::parse", inSizeName), numKeys(inNumKeys) {}
+
+        virtual void setUp() {
+
+            document = "{";
+
+            for(int i = 0; i < numKeys; ++i) {
+
+                if(i) {
+                    document += ",";
+                }
+
+                document += "\"BenchKey" + std::to_string(i) + "\":\"Value for key " + std::to_string(i);
+                document += (i % 8 == 0) ? " with \\\"quotes\\\" in it\"" : " of the language file\"";
+
+            }
+
+            document += "}";
+
+        }
+
+        virtual void run() {
+            json::jobject::parse(document.c_str());
+        }
+
+    private:
+
+        int             numKeys;
+        std::string     document;
+
+};
+
+///----------------------------------------------------------------------------
+/// LanguageGetCase - LanguageMapper::get with the built in language, looking
+/// up a mix of keys the editor uses and one that does not exist.
+///----------------------------------------------------------------------------
+
+class LanguageGetCase : public BenchCase {
+
+    public:
+
+        LanguageGetCase() : BenchCase("LanguageMapper::get", BenchSuiteConstants::NoSize) {}
+
+        virtual void setUp() {
+
+            if(!LanguageMapper::getInstance().tryLoadDefaultLanguage()) {
+                throw std::runtime_error("Could not load the default language.");
+            }
+
+            const char* lookupKeys[] = {
+                "FileMenu", "SaveMenuItem", "TileDescriptionMenuItem", "ObjectsGroup", "CharactersHereGroup",
+                "EditObjectTitle", "OnObjectSightLabel", "IsInvisibleLabel", "SightInfraredOption",
+                "CharOnFightLabel", "ResizeSmallerWarningText", "ErrMustBeDarkOrGateText", "OKButton",
+                "VAL_OutOfRangeText", "ProgramName", "NotARealKey"
+            };
+
+            keys.assign(lookupKeys, lookupKeys + sizeof(lookupKeys) / sizeof(lookupKeys[0]));
+
+        }
+
+        virtual void run() {
+
+            const LanguageMapper& mapper = LanguageMapper::getInstance();
+
+            for(size_t i = 0; i < keys.size(); ++i) {
+                mapper.get(keys[i]);
+            }
+
+        }
+
+    private:
+
+        std::vector<std::string> keys;
+
+};
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// addWorldCases - Add the GameMap cases for a world.
+/// @param path the world is in, ending with a path separator
+/// @param name of the world without an extension, which is also used as the
+/// size in the results.
+///----------------------------------------------------------------------------
+
+void BenchCases::addWorldCases(BenchSuite& suite, const std::string& filePath, const std::string& worldName) {
+    suite.addCase(new ReadMapCase(filePath, worldName));
+    suite.addCase(new ReadMapCase(filePath, worldName, 1));
+    suite.addCase(new ReadMapLazyCase(filePath, worldName));
+    suite.addCase(new ScanMapCase(filePath, worldName));
+    suite.addCase(new WriteMapCase(filePath, worldName));
+    suite.addCase(new ReadMapMemoryCase(filePath, worldName));
+    suite.addCase(new WriteMapMemoryCase(filePath, worldName));
+    suite.addCase(new ResizeMapCase(filePath, worldName));
+    suite.addCase(new ValidateTilesCase(filePath, worldName));
+    suite.addCase(new HereListsCase(filePath, worldName));
+    suite.addCase(new EntityIDsCase(filePath, worldName));
+    suite.addCase(new ConnectionsCase(filePath, worldName));
+    suite.addCase(new ReferencesCase(filePath, worldName));
+}
+
+///----------------------------------------------------------------------------
+/// addFrostCases - Add the string reading and writing cases, using the
+/// descriptions of a world, and the line scanning cases on its SG0 file for
+/// each scanner implementation this CPU supports.
+/// @param path the world is in, ending with a path separator
+/// @param name of the world without an extension
+///----------------------------------------------------------------------------
+
+void BenchCases::addFrostCases(BenchSuite& suite, const std::string& filePath, const std::string& worldName) {
+    suite.addCase(new ReadVBStringCase(filePath, worldName));
+    suite.addCase(new WriteVBStringStreamCase(filePath, worldName));
+    suite.addCase(new WriteVBStringBufferCase(filePath, worldName));
+    suite.addCase(new SplitCase(filePath, worldName));
+    suite.addCase(new GetlineCase(filePath, worldName));
+
+    const LineScanner::Implementation implementations[] = { LineScanner::Scalar, LineScanner::SSE2,
+                                                            LineScanner::AVX2 };
+
+    for(int i = 0; i < 3; ++i) {
+        if(LineScanner::isSupported(implementations[i])) {
+            suite.addCase(new FindNewLineCase(implementations[i], filePath, worldName));
+            suite.addCase(new FindVBTerminatorCase(implementations[i], filePath, worldName));
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// addDialogueCases - Add the string escaping and unescaping throughput
+/// cases, on strings of 1 KB to 8 KB.
+///----------------------------------------------------------------------------
+
+void BenchCases::addDialogueCases(BenchSuite& suite) {
+
+    const char* sizeNames[] = { "1KB", "4KB", "8KB" };
+    const int lengths[] = { 1024, 4096, 8192 };
+
+    for(int i = 0; i < 3; ++i) {
+        suite.addCase(new ReadDialogueCase(sizeNames[i], lengths[i]));
+        suite.addCase(new WriteDialogueCase(sizeNames[i], lengths[i]));
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// addJsonCases - Add the JSON parsing case.
+/// @param size to report the case as
+/// @param number of keys the document should have
+///----------------------------------------------------------------------------
+
+void BenchCases::addJsonCases(BenchSuite& suite, const std::string& sizeName, const int& numKeys) {
+    suite.addCase(new JsonParseCase(sizeName, numKeys));
+}
+
+///----------------------------------------------------------------------------
+/// addLanguageCases - Add the language lookup case. Lookups do not depend on
+/// the size of a world, so there is only one size.
+///----------------------------------------------------------------------------
+
+void BenchCases::addLanguageCases(BenchSuite& suite) {
+    suite.addCase(new LanguageGetCase());
+}
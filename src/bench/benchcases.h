@@ -0,0 +1,23 @@
+#ifndef __BENCHCASES_H__
+#define __BENCHCASES_H__
+
+#include <string>
+
+class BenchSuite;
+
+///----------------------------------------------------------------------------
+/// BenchCases - The cases the bench suite runs. Each add function adds its
+/// cases to the end of the suite given.
+///----------------------------------------------------------------------------
+
+namespace BenchCases {
+
+    void addWorldCases(BenchSuite& suite, const std::string& filePath, const std::string& worldName);
+    void addFrostCases(BenchSuite& suite, const std::string& filePath, const std::string& worldName);
+    void addDialogueCases(BenchSuite& suite);
+    void addJsonCases(BenchSuite& suite, const std::string& sizeName, const int& numKeys);
+    void addLanguageCases(BenchSuite& suite);
+
+}
+
+#endif // __BENCHCASES_H__
@@ -0,0 +1,148 @@
+#include "benchsuite.h"
+#include <algorithm>
+#include <stdexcept>
+#include "alloccounter.h"
+#include "benchtimer.h"
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+BenchSuite::BenchSuite() : iterations(0), minTime(BenchSuiteConstants::DefaultMinTime) {
+}
+
+BenchSuite::~BenchSuite() {
+
+    for(size_t i = 0; i < cases.size(); ++i) {
+        delete cases[i];
+        cases[i] = NULL;
+    }
+
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// addCase - Add a case to the end of the suite. The suite deletes it when
+/// it is destroyed.
+/// @param case to add, which must have been created with new.
+///----------------------------------------------------------------------------
+
+void BenchSuite::addCase(BenchCase* benchCase) {
+    cases.push_back(benchCase);
+}
+
+///----------------------------------------------------------------------------
+/// run - Run every case whose name contains the filter, writing each result
+/// as soon as it is known. A case that throws is reported on stderr and
+/// skipped.
+/// @param file to write the results to
+/// @return true if every case ran, false if any failed.
+///----------------------------------------------------------------------------
+
+bool BenchSuite::run(FILE* outFile) {
+
+    bool allRan = true;
+
+    writeHeader(outFile);
+
+    for(size_t i = 0; i < cases.size(); ++i) {
+
+        BenchCase& benchCase = *cases[i];
+
+        if(!filter.empty() && benchCase.getName().find(filter) == std::string::npos) {
+            continue;
+        }
+
+        try {
+            writeResult(outFile, runCase(benchCase));
+            fflush(outFile);
+        }
+        catch(const std::exception& e) {
+            fprintf(stderr, "%s (%s): %s\n", benchCase.getName().c_str(), benchCase.getSize().c_str(), e.what());
+            allRan = false;
+        }
+
+    }
+
+    return allRan;
+
+}
+
+///----------------------------------------------------------------------------
+/// writeHeader - Write the names of the CSV columns.
+///----------------------------------------------------------------------------
+
+void BenchSuite::writeHeader(FILE* outFile) {
+    fprintf(outFile, "case,size,iterations,ns_per_op,allocs_per_op,bytes_per_op,mb_per_s\n");
+}
+
+///----------------------------------------------------------------------------
+/// writeResult - Write a result as a CSV row.
+///----------------------------------------------------------------------------
+
+void BenchSuite::writeResult(FILE* outFile, const BenchResult& result) {
+    fprintf(outFile, "%s,%s,%llu,%.1f,%.2f,%.1f,%.1f\n", result.name.c_str(), result.size.c_str(),
+            static_cast<unsigned long long>(result.iterations), result.nsPerOp, result.allocationsPerOp,
+            result.bytesPerOp, result.mbPerSecond);
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// runCase - Time a case. If the number of iterations was not set, the case
+/// is run once to see how long it takes, and then enough times to fill the
+/// minimum time.
+/// @param case to run
+/// @return the result, averaged over every iteration.
+/// @throws any exception the case throws.
+///----------------------------------------------------------------------------
+
+BenchResult BenchSuite::runCase(BenchCase& benchCase) const {
+
+    benchCase.setUp();
+
+    BenchTimer timer;
+
+    // The first run also warms up the caches, so it is never counted.
+
+    timer.start();
+    benchCase.run();
+    const uint64_t firstTime = timer.getElapsed();
+
+    uint64_t numIterations = iterations;
+
+    if(numIterations == 0) {
+        numIterations = firstTime ? minTime / firstTime : BenchSuiteConstants::MaxIterations;
+        numIterations = std::max<uint64_t>(1, std::min(numIterations, BenchSuiteConstants::MaxIterations));
+    }
+
+    const AllocCounter::Snapshot allocsBefore = AllocCounter::get();
+    timer.start();
+
+    for(uint64_t i = 0; i < numIterations; ++i) {
+        benchCase.run();
+    }
+
+    const uint64_t elapsed = timer.getElapsed();
+    const AllocCounter::Snapshot allocsAfter = AllocCounter::get();
+
+    benchCase.tearDown();
+
+    BenchResult result;
+    result.name             = benchCase.getName();
+    result.size             = benchCase.getSize();
+    result.iterations       = numIterations;
+    result.nsPerOp          = static_cast<double>(elapsed) / numIterations;
+    result.allocationsPerOp = static_cast<double>(allocsAfter.numAllocations - allocsBefore.numAllocations) /
+                              numIterations;
+    result.bytesPerOp       = static_cast<double>(allocsAfter.numBytes - allocsBefore.numBytes) / numIterations;
+    result.mbPerSecond      = result.nsPerOp > 0 ? (benchCase.getBytesPerOp() * 1000.0) / result.nsPerOp : 0;
+
+    return result;
+
+}
@@ -0,0 +1,102 @@
+#ifndef __BENCHSUITE_H__
+#define __BENCHSUITE_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../compat/stdint_compat.h"
+
+namespace BenchSuiteConstants {
+
+    // How long each case runs for when the number of iterations is not
+    // given, in nanoseconds.
+    const uint64_t DefaultMinTime   = 250000000;
+    const uint64_t MaxIterations    = 10000000;
+
+    // Size label for cases that do not depend on the size of a world.
+    const std::string NoSize        = "-";
+}
+
+///----------------------------------------------------------------------------
+/// BenchCase - One thing to measure. setUp and tearDown are not timed, and
+/// each call to run is one operation.
+///----------------------------------------------------------------------------
+
+class BenchCase {
+
+    public:
+
+        BenchCase(const std::string& inName, const std::string& inSize) : name(inName), size(inSize) {}
+        virtual ~BenchCase() {}
+
+        virtual void setUp() {}
+        virtual void run() = 0;
+        virtual void tearDown() {}
+
+        // Bytes of input each operation works through, or 0 if throughput
+        // does not apply to the case.
+        virtual uint64_t getBytesPerOp() const { return 0; }
+
+        const std::string& getName() const { return name; }
+        const std::string& getSize() const { return size; }
+
+    private:
+
+        std::string     name;
+        std::string     size;
+
+};
+
+///----------------------------------------------------------------------------
+/// BenchResult - How one case performed, per operation.
+///----------------------------------------------------------------------------
+
+struct BenchResult {
+    std::string     name;
+    std::string     size;
+    uint64_t        iterations;
+    double          nsPerOp;
+    double          allocationsPerOp;
+    double          bytesPerOp;
+    double          mbPerSecond;    // 0 if the case has no throughput
+};
+
+///----------------------------------------------------------------------------
+/// BenchSuite - Runs a list of cases and writes the results out as CSV, one
+/// row per case, so runs from different releases can be compared with any
+/// tool. The suite owns the cases added to it.
+///----------------------------------------------------------------------------
+
+class BenchSuite {
+
+    public:
+
+        BenchSuite();
+        ~BenchSuite();
+
+        void addCase(BenchCase* benchCase);
+
+        void setIterations(const uint64_t& inIterations) { iterations = inIterations; }
+        void setMinTime(const uint64_t& inMinTime) { minTime = inMinTime; }
+        void setFilter(const std::string& inFilter) { filter = inFilter; }
+
+        bool run(FILE* outFile);
+
+        static void writeHeader(FILE* outFile);
+        static void writeResult(FILE* outFile, const BenchResult& result);
+
+    private:
+
+        BenchSuite(const BenchSuite&) {};
+        void operator=(const BenchSuite&) {};
+
+        BenchResult runCase(BenchCase& benchCase) const;
+
+        std::vector<BenchCase*>     cases;
+        uint64_t                    iterations;     // 0 to pick automatically
+        uint64_t                    minTime;
+        std::string                 filter;
+
+};
+
+#endif // __BENCHSUITE_H__
@@ -0,0 +1,57 @@
+#ifndef __BENCHTIMER_H__
+#define __BENCHTIMER_H__
+
+#include "../compat/stdint_compat.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// BenchTimer - A monotonic, high resolution stopwatch for the benchmarks.
+///----------------------------------------------------------------------------
+
+class BenchTimer {
+
+    public:
+
+        BenchTimer() : startTime(0) {}
+
+        void start() { startTime = getNanoseconds(); }
+        uint64_t getElapsed() const { return getNanoseconds() - startTime; }
+
+        ///--------------------------------------------------------------------
+        /// getNanoseconds - Gets the current time from a clock that never goes
+        /// backwards.
+        /// @return the time in nanoseconds from an unspecified point.
+        ///--------------------------------------------------------------------
+
+        static uint64_t getNanoseconds() {
+
+#ifdef _WIN32
+            LARGE_INTEGER frequency;
+            LARGE_INTEGER counter;
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&counter);
+
+            // Split the division up so the multiply does not overflow.
+            const uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+            const uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+            return (seconds * 1000000000) + ((remainder * 1000000000) / frequency.QuadPart);
+#else
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return (static_cast<uint64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+#endif // _WIN32
+
+        }
+
+    private:
+
+        uint64_t startTime;
+
+};
+
+#endif // __BENCHTIMER_H__
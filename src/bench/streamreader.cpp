@@ -0,0 +1,561 @@
+#include "streamreader.h"
+#include <stdexcept>
+#include "../model/gameinfo.h"
+#include "../util/frost.h"
+#include "../compat/std_extras_compat.h"
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// readMap - Reads the SG0, TXX and STY files of the world given.
+/// @param a string to the path where the map file is located
+/// @param a string indicating the file's name
+/// @throws runtime_error saying which line of the file the problem is on.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readMap(const std::string& filePath, const std::string& fileName) {
+
+    std::ifstream mapFile((filePath + fileName).c_str(), std::ifstream::in | std::ios::binary);
+
+    if(!mapFile) {
+        throw std::runtime_error("Could not open " + fileName + " for reading.");
+    }
+
+    const std::string baseName = filePath + fileName.substr(0, fileName.length() - 4);
+
+    readStory(baseName + ".STY");
+
+    // Every section shares the reader, so it can count lines for the errors.
+    Frost::LineReader lineReader(mapFile);
+
+    readHeader(lineReader);
+
+    // Whatever the value read is, it is always one more than it says.
+
+    numCols = lineReader.readInteger() + 1;
+    numRows = lineReader.readInteger() + 1;
+
+    tiles.reserve((numCols * numRows));
+
+    std::vector<std::string> rowDescriptions;
+
+    for (int row = 0; row < numRows; ++row) {
+
+        const std::string rowID = AdventureGamerHeadings::Row + std::to_string(row);
+        const std::string& line = lineReader.getLineWindows();
+
+        // This is only true if they're not equal.
+        if (rowID.compare(line)) {
+            throw std::runtime_error("Row identifier not found. Expected \"" + rowID + "\", but got \"" + line +
+                                     "\"" + lineReader.positionString() + ".");
+        }
+
+        std::string rowFilePath = baseName + ".T";
+
+        if (row < 10) {
+            rowFilePath += "0";
+        }
+
+        rowFilePath += std::to_string(row);
+
+        readRowDescriptions(rowFilePath, rowDescriptions);
+
+        for (int col = 0; col < numCols; ++col) {
+            GameTile::Builder tileBuilder;
+            readTile(lineReader, rowDescriptions[col], tileBuilder);
+            tiles.push_back(tileBuilder.build());
+        }
+
+    }
+
+    readJumps(lineReader);
+    readSwitches(lineReader);
+    readPlayerAttributes(lineReader);
+    readObjects(lineReader);
+    readCharacters(lineReader);
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// readStory - Reads the STY file, if there is one. It holds the summary and
+/// then the story, each in quotes.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readStory(const std::string& storyFilePath) {
+
+    std::ifstream ifs(storyFilePath.c_str(), std::ifstream::in | std::ios::binary);
+
+    if(!ifs) {
+        summary = "";
+        story = "";
+        return;
+    }
+
+    ifs.seekg(0, std::ios::end);
+    story.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0, std::ios::beg);
+    ifs.read(&story[0], story.size());
+
+    const size_t summarySize = story.find("\"\r\n");
+
+    if(summarySize == std::string::npos) {
+        summary = Frost::rtrim(Frost::ltrim(story, "\""), "\n\r");
+        story = "";
+        return;
+    }
+
+    summary = story.substr(0, summarySize);
+    story = story.substr(summarySize + 3, std::string::npos);
+
+    story = Frost::rtrim(Frost::ltrim(story, "\""), "\"\n\r");
+    summary = Frost::rtrim(Frost::ltrim(summary, "\""), "\n\r");
+
+}
+
+///----------------------------------------------------------------------------
+/// readHeader - Reads the world's name, save name and currency.
+/// @throws std::runtime_error if the save name isn't "Master".
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readHeader(Frost::LineReader& lineReader) {
+
+    gameName = lineReader.getLineWindows();
+
+    if(lineReader.getLineWindows().compare("Master")) {
+        throw std::runtime_error("File is not an Adventure Gamer World File.");
+    }
+
+    currencyName = lineReader.getLineWindows();
+
+}
+
+///----------------------------------------------------------------------------
+/// readRowDescriptions - Reads the descriptions from the row file given, if
+/// it exists. If it does not, there are no descriptions for this row.
+/// @param a string indicating the full path to the row file.
+/// @param outDescriptions gets each column's description, empty if it has
+/// none.
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readRowDescriptions(const std::string& rowFilePath,
+                                            std::vector<std::string>& outDescriptions) {
+
+    std::string errorMsg = "Error reading row descriptions: ";
+
+    outDescriptions.clear();
+    outDescriptions.resize(numCols);
+
+    std::ifstream ifs(rowFilePath.c_str(), std::ifstream::in | std::ios::binary);
+
+    if(!ifs) {
+        if(Frost::doesFileExist(rowFilePath)) {
+            errorMsg.append("could not open " + rowFilePath + " for reading.");
+            throw std::runtime_error(errorMsg);
+        }
+        return;
+    }
+
+    Frost::LineReader lineReader(ifs);
+
+    try {
+
+        const int numDescriptions = lineReader.readInteger();
+
+        for(int i = 0; i < numDescriptions; i++) {
+
+            const std::string& line = lineReader.getLineWindows();
+
+            if(line.empty()) {
+                break; // Nothing left.
+            }
+
+            const int colID = lineReader.parseInteger(Frost::StringToken(line));
+
+            if(colID < 0 || colID >= numCols) {
+                throw std::runtime_error("The column indicated is outside the boundaries of the map" +
+                                         lineReader.positionString() + ".");
+            }
+
+            lineReader.readVBString(outDescriptions[colID]);
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(rowFilePath + ": " + e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readJumps - Read the "{jumps" section of the file.
+/// @throws runtime_error if there are any problems reading the file.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readJumps(Frost::LineReader& lineReader) {
+
+    std::string errorMsg = "Error reading Jumps: ";
+
+    try {
+
+        checkHeading(lineReader, AdventureGamerHeadings::Jumps);
+
+        const int numJumps = lineReader.readInteger();
+        jumpPoints.reserve(numJumps > 0 ? numJumps : 0);
+
+        for(int i = 0; i < numJumps; i++) {
+
+            int x = lineReader.readInteger();
+            int y = lineReader.readInteger();
+            SimplePoint jumpA(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                throw std::runtime_error("Tile index was out of bounds" + lineReader.positionString() + ".");
+            }
+
+            x = lineReader.readInteger();
+            y = lineReader.readInteger();
+            SimplePoint jumpB(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                throw std::runtime_error("Tile index was out of bounds" + lineReader.positionString() + ".");
+            }
+
+            ConnectionPoint jumpConnection(jumpA, jumpB);
+
+            if(containsConnection(jumpPoints, jumpConnection)) {
+                throw std::runtime_error("Duplicate Jump Point was read" + lineReader.positionString() + ".");
+            }
+
+            jumpPoints.push_back(jumpConnection);
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readSwitches - Read the "{swtchs" section of the file.
+/// @throws runtime_error if there are any problems reading the file
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readSwitches(Frost::LineReader& lineReader) {
+
+    std::string errorMsg = "Error reading switches: ";
+
+    try {
+
+        checkHeading(lineReader, AdventureGamerHeadings::Switches);
+
+        const int numSwitches = lineReader.readInteger();
+        switchConnections.reserve(numSwitches > 0 ? numSwitches : 0);
+
+        for(int i = 0; i < numSwitches; i++) {
+
+            // Get the tile with the switch on it
+            int x = lineReader.readInteger();
+            int y = lineReader.readInteger();
+            SimplePoint connectionA(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                throw std::runtime_error("Tile index was out of bounds" + lineReader.positionString() + ".");
+            }
+
+            if(!(tiles[y * numCols + x].hasSwitch())) {
+                throw std::runtime_error("Read switch, but no switch was found at the coordinates read" +
+                                         lineReader.positionString() + ".");
+            }
+
+            // Get the tile effected
+            x = lineReader.readInteger();
+            y = lineReader.readInteger();
+            SimplePoint connectionB(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                throw std::runtime_error("Tile index was out of bounds" + lineReader.positionString() + ".");
+            }
+
+            const GameTile& effectedTile = tiles[y * numCols + x];
+
+            if(!(effectedTile.hasGate() || effectedTile.isDark())) {
+                throw std::runtime_error("Read switch, but the tile it effects is not a gate or dark space" +
+                                         lineReader.positionString() + ".");
+            }
+
+            ConnectionPoint switchConnection(connectionA, connectionB);
+
+            if(containsConnection(switchConnections, switchConnection)) {
+                throw std::runtime_error("Duplicate Switch Connection was read" + lineReader.positionString() + ".");
+            }
+
+            switchConnections.push_back(switchConnection);
+
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readPlayerAttributes - Reads the "{attrb" section of the file.
+/// @throws std::runtime_error if any of the numbers read are invalid.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readPlayerAttributes(Frost::LineReader& lineReader) {
+
+    std::string errorMsg = "Error reading attributes: ";
+
+    try {
+
+        checkHeading(lineReader, AdventureGamerHeadings::Attributes);
+
+        for(unsigned int i = 0; i < AttributeTypes::NumTypes; i++) {
+            lineReader.getLineWindows(); // Attribute name
+            baseAttributes[i]   = lineReader.readInteger();
+            randomAttributes[i] = lineReader.readInteger();
+        }
+
+        // Sight and hearing are only used by save files.
+        lineReader.readInteger();
+        lineReader.readInteger();
+
+        playerStartX = lineReader.readInteger();
+        playerStartY = lineReader.readInteger();
+
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readObjects - Reads the "{objct" section of the file.
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readObjects(Frost::LineReader& lineReader) {
+
+    std::string errorMsg = "Error reading objects: ";
+
+    try {
+
+        checkHeading(lineReader, AdventureGamerHeadings::Objects);
+
+        const int numObjects = lineReader.readInteger();
+        gameObjects.reserve(numObjects > 0 ? numObjects : 0);
+
+        for(int i = 0; i < numObjects; i++) {
+            GameObject::Builder objectBuilder;
+            readObject(lineReader, objectBuilder);
+            gameObjects.push_back(objectBuilder.build());
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readCharacters - Reads the "{cretr" section of the file.
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readCharacters(Frost::LineReader& lineReader) {
+
+    std::string errorMsg = "Error reading characters: ";
+
+    try {
+
+        checkHeading(lineReader, AdventureGamerHeadings::Characters);
+
+        const int numChars = lineReader.readInteger();
+        gameCharacters.reserve(numChars > 0 ? numChars : 0);
+
+        for(int i = 0; i < numChars; i++) {
+            GameCharacter::Builder characterBuilder;
+            readCharacter(lineReader, characterBuilder);
+            gameCharacters.push_back(characterBuilder.build());
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readTile - Reads a single tile, and gives it the long description given.
+/// @throws runtime_error if the tile could not be read.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readTile(Frost::LineReader& lineReader, const std::string& tileDescription,
+                                 GameTile::Builder& builder) {
+
+    if(!tileDescription.empty()) {
+        builder.description(tileDescription);
+    }
+
+    const int sprite = lineReader.readInteger();
+
+    builder.sprite(sprite);
+    builder.flags(lineReader.readInteger());
+
+    if(sprite != 0) {
+        builder.name(lineReader.getLineWindows());
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readObject - Reads a single object.
+/// @throws runtime_error saying where the problem is if the location or a
+/// number could not be read.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readObject(Frost::LineReader& lineReader, GameObject::Builder& builder) {
+
+    builder.ID(lineReader.readInteger());
+
+    for(int i = 0; i < GameObjectDescriptions::NumDescriptions; ++i) {
+        builder.description(lineReader.getVBString(), i);
+    }
+
+    builder.doorColumn(lineReader.readInteger());
+    builder.doorRow(lineReader.readInteger());
+    builder.flags1(lineReader.readInteger());
+    builder.flags2(lineReader.readInteger());
+    builder.monetaryWorth(lineReader.readInteger());
+    builder.uses(lineReader.readInteger());
+
+    // Location is either "X,Y", "ID, Creature" or "Me".
+
+    Frost::StringToken tokens[2];
+    const size_t numTokens = Frost::splitTokens(Frost::StringToken(lineReader.getVBString()), ',', tokens, 2);
+
+    if(numTokens == 2) {
+        if(Frost::endsWith(tokens[1], GameObjectConstants::OnCharacterString)) {
+            builder.location(lineReader.parseInteger(tokens[0]));
+        }
+        else {
+            builder.location(lineReader.parseInteger(tokens[0]), lineReader.parseInteger(tokens[1]));
+        }
+    }
+    else if(numTokens == 1 && Frost::startsWith(tokens[0], GameObjectConstants::OnPlayerString)) {
+        builder.location();
+    }
+    else {
+        throw std::runtime_error("Tried to read invalid location type" + lineReader.positionString() + ".");
+    }
+
+    for(unsigned int i = 0; i < AttributeTypes::NumTypes; i++) {
+        builder.attributeBase(lineReader.readInteger(), i);
+        builder.attributeRandom(lineReader.readInteger(), i);
+    }
+
+    builder.makesSight(lineReader.readInteger());
+    builder.makesHearing(lineReader.readInteger());
+
+    builder.description(lineReader.getLineWindows(), GameObjectDescriptions::Icon);
+    builder.description(lineReader.getLineWindows(), GameObjectDescriptions::Sound);
+
+    builder.usedWithID(lineReader.readInteger());
+
+}
+
+///----------------------------------------------------------------------------
+/// readCharacter - Reads a single character.
+/// @throws runtime_error saying where the problem is if the location or a
+/// number could not be read.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::readCharacter(Frost::LineReader& lineReader, GameCharacter::Builder& builder) {
+
+    builder.ID(lineReader.readInteger());
+
+    for(int i = 0; i < GameCharacterDescriptions::NumDescriptions; ++i) {
+        builder.description(lineReader.getVBString(), i);
+    }
+
+    builder.flags(lineReader.readInteger());
+    builder.unused(lineReader.readInteger());
+    builder.money(lineReader.readInteger());
+
+    Frost::StringToken tokens[2];
+    const size_t numTokens = Frost::splitTokens(Frost::StringToken(lineReader.getVBString()), ',', tokens, 2);
+
+    if(numTokens != 2) {
+        throw std::runtime_error("Tried to read invalid location type" + lineReader.positionString() + ".");
+    }
+
+    builder.location(lineReader.parseInteger(tokens[0]), lineReader.parseInteger(tokens[1]));
+
+    for(unsigned int i = 0; i < AttributeTypes::NumTypesForCharacters; i++) {
+        builder.attribute(lineReader.readInteger(), i);
+    }
+
+    builder.sight(lineReader.readInteger());
+    builder.type(lineReader.readInteger());
+
+    builder.description(lineReader.getLineWindows(), GameCharacterDescriptions::Icon);
+    builder.description(lineReader.getLineWindows(), GameCharacterDescriptions::Sound);
+
+}
+
+///----------------------------------------------------------------------------
+/// checkHeading - Reads a line and makes sure it is the section heading
+/// given.
+/// @throws runtime_error if it is not.
+///----------------------------------------------------------------------------
+
+void StreamWorldReader::checkHeading(Frost::LineReader& lineReader, const std::string& heading) const {
+
+    const std::string& line = lineReader.getLineWindows();
+
+    if(heading.compare(line)) {
+        throw std::runtime_error("Expected \"" + heading + "\", but got \"" + line + "\"" +
+                                 lineReader.positionString() + ".");
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// isRowColInMapBounds - Check if the row and column are on the map.
+///----------------------------------------------------------------------------
+
+bool StreamWorldReader::isRowColInMapBounds(const int& row, const int& col) const {
+    return row >= 0 && row < numRows && col >= 0 && col < numCols;
+}
+
+///----------------------------------------------------------------------------
+/// containsConnection - Check, one by one, if the connection given has
+/// already been read.
+///----------------------------------------------------------------------------
+
+bool StreamWorldReader::containsConnection(const std::vector<ConnectionPoint>& connections,
+                                           const ConnectionPoint& connection) {
+
+    for(std::vector<ConnectionPoint>::const_iterator it = connections.begin(); it != connections.end(); ++it) {
+        if(*it == connection) {
+            return true;
+        }
+    }
+
+    return false;
+}
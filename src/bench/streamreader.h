@@ -0,0 +1,79 @@
+#ifndef __STREAMREADER_H__
+#define __STREAMREADER_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../model/connection_point.h"
+#include "../model/gamecharacter.h"
+#include "../model/gameobject.h"
+#include "../model/gametile.h"
+
+namespace Frost {
+    class LineReader;
+}
+
+///----------------------------------------------------------------------------
+/// StreamWorldReader - A frozen copy of the editor's original world reader,
+/// which read the files a line at a time through an ifstream. GameMap no
+/// longer has it; it is only kept so the bench can compare the mapped reader
+/// against it. It reads into its own vectors instead of a GameMap, and so
+/// does not build the map's indices, but otherwise parses and checks the
+/// files as the original did. Do not change it to match the editor.
+///----------------------------------------------------------------------------
+
+class StreamWorldReader {
+
+    public:
+
+        StreamWorldReader() : numRows(0), numCols(0), playerStartX(0), playerStartY(0) {}
+
+        void readMap(const std::string& filePath, const std::string& fileName);
+
+        const std::vector<GameTile>& getTiles() const { return tiles; }
+        const std::vector<GameObject>& getObjects() const { return gameObjects; }
+        const std::vector<GameCharacter>& getCharacters() const { return gameCharacters; }
+
+    private:
+
+        StreamWorldReader(const StreamWorldReader&);
+        StreamWorldReader& operator=(const StreamWorldReader&);
+
+        void readStory(const std::string& storyFilePath);
+        void readHeader(Frost::LineReader& lineReader);
+        void readRowDescriptions(const std::string& rowFilePath, std::vector<std::string>& outDescriptions);
+        void readJumps(Frost::LineReader& lineReader);
+        void readSwitches(Frost::LineReader& lineReader);
+        void readPlayerAttributes(Frost::LineReader& lineReader);
+        void readObjects(Frost::LineReader& lineReader);
+        void readCharacters(Frost::LineReader& lineReader);
+
+        static void readTile(Frost::LineReader& lineReader, const std::string& tileDescription,
+                             GameTile::Builder& builder);
+        static void readObject(Frost::LineReader& lineReader, GameObject::Builder& builder);
+        static void readCharacter(Frost::LineReader& lineReader, GameCharacter::Builder& builder);
+
+        void checkHeading(Frost::LineReader& lineReader, const std::string& heading) const;
+        bool isRowColInMapBounds(const int& row, const int& col) const;
+        static bool containsConnection(const std::vector<ConnectionPoint>& connections,
+                                       const ConnectionPoint& connection);
+
+        std::string                 gameName;
+        std::string                 currencyName;
+        std::string                 summary;
+        std::string                 story;
+        int                         numRows;
+        int                         numCols;
+        int                         baseAttributes[AttributeTypes::NumTypes];
+        int                         randomAttributes[AttributeTypes::NumTypes];
+        int                         playerStartX;
+        int                         playerStartY;
+        std::vector<GameTile>       tiles;
+        std::vector<ConnectionPoint> jumpPoints;
+        std::vector<ConnectionPoint> switchConnections;
+        std::vector<GameObject>     gameObjects;
+        std::vector<GameCharacter>  gameCharacters;
+
+};
+
+#endif // __STREAMREADER_H__
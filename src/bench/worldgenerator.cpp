@@ -0,0 +1,829 @@
+#include "worldgenerator.h"
+#include <algorithm>
+#include "../model/gamemap.h"
+#include "../util/filetransaction.h"
+#include "../util/frost.h"
+#include "../compat/std_extras_compat.h"
+
+//-----------------------------------------------------------------------------
+// WorldGeneratorConstants
+//-----------------------------------------------------------------------------
+
+namespace WorldGeneratorConstants {
+
+    // Which way a road goes off a tile. A road's sprite index is made of
+    // these, so a dead end's index is the one direction it leads to.
+    const uint8_t ExitNorth     = 1;
+    const uint8_t ExitEast      = 2;
+    const uint8_t ExitSouth     = 4;
+    const uint8_t ExitWest      = 8;
+    const uint8_t AllExits      = 15;
+
+    const int MinNameLength     = 4;
+    const int MaxNameLength     = 32;
+    const int MinEntityText     = 16;
+
+    const char* const Words[] = {
+        "the", "old", "road", "winds", "past", "a", "ruined", "tower", "where", "lanterns",
+        "flicker", "in", "cold", "wind", "and", "gravel", "crunches", "under", "your", "boots",
+        "north", "of", "here", "lies", "forest", "dark", "river", "gate", "stands", "open",
+        "merchant", "coins", "glint", "beneath", "bridge", "silent", "hall", "echoes", "with",
+        "distant", "footsteps"
+    };
+
+    const int NumWords = sizeof(Words) / sizeof(Words[0]);
+}
+
+//=============================================================================
+// Constructors
+//=============================================================================
+
+WorldGenerator::Settings::Settings() : seed(1), numRows(20), numCols(20), roadPercent(60),
+                                       dirtRoadPercent(10), darkPercent(5), gatePercent(5),
+                                       descriptionPercent(25), descriptionLength(256),
+                                       numJumps(8), numSwitches(8), numObjects(20),
+                                       numCharacters(8), summaryLength(512), storyLength(512) {
+}
+
+WorldGenerator::WorldGenerator(const Settings& inSettings) : settings(inSettings), randomState(1),
+                                                             nextFeature(0) {
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// smallWorld - Settings for a small world, about the size most worlds
+/// people made are.
+/// @return the settings
+///----------------------------------------------------------------------------
+
+WorldGenerator::Settings WorldGenerator::smallWorld() {
+
+    Settings smallSettings;
+
+    smallSettings.numRows               = 10;
+    smallSettings.numCols               = 10;
+    smallSettings.descriptionLength     = 128;
+    smallSettings.numJumps              = 2;
+    smallSettings.numSwitches           = 2;
+    smallSettings.numObjects            = 5;
+    smallSettings.numCharacters         = 2;
+    smallSettings.summaryLength         = 128;
+    smallSettings.storyLength           = 256;
+
+    return smallSettings;
+}
+
+///----------------------------------------------------------------------------
+/// mediumWorld - Settings for a medium world.
+/// @return the settings
+///----------------------------------------------------------------------------
+
+WorldGenerator::Settings WorldGenerator::mediumWorld() {
+
+    Settings mediumSettings;
+
+    mediumSettings.numRows              = 50;
+    mediumSettings.numCols              = 50;
+    mediumSettings.descriptionLength    = 512;
+    mediumSettings.numJumps             = 20;
+    mediumSettings.numSwitches          = 20;
+    mediumSettings.numObjects           = 50;
+    mediumSettings.numCharacters        = 12;
+    mediumSettings.summaryLength        = 2048;
+    mediumSettings.storyLength          = 1024;
+
+    return mediumSettings;
+}
+
+///----------------------------------------------------------------------------
+/// maxWorld - Settings for a world at every limit the editor has. Every tile
+/// has a road, and every road has a full length description.
+/// @return the settings
+///----------------------------------------------------------------------------
+
+WorldGenerator::Settings WorldGenerator::maxWorld() {
+
+    Settings maxSettings;
+
+    maxSettings.numRows                 = AdventureGamerConstants::MaxWorldHeight;
+    maxSettings.numCols                 = AdventureGamerConstants::MaxWorldWidth;
+    maxSettings.roadPercent             = 100;
+    maxSettings.descriptionPercent      = 100;
+    maxSettings.descriptionLength       = GameMapConstants::MaxTileDescription;
+    maxSettings.numJumps                = 100;
+    maxSettings.numSwitches             = 100;
+    maxSettings.numObjects              = GameMapConstants::MaxObjects;
+    maxSettings.numCharacters           = GameMapConstants::MaxCharacters;
+    maxSettings.summaryLength           = GameMapConstants::MaxSummaryText;
+    maxSettings.storyLength             = GameMapConstants::MaxStoryText;
+
+    return maxSettings;
+}
+
+///----------------------------------------------------------------------------
+/// generate - Create the world and write its files.
+/// @param path to write the files to, ending with a path separator.
+/// @param name of the world's files, without an extension.
+/// @throws runtime_error if the files could not be written.
+///----------------------------------------------------------------------------
+
+void WorldGenerator::generate(const std::string& filePath, const std::string& worldName) {
+
+    const std::string basePath = filePath + worldName;
+
+    FileTransaction transaction;
+
+    std::string& mapFile = transaction.addFile(basePath + "." + AdventureGamerConstants::FileNameExtension);
+    std::string& storyFile = transaction.addFile(basePath + ".STY");
+
+    std::vector<std::string> rowFiles;
+    generate(mapFile, rowFiles, storyFile);
+
+    std::string rowFilePath = basePath + ".T00";
+    const size_t rowDigitPos = rowFilePath.length() - 2;
+
+    for(size_t row = 0; row < rowFiles.size(); ++row) {
+        rowFilePath[rowDigitPos] = static_cast<char>('0' + (row / 10));
+        rowFilePath[rowDigitPos + 1] = static_cast<char>('0' + (row % 10));
+        transaction.addFile(rowFilePath).swap(rowFiles[row]);
+    }
+
+    transaction.commit();
+
+}
+
+///----------------------------------------------------------------------------
+/// generate - Create the world in memory.
+/// @param (out) contents of the SG0 file
+/// @param (out) contents of each row's TXX file
+/// @param (out) contents of the STY file
+///----------------------------------------------------------------------------
+
+void WorldGenerator::generate(std::string& outMapFile, std::vector<std::string>& outRowFiles,
+                              std::string& outStoryFile) {
+
+    // Keep the world within what the game and the file format allow.
+
+    settings.numRows = std::max(AdventureGamerConstants::MinWorldHeight,
+                                std::min(settings.numRows, AdventureGamerConstants::MaxWorldHeight));
+    settings.numCols = std::max(AdventureGamerConstants::MinWorldWidth,
+                                std::min(settings.numCols, AdventureGamerConstants::MaxWorldWidth));
+    settings.numObjects = std::max(0, std::min(settings.numObjects, static_cast<int>(GameMapConstants::MaxObjects)));
+    settings.numCharacters = std::max(0, std::min(settings.numCharacters,
+                                                  static_cast<int>(GameMapConstants::MaxCharacters)));
+    settings.descriptionLength = std::max(1, std::min(settings.descriptionLength,
+                                                      static_cast<int>(GameMapConstants::MaxTileDescription)));
+    settings.summaryLength = std::max(0, std::min(settings.summaryLength,
+                                                  static_cast<int>(GameMapConstants::MaxSummaryText)));
+    settings.storyLength = std::max(0, std::min(settings.storyLength, static_cast<int>(GameMapConstants::MaxStoryText)));
+
+    // xorshift cannot start at 0.
+    randomState = settings.seed ? settings.seed : 0x9E3779B9;
+
+    const int numTiles = settings.numRows * settings.numCols;
+
+    Tile emptyTile;
+    emptyTile.sprite = RoadTypes::Empty;
+    emptyTile.flags = TileFlags::None;
+
+    tiles.assign(numTiles, emptyTile);
+    jumps.clear();
+    switches.clear();
+    roadTiles.clear();
+
+    // Jump pads and switches are put on tiles in a random order, so they
+    // never land on the same tile twice.
+
+    featureOrder.resize(numTiles);
+
+    for(int i = 0; i < numTiles; ++i) {
+        featureOrder[i] = i;
+    }
+
+    for(int i = numTiles - 1; i > 0; --i) {
+        std::swap(featureOrder[i], featureOrder[randomInt(i + 1)]);
+    }
+
+    nextFeature = 0;
+
+    placeTiles();
+    placeJumps();
+    placeSwitches();
+    decorateTiles();
+
+    for(int i = 0; i < numTiles; ++i) {
+        if(tiles[i].sprite != RoadTypes::Empty) {
+            roadTiles.push_back(i);
+        }
+    }
+
+    outMapFile.clear();
+    outStoryFile.clear();
+
+    writeMapFile(outMapFile);
+    writeRowFiles(outRowFiles);
+    writeStoryFile(outStoryFile);
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// nextRandom - xorshift32. It is used instead of rand() so the same seed
+/// gives the same world with every compiler.
+/// @return the next random number
+///----------------------------------------------------------------------------
+
+uint32_t WorldGenerator::nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+///----------------------------------------------------------------------------
+/// randomInt - Get a random number from 0 up to, but not including limit.
+/// @param how many numbers to choose from
+/// @return the random number, or 0 if the limit is not positive.
+///----------------------------------------------------------------------------
+
+int WorldGenerator::randomInt(const int& limit) {
+    return limit > 0 ? static_cast<int>(nextRandom() % static_cast<uint32_t>(limit)) : 0;
+}
+
+///----------------------------------------------------------------------------
+/// randomPercent - Roll for something that happens some of the time.
+/// @param chance of it happening, from 0 to 100
+/// @return true if it happens
+///----------------------------------------------------------------------------
+
+bool WorldGenerator::randomPercent(const int& percent) {
+    return randomInt(100) < percent;
+}
+
+///----------------------------------------------------------------------------
+/// allowedExits - Get which directions a road can go from a tile without
+/// leading off the edge of the map.
+/// @param index of the tile
+/// @return the exits allowed
+///----------------------------------------------------------------------------
+
+uint8_t WorldGenerator::allowedExits(const int& index) const {
+
+    const int row = index / settings.numCols;
+    const int col = index % settings.numCols;
+
+    uint8_t allowed = WorldGeneratorConstants::AllExits;
+
+    if(row == 0) {
+        allowed &= ~WorldGeneratorConstants::ExitNorth;
+    }
+
+    if(row == settings.numRows - 1) {
+        allowed &= ~WorldGeneratorConstants::ExitSouth;
+    }
+
+    if(col == 0) {
+        allowed &= ~WorldGeneratorConstants::ExitWest;
+    }
+
+    if(col == settings.numCols - 1) {
+        allowed &= ~WorldGeneratorConstants::ExitEast;
+    }
+
+    return allowed;
+}
+
+///----------------------------------------------------------------------------
+/// randomExits - Pick a random road shape out of the exits allowed.
+/// @param exits the road may use
+/// @return the exits of the road, which is never 0.
+///----------------------------------------------------------------------------
+
+uint8_t WorldGenerator::randomExits(const uint8_t& allowed) {
+
+    uint8_t exits = static_cast<uint8_t>(randomInt(16)) & allowed;
+
+    // Fall back to a dead end towards any allowed direction.
+
+    while(exits == 0) {
+        exits = static_cast<uint8_t>(1 << randomInt(4)) & allowed;
+    }
+
+    return exits;
+}
+
+///----------------------------------------------------------------------------
+/// takeFeatureTile - Get a tile that does not have a jump pad or switch yet.
+/// @return index of the tile, or -1 if every tile has been used.
+///----------------------------------------------------------------------------
+
+int WorldGenerator::takeFeatureTile() {
+
+    if(nextFeature >= featureOrder.size()) {
+        return -1;
+    }
+
+    return featureOrder[nextFeature++];
+}
+
+///----------------------------------------------------------------------------
+/// makeText - Make some text out of random words.
+/// @param (out) string to store the text in
+/// @param length of the text, in bytes
+/// @param true if some words may be in double quotes
+/// @param true if the text may have line breaks (CR LF)
+///----------------------------------------------------------------------------
+
+void WorldGenerator::makeText(std::string& outText, const int& length, const bool& allowQuotes,
+                              const bool& allowLineBreaks) {
+
+    outText.clear();
+    outText.reserve(length + WorldGeneratorConstants::MaxNameLength);
+
+    while(static_cast<int>(outText.size()) < length) {
+
+        const char* word = WorldGeneratorConstants::Words[randomInt(WorldGeneratorConstants::NumWords)];
+
+        if(allowQuotes && randomInt(16) == 0) {
+            outText.push_back('\"');
+            outText.append(word);
+            outText.push_back('\"');
+        }
+        else {
+            outText.append(word);
+        }
+
+        if(allowLineBreaks && randomInt(12) == 0) {
+            outText.append("\r\n");
+        }
+        else {
+            outText.push_back(' ');
+        }
+
+    }
+
+    outText.resize(length);
+
+    // Line breaks and spaces at the end are trimmed by some readers, which
+    // would make resaving the world change it.
+
+    if(!outText.empty()) {
+        const char lastChar = outText[outText.size() - 1];
+        if(lastChar == '\r' || lastChar == '\n' || lastChar == ' ') {
+            outText[outText.size() - 1] = '.';
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// placeTiles - Lay down random roads, none of which lead off the map.
+///----------------------------------------------------------------------------
+
+void WorldGenerator::placeTiles() {
+
+    for(size_t i = 0; i < tiles.size(); ++i) {
+        if(randomPercent(settings.roadPercent)) {
+            tiles[i].sprite = randomExits(allowedExits(i));
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// placeJumps - Put down pairs of jump pads, and connect them.
+///----------------------------------------------------------------------------
+
+void WorldGenerator::placeJumps() {
+
+    for(int i = 0; i < settings.numJumps; ++i) {
+
+        const int fromIndex = takeFeatureTile();
+        const int toIndex = takeFeatureTile();
+
+        if(fromIndex == -1 || toIndex == -1) {
+            break;
+        }
+
+        const int pads[2] = { fromIndex, toIndex };
+
+        for(int k = 0; k < 2; ++k) {
+
+            // A jump pad is a dead end, which only has one exit.
+
+            const uint8_t allowed = allowedExits(pads[k]);
+            uint8_t exit = 0;
+
+            while(exit == 0) {
+                exit = static_cast<uint8_t>(1 << randomInt(4)) & allowed;
+            }
+
+            tiles[pads[k]].sprite = GameTile::Builder::calculateSprite(exit, TileModifiers::JumpPad);
+        }
+
+        Connection jump;
+        jump.fromIndex = fromIndex;
+        jump.toIndex = toIndex;
+        jumps.push_back(jump);
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// placeSwitches - Put down switches, each connected to a gate or to a dark
+/// tile.
+///----------------------------------------------------------------------------
+
+void WorldGenerator::placeSwitches() {
+
+    const uint8_t corners[4] = { RoadTypes::CornerNE, RoadTypes::CornerNW, RoadTypes::CornerSE, RoadTypes::CornerSW };
+
+    for(int i = 0; i < settings.numSwitches; ++i) {
+
+        const int switchIndex = takeFeatureTile();
+        const int targetIndex = takeFeatureTile();
+
+        if(switchIndex == -1 || targetIndex == -1) {
+            break;
+        }
+
+        // Every tile has at least one corner that stays on the map, as the
+        // map is at least 3 by 3.
+
+        const uint8_t allowed = allowedExits(switchIndex);
+        uint8_t corner = 0;
+
+        while(corner == 0) {
+            const uint8_t candidate = corners[randomInt(4)];
+            if((candidate & allowed) == candidate) {
+                corner = candidate;
+            }
+        }
+
+        const uint8_t switchState = randomInt(2) ? TileModifiers::SwitchOn : TileModifiers::SwitchOff;
+        tiles[switchIndex].sprite = GameTile::Builder::calculateSprite(corner, switchState);
+
+        // Gates can only go on straightaways that stay on the map, so edge
+        // tiles are made dark instead.
+
+        const uint8_t targetAllowed = allowedExits(targetIndex);
+        const bool canBeVertical = (targetAllowed & RoadTypes::StraightawayVertical) == RoadTypes::StraightawayVertical;
+        const bool canBeHorizontal = (targetAllowed & RoadTypes::StraightawayHorizontal) ==
+                                     RoadTypes::StraightawayHorizontal;
+
+        if((canBeVertical || canBeHorizontal) && randomInt(2)) {
+
+            const uint8_t straightaway = (canBeVertical && (!canBeHorizontal || randomInt(2))) ?
+                                         RoadTypes::StraightawayVertical : RoadTypes::StraightawayHorizontal;
+            const uint8_t gateState = randomInt(2) ? TileModifiers::GateOpen : TileModifiers::GateClosed;
+
+            tiles[targetIndex].sprite = GameTile::Builder::calculateSprite(straightaway, gateState);
+            tiles[targetIndex].flags = TileFlags::None;
+
+        }
+        else {
+
+            if(tiles[targetIndex].sprite == RoadTypes::Empty) {
+                tiles[targetIndex].sprite = randomExits(targetAllowed);
+            }
+
+            tiles[targetIndex].flags = TileFlags::Dark;
+
+        }
+
+        Connection connection;
+        connection.fromIndex = switchIndex;
+        connection.toIndex = targetIndex;
+        switches.push_back(connection);
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// decorateTiles - Add the features that do not connect to anything, and
+/// give each road a name and maybe a description.
+///----------------------------------------------------------------------------
+
+void WorldGenerator::decorateTiles() {
+
+    const uint8_t straightFeatures[5] = { TileModifiers::Start, TileModifiers::Finish, TileModifiers::LockedDoor,
+                                          TileModifiers::BarrierEast, TileModifiers::BarrierWest };
+
+    for(size_t i = 0; i < tiles.size(); ++i) {
+
+        Tile& tile = tiles[i];
+
+        if(tile.sprite == RoadTypes::Empty) {
+            continue;
+        }
+
+        const uint8_t spriteIndex = tile.sprite & 15;
+        const bool hasFeature = (tile.sprite >> 4) != 0;
+
+        // Tiles with jump pads, switches and gates already have a feature,
+        // and dark tiles a switch turns on are left as they are.
+
+        if(!hasFeature && !(tile.flags & TileFlags::Dark)) {
+
+            if(spriteIndex == RoadTypes::StraightawayHorizontal || spriteIndex == RoadTypes::StraightawayVertical) {
+
+                if(randomPercent(settings.gatePercent)) {
+                    tile.sprite = GameTile::Builder::calculateSprite(spriteIndex, TileModifiers::GateClosed);
+                }
+                else if(randomInt(10) == 0) {
+                    tile.sprite = GameTile::Builder::calculateSprite(spriteIndex, straightFeatures[randomInt(5)]);
+                }
+
+            }
+            else if(spriteIndex == RoadTypes::Crossroads && randomInt(10) == 0) {
+                tile.sprite = GameTile::Builder::calculateSprite(spriteIndex, randomInt(2) ? TileModifiers::Hazard :
+                                                                                              TileModifiers::SafeHaven);
+            }
+
+            if((tile.sprite >> 4) != TileModifiers::GateClosed && randomPercent(settings.darkPercent)) {
+                tile.flags |= TileFlags::Dark;
+            }
+
+        }
+
+        if(randomPercent(settings.dirtRoadPercent)) {
+            tile.sprite |= (TileModifiers::DirtRoad << 4);
+        }
+
+        makeText(tile.name, WorldGeneratorConstants::MinNameLength +
+                 randomInt(WorldGeneratorConstants::MaxNameLength - WorldGeneratorConstants::MinNameLength),
+                 false, false);
+
+        if(randomPercent(settings.descriptionPercent)) {
+            makeText(tile.description, settings.descriptionLength, true, true);
+            tile.flags |= TileFlags::MoreInfo;
+        }
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// writeMapFile - Write the SG0 file in the same layout GameMap::writeMap
+/// uses.
+/// @param (out) buffer to write the file to
+///----------------------------------------------------------------------------
+
+void WorldGenerator::writeMapFile(std::string& mapFile) {
+
+    Frost::writeVBLine(mapFile, "Generated World " + std::to_string(static_cast<unsigned long long>(settings.seed)));
+    Frost::writeVBLine(mapFile, "Master");
+    Frost::writeVBLine(mapFile, "Gold");
+    Frost::writeVBInteger(mapFile, settings.numCols - 1);
+    Frost::writeVBInteger(mapFile, settings.numRows - 1);
+
+    for(int row = 0; row < settings.numRows; ++row) {
+
+        Frost::writeVBLine(mapFile, AdventureGamerHeadings::Row + std::to_string(row));
+
+        for(int col = 0; col < settings.numCols; ++col) {
+
+            const Tile& tile = tiles[(row * settings.numCols) + col];
+
+            Frost::writeVBInteger(mapFile, tile.sprite);
+            Frost::writeVBInteger(mapFile, tile.flags);
+
+            if(tile.sprite != RoadTypes::Empty) {
+                Frost::writeVBLine(mapFile, tile.name);
+            }
+
+        }
+
+    }
+
+    const std::vector<Connection>* connectionLists[2] = { &jumps, &switches };
+    const std::string* headings[2] = { &AdventureGamerHeadings::Jumps, &AdventureGamerHeadings::Switches };
+
+    for(int list = 0; list < 2; ++list) {
+
+        const std::vector<Connection>& connections = *connectionLists[list];
+
+        Frost::writeVBLine(mapFile, *headings[list]);
+        Frost::writeVBInteger(mapFile, static_cast<int>(connections.size()));
+
+        for(size_t i = 0; i < connections.size(); ++i) {
+            Frost::writeVBInteger(mapFile, connections[i].fromIndex % settings.numCols);
+            Frost::writeVBInteger(mapFile, connections[i].fromIndex / settings.numCols);
+            Frost::writeVBInteger(mapFile, connections[i].toIndex % settings.numCols);
+            Frost::writeVBInteger(mapFile, connections[i].toIndex / settings.numCols);
+        }
+
+    }
+
+    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Attributes);
+
+    for(unsigned int i = 0; i < AttributeTypes::NumTypes; ++i) {
+        Frost::writeVBLine(mapFile, AdventureGamerSubHeadings::Attributes[i]);
+        Frost::writeVBInteger(mapFile, randomInt(AdventureGamerConstants::MaxAttributeValue + 1));
+        Frost::writeVBInteger(mapFile, randomInt(AdventureGamerConstants::MaxAttributeValue + 1));
+    }
+
+    Frost::writeVBInteger(mapFile, SightTypes::Normal().asInt());
+    Frost::writeVBInteger(mapFile, HearingTypes::Normal().asInt());
+
+    const int startIndex = roadTiles.empty() ? 0 : roadTiles[randomInt(static_cast<int>(roadTiles.size()))];
+    Frost::writeVBInteger(mapFile, startIndex % settings.numCols);
+    Frost::writeVBInteger(mapFile, startIndex / settings.numCols);
+
+    writeObjects(mapFile);
+    writeCharacters(mapFile);
+
+}
+
+///----------------------------------------------------------------------------
+/// writeObjects - Write the "{objct" section. Objects are on the ground on a
+/// road, held by a character, or held by the player.
+/// @param (out) buffer to write the section to
+///----------------------------------------------------------------------------
+
+void WorldGenerator::writeObjects(std::string& mapFile) {
+
+    // These are the combinations GameObject::Builder::flags1 keeps as is.
+
+    const uint8_t objectFlags[8] = { GameObjectFlags1::None, GameObjectFlags1::MasterKey, GameObjectFlags1::Ladder,
+                                     GameObjectFlags1::Protection, GameObjectFlags1::Torch | GameObjectFlags1::Worn,
+                                     GameObjectFlags1::FixedLocation, GameObjectFlags1::Money,
+                                     GameObjectFlags1::Money | GameObjectFlags1::Invisible };
+
+    const int textLength = std::max(WorldGeneratorConstants::MinEntityText,
+                                    std::min(settings.descriptionLength, GameObjectConstants::MaxDescriptionLength));
+
+    std::string text;
+
+    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Objects);
+    Frost::writeVBInteger(mapFile, settings.numObjects);
+
+    for(int id = 1; id <= settings.numObjects; ++id) {
+
+        Frost::writeVBInteger(mapFile, id);
+        Frost::writeVBString(mapFile, "Object " + std::to_string(id));
+
+        for(int i = 1; i < GameObjectDescriptions::NumDescriptions; ++i) {
+            makeText(text, WorldGeneratorConstants::MinEntityText + randomInt(textLength), false, false);
+            Frost::writeVBString(mapFile, text);
+        }
+
+        std::string location;
+        uint8_t flags2 = randomInt(4) ? GameObjectFlags2::None : GameObjectFlags2::EffectsTemporary;
+        const int locationType = randomInt(10);
+
+        if(locationType == 0) {
+            location = GameObjectConstants::OnPlayerString;
+            flags2 |= GameObjectFlags2::NotOnGround;
+        }
+        else if(locationType == 1 && settings.numCharacters > 0) {
+            location = std::to_string(1 + randomInt(settings.numCharacters)) + ", " +
+                       GameObjectConstants::OnCharacterString;
+            flags2 |= GameObjectFlags2::NotOnGround;
+        }
+        else {
+            const int tileIndex = roadTiles.empty() ? 0 : roadTiles[randomInt(static_cast<int>(roadTiles.size()))];
+            location = std::to_string(tileIndex % settings.numCols) + "," +
+                       std::to_string(tileIndex / settings.numCols);
+        }
+
+        Frost::writeVBInteger(mapFile, 0);  // Door column
+        Frost::writeVBInteger(mapFile, 0);  // Door row
+        Frost::writeVBInteger(mapFile, objectFlags[randomInt(8)]);
+        Frost::writeVBInteger(mapFile, flags2);
+        Frost::writeVBInteger(mapFile, randomInt(AdventureGamerConstants::MaxObjectMonetaryValue + 1));
+        Frost::writeVBInteger(mapFile, AdventureGamerConstants::MinNumUses + randomInt(100));
+        Frost::writeVBString(mapFile, location);
+
+        for(unsigned int i = 0; i < AttributeTypes::NumTypes; ++i) {
+            Frost::writeVBInteger(mapFile, randomInt(7) - 3);
+            Frost::writeVBInteger(mapFile, randomInt(4));
+        }
+
+        Frost::writeVBInteger(mapFile, randomInt(SightTypes::NumTypes));
+        Frost::writeVBInteger(mapFile, randomInt(HearingTypes::NumTypes));
+        Frost::writeVBLine(mapFile, "object" + std::to_string(id) + ".ico");
+        Frost::writeVBLine(mapFile, "object" + std::to_string(id) + ".wav");
+        Frost::writeVBInteger(mapFile, (settings.numObjects > 1 && randomInt(4) == 0) ?
+                                       1 + randomInt(settings.numObjects) : GameObjectConstants::UsedAlone);
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// writeCharacters - Write the "{cretr" section. Characters are always on a
+/// road.
+/// @param (out) buffer to write the section to
+///----------------------------------------------------------------------------
+
+void WorldGenerator::writeCharacters(std::string& mapFile) {
+
+    const int textLength = std::max(WorldGeneratorConstants::MinEntityText,
+                                    std::min(settings.descriptionLength,
+                                             static_cast<int>(GameCharacterConstants::MaxDescriptionLength)));
+
+    std::string text;
+
+    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Characters);
+    Frost::writeVBInteger(mapFile, settings.numCharacters);
+
+    for(int id = 1; id <= settings.numCharacters; ++id) {
+
+        Frost::writeVBInteger(mapFile, id);
+        Frost::writeVBString(mapFile, "Character " + std::to_string(id));
+
+        for(int i = 1; i < GameCharacterDescriptions::NumDescriptions; ++i) {
+            makeText(text, WorldGeneratorConstants::MinEntityText + randomInt(textLength), false, false);
+            Frost::writeVBString(mapFile, text);
+        }
+
+        const int tileIndex = roadTiles.empty() ? 0 : roadTiles[randomInt(static_cast<int>(roadTiles.size()))];
+
+        Frost::writeVBInteger(mapFile, randomInt(256));  // Flags
+        Frost::writeVBInteger(mapFile, 0);               // Unused
+        Frost::writeVBInteger(mapFile, randomInt(AdventureGamerConstants::MaxAmountOfMoney + 1));
+        Frost::writeVBString(mapFile, std::to_string(tileIndex % settings.numCols) + "," +
+                                      std::to_string(tileIndex / settings.numCols));
+
+        for(unsigned int i = 0; i < AttributeTypes::NumTypesForCharacters; ++i) {
+            Frost::writeVBInteger(mapFile, randomInt(AdventureGamerConstants::MaxAttributeValue + 1));
+        }
+
+        Frost::writeVBInteger(mapFile, 1 + randomInt(SightTypes::NumTypes - 1));
+        Frost::writeVBInteger(mapFile, 1 + randomInt(3));   // Missionary, Trader or Fighter
+        Frost::writeVBLine(mapFile, "character" + std::to_string(id) + ".ico");
+        Frost::writeVBLine(mapFile, "character" + std::to_string(id) + ".wav");
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// writeRowFiles - Write the TXX file of every row. Rows without any
+/// descriptions still get a file, just like GameMap::writeMap does.
+/// @param (out) vector to store each file's contents in
+///----------------------------------------------------------------------------
+
+void WorldGenerator::writeRowFiles(std::vector<std::string>& rowFiles) {
+
+    rowFiles.assign(settings.numRows, std::string());
+
+    for(int row = 0; row < settings.numRows; ++row) {
+
+        std::string& rowFile = rowFiles[row];
+        const int rowStart = row * settings.numCols;
+        int numDescriptions = 0;
+
+        for(int col = 0; col < settings.numCols; ++col) {
+            if(!tiles[rowStart + col].description.empty()) {
+                numDescriptions++;
+            }
+        }
+
+        Frost::writeVBInteger(rowFile, numDescriptions);
+
+        for(int col = 0; col < settings.numCols; ++col) {
+
+            const std::string& description = tiles[rowStart + col].description;
+
+            if(!description.empty()) {
+                Frost::writeVBInteger(rowFile, col);
+                Frost::writeVBString(rowFile, description);
+            }
+
+        }
+
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// writeStoryFile - Write the STY file. The summary and story are not
+/// escaped in this file, so they never have quotes in them.
+/// @param (out) buffer to write the file to
+///----------------------------------------------------------------------------
+
+void WorldGenerator::writeStoryFile(std::string& storyFile) {
+
+    std::string text;
+
+    makeText(text, settings.summaryLength, false, true);
+    storyFile.push_back('\"');
+    storyFile.append(text);
+    storyFile.append("\"\r\n");
+
+    makeText(text, settings.storyLength, false, true);
+    storyFile.push_back('\"');
+    storyFile.append(text);
+    storyFile.append("\"\r\n");
+
+}
@@ -0,0 +1,106 @@
+#ifndef __WORLDGENERATOR_H__
+#define __WORLDGENERATOR_H__
+
+#include <string>
+#include <vector>
+#include "../compat/stdint_compat.h"
+
+///----------------------------------------------------------------------------
+/// WorldGenerator - Creates synthetic worlds (SG0, TXX and STY files) to
+/// benchmark and stress test the editor with. The same settings and seed
+/// always give the same files, byte for byte, on every platform. Every world
+/// it makes can be read by GameMap::readMap and passes
+/// validateTileDirections.
+///----------------------------------------------------------------------------
+
+class WorldGenerator {
+
+    public:
+
+        //---------------------------------------------------------------------
+        // Settings - What the world should contain. Percentages are of the
+        // tiles that have a road on them, except for roadPercent, which is of
+        // all tiles.
+        //---------------------------------------------------------------------
+
+        struct Settings {
+
+            Settings();
+
+            uint32_t    seed;
+            int         numRows;
+            int         numCols;
+            int         roadPercent;
+            int         dirtRoadPercent;
+            int         darkPercent;
+            int         gatePercent;
+            int         descriptionPercent;
+            int         descriptionLength;
+            int         numJumps;
+            int         numSwitches;
+            int         numObjects;
+            int         numCharacters;
+            int         summaryLength;
+            int         storyLength;
+
+        };
+
+        static Settings smallWorld();
+        static Settings mediumWorld();
+        static Settings maxWorld();
+
+        explicit WorldGenerator(const Settings& inSettings);
+
+        void generate(const std::string& filePath, const std::string& worldName);
+        void generate(std::string& outMapFile, std::vector<std::string>& outRowFiles, std::string& outStoryFile);
+
+    private:
+
+        struct Tile {
+            uint8_t         sprite;
+            uint8_t         flags;
+            std::string     name;
+            std::string     description;
+        };
+
+        struct Connection {
+            int             fromIndex;
+            int             toIndex;
+        };
+
+        WorldGenerator() {};
+
+        uint32_t nextRandom();
+        int randomInt(const int& limit);
+        bool randomPercent(const int& percent);
+
+        uint8_t allowedExits(const int& index) const;
+        uint8_t randomExits(const uint8_t& allowed);
+        int takeFeatureTile();
+
+        void makeText(std::string& outText, const int& length, const bool& allowQuotes,
+                      const bool& allowLineBreaks);
+
+        void placeTiles();
+        void placeJumps();
+        void placeSwitches();
+        void decorateTiles();
+
+        void writeMapFile(std::string& mapFile);
+        void writeObjects(std::string& mapFile);
+        void writeCharacters(std::string& mapFile);
+        void writeRowFiles(std::vector<std::string>& rowFiles);
+        void writeStoryFile(std::string& storyFile);
+
+        Settings                    settings;
+        uint32_t                    randomState;
+        std::vector<Tile>           tiles;
+        std::vector<int>            featureOrder;   // Shuffled tile indices
+        size_t                      nextFeature;
+        std::vector<int>            roadTiles;
+        std::vector<Connection>     jumps;
+        std::vector<Connection>     switches;
+
+};
+
+#endif // __WORLDGENERATOR_H__
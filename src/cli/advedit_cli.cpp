@@ -0,0 +1,547 @@
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../model/gamemap.h"
+#include "../model/gamemap_cache.h"
+#include "../util/frost.h"
+#include "../util/workerpool.h"
+#include "../util/worldstorage.h"
+#include "../compat/std_extras_compat.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// advedit-cli - Loads, validates and optionally re-saves Adventure Gamer
+/// worlds without creating any windows, or just scans their layout. Directories are searched recursively
+/// for SG0 files.
+///----------------------------------------------------------------------------
+
+namespace CLIExitCodes {
+    const int Success       = 0;
+    const int WorldsFailed  = 1;
+    const int BadArguments  = 2;
+}
+
+struct CLIOptions {
+    unsigned int                numJobs;
+    bool                        resave;
+    bool                        useCache;
+    bool                        diagnose;
+    bool                        scan;
+    bool                        quiet;
+    std::vector<std::string>    paths;
+};
+
+//=============================================================================
+// WorldJob - Processes a single world file.
+//=============================================================================
+
+class WorldJob : public WorkerJob {
+
+    public:
+
+        WorldJob(const std::string& inFullPath, const CLIOptions& inOptions) :
+                 fullPath(inFullPath), options(inOptions), succeeded(false) {}
+
+        virtual void run();
+
+        const std::string& getFullPath() const { return fullPath; }
+        const std::string& getMessage() const { return message; }
+        const std::vector<WorldDiagnostic>& getDiagnostics() const { return diagnostics; }
+        const bool& getSucceeded() const { return succeeded; }
+
+    private:
+
+        void diagnose(GameMap& gameMap, const std::string& filePath, const std::string& fileName);
+        void scan(const std::string& filePath, const std::string& fileName);
+        void validate(const GameMap& gameMap);
+
+        std::string                     fullPath;
+        const CLIOptions&               options;
+        std::string                     message;
+        std::vector<WorldDiagnostic>    diagnostics;
+        bool                            succeeded;
+
+};
+
+///----------------------------------------------------------------------------
+/// run - Load the world, validate it, and if requested, write it back out.
+/// Any errors are recorded in the job rather than thrown so one bad world does
+/// not stop the rest of the batch.
+///----------------------------------------------------------------------------
+
+void WorldJob::run() {
+
+    const size_t separatorPos = fullPath.find_last_of("/\\");
+    const std::string filePath = (separatorPos == std::string::npos) ? "" : fullPath.substr(0, separatorPos + 1);
+    const std::string fileName = fullPath.substr(separatorPos == std::string::npos ? 0 : separatorPos + 1);
+
+    try {
+
+        if(options.scan) {
+            scan(filePath, fileName);
+            succeeded = true;
+            return;
+        }
+
+        GameMap gameMap;
+
+        if(options.diagnose) {
+            diagnose(gameMap, filePath, fileName);
+        }
+        else if(options.useCache) {
+            FileWorldStorage storage(filePath);
+            GameMapCache mapCache(storage, fileName);
+            mapCache.load(gameMap);
+            validate(gameMap);
+            mapCache.update(gameMap);
+        }
+        else {
+            gameMap.readMap(filePath, fileName);
+            validate(gameMap);
+        }
+
+        if(options.resave) {
+            gameMap.writeMap(filePath, fileName);
+        }
+
+        succeeded = true;
+
+    }
+    catch(const std::exception& e) {
+        message = e.what();
+        succeeded = false;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// diagnose - Reads the world without stopping at the first problem, and
+/// validates whatever could be read. The cache is never used, as it only
+/// holds worlds that were read without problems.
+/// @param the game map to read into
+/// @param a string to the path where the map file is located
+/// @param a string indicating the file's name
+/// @throws runtime_error saying how many problems there were, if any.
+///----------------------------------------------------------------------------
+
+void WorldJob::diagnose(GameMap& gameMap, const std::string& filePath, const std::string& fileName) {
+
+    gameMap.readMap(filePath, fileName, diagnostics);
+
+    // If not even the size of the map could be read, there is nothing to
+    // validate.
+
+    if(!gameMap.getTiles().empty()) {
+
+        try {
+            validate(gameMap);
+        }
+        catch(const std::runtime_error& e) {
+            diagnostics.push_back(WorldDiagnostic(fileName, 0, e.what()));
+        }
+
+    }
+
+    if(!diagnostics.empty()) {
+        throw std::runtime_error(std::to_string(diagnostics.size()) + " problem(s) found.");
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// scan - Reads only the layout of the world, and describes it in the job's
+/// message.
+/// @param a string to the path where the map file is located
+/// @param a string indicating the file's name
+/// @throws runtime_error if the layout could not be read.
+///----------------------------------------------------------------------------
+
+void WorldJob::scan(const std::string& filePath, const std::string& fileName) {
+
+    GameMapScan mapScan;
+    GameMap::scanMap(filePath, fileName, mapScan);
+
+    const std::vector<uint8_t>& sprites = mapScan.getSprites();
+    const std::vector<uint8_t>& flags = mapScan.getFlags();
+    int numUsed = 0;
+    int numDark = 0;
+
+    for(size_t i = 0; i < sprites.size(); ++i) {
+
+        if(sprites[i] != 0) {
+            numUsed++;
+        }
+
+        if(flags[i] & TileFlags::Dark) {
+            numDark++;
+        }
+
+    }
+
+    message = std::to_string(mapScan.getWidth()) + "x" + std::to_string(mapScan.getHeight()) + ", " +
+              std::to_string(numUsed) + " tile(s) used, " + std::to_string(numDark) + " dark, " +
+              std::to_string(static_cast<int>(mapScan.getJumpPoints().size())) + " jump(s), " +
+              std::to_string(static_cast<int>(mapScan.getSwitchConnections().size())) + " switch(es)";
+
+}
+
+///----------------------------------------------------------------------------
+/// validate - Runs the same checks the editor does before a world is saved.
+/// @param the game map to check
+/// @throws runtime_error if the world fails any of the checks
+///----------------------------------------------------------------------------
+
+void WorldJob::validate(const GameMap& gameMap) {
+
+    const int badTileIndex = gameMap.validateTileDirections();
+
+    if(badTileIndex != -1) {
+        int row = 0;
+        int col = 0;
+        gameMap.rowColFromIndex(row, col, badTileIndex);
+        throw std::runtime_error("Tile at row " + std::to_string(row) + ", column " +
+                                 std::to_string(col) + " leads off the edge of the map.");
+    }
+
+    const GameInfo& gameInfo = gameMap.getGameInfo();
+
+    if(!gameMap.isRowColInMapBounds(gameInfo.getPlayerStartY(), gameInfo.getPlayerStartX())) {
+        throw std::runtime_error("Player start position is outside the boundaries of the map.");
+    }
+
+}
+
+//=============================================================================
+// Helper Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// isWorldFile - Checks if the file name has the world file extension
+/// @param file name to check
+/// @return true if it ends with .SG0 in any case, false otherwise.
+///----------------------------------------------------------------------------
+
+static bool isWorldFile(const std::string& fileName) {
+
+    const std::string extension = "." + AdventureGamerConstants::FileNameExtension;
+
+    if(fileName.length() <= extension.length()) {
+        return false;
+    }
+
+    const size_t startPos = fileName.length() - extension.length();
+
+    for(size_t i = 0; i < extension.length(); ++i) {
+        if(toupper(static_cast<unsigned char>(fileName[startPos + i])) != extension[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+///----------------------------------------------------------------------------
+/// findWorldFiles - Add the path given to the list of worlds. If the path is
+/// a directory, it is searched recursively for world files. Directories
+/// reached through a symbolic link (or junction) inside it are not searched,
+/// as one pointing back up the tree would never end, but linked files are.
+/// @param file or directory to search
+/// @param (out) vector to add the full path of each world file to
+/// @return false if the path does not exist, true otherwise.
+///----------------------------------------------------------------------------
+
+static bool findWorldFiles(const std::string& path, std::vector<std::string>& outFiles) {
+
+#ifdef _WIN32
+
+    const DWORD attributes = GetFileAttributesA(path.c_str());
+
+    if(attributes == INVALID_FILE_ATTRIBUTES) {
+        return false;
+    }
+
+    if(!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        outFiles.push_back(path);
+        return true;
+    }
+
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((path + "\\*").c_str(), &findData);
+
+    if(findHandle == INVALID_HANDLE_VALUE) {
+        return true;
+    }
+
+    do {
+
+        const std::string entryName = findData.cFileName;
+
+        if(entryName == "." || entryName == "..") {
+            continue;
+        }
+
+        const std::string entryPath = path + "\\" + entryName;
+
+        if(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if(!(findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+                findWorldFiles(entryPath, outFiles);
+            }
+        }
+        else if(isWorldFile(entryName)) {
+            outFiles.push_back(entryPath);
+        }
+
+    } while(FindNextFileA(findHandle, &findData));
+
+    FindClose(findHandle);
+
+#else
+
+    struct stat fileInfo;
+
+    if(stat(path.c_str(), &fileInfo) != 0) {
+        return false;
+    }
+
+    if(!S_ISDIR(fileInfo.st_mode)) {
+        outFiles.push_back(path);
+        return true;
+    }
+
+    DIR* directory = opendir(path.c_str());
+
+    if(directory == NULL) {
+        return true;
+    }
+
+    std::vector<std::string> subDirectories;
+    struct dirent* entry;
+
+    while((entry = readdir(directory)) != NULL) {
+
+        const std::string entryName = entry->d_name;
+
+        if(entryName == "." || entryName == "..") {
+            continue;
+        }
+
+        const std::string entryPath = (Frost::endsWith(path, "/") ? path : path + "/") + entryName;
+
+        if(lstat(entryPath.c_str(), &fileInfo) != 0) {
+            continue;
+        }
+
+        // Follow links to files, but not to directories.
+
+        if(S_ISLNK(fileInfo.st_mode)) {
+            if(stat(entryPath.c_str(), &fileInfo) != 0 || S_ISDIR(fileInfo.st_mode)) {
+                continue;
+            }
+        }
+
+        if(S_ISDIR(fileInfo.st_mode)) {
+            subDirectories.push_back(entryPath);
+        }
+        else if(isWorldFile(entryName)) {
+            outFiles.push_back(entryPath);
+        }
+    }
+
+    closedir(directory);
+
+    for(size_t i = 0; i < subDirectories.size(); ++i) {
+        findWorldFiles(subDirectories[i], outFiles);
+    }
+
+#endif // _WIN32
+
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// printUsage - Print how to use the program
+///----------------------------------------------------------------------------
+
+static void printUsage() {
+    fprintf(stderr,
+            "Usage: advedit-cli [options] <world.SG0 | directory>...\n"
+            "\n"
+            "Loads and validates each world given. Directories are searched\n"
+            "recursively for .SG0 files.\n"
+            "\n"
+            "Options:\n"
+            "  --jobs N     Process up to N worlds at once (default: 1, 0 = one per CPU)\n"
+            "  --resave     Write each world back out after it validates\n"
+            "  --cache      Read worlds from their cache if it is up to date, and\n"
+            "               write the cache if it is not\n"
+            "  --diagnose   Keep reading after a problem and list every problem found,\n"
+            "               instead of only the first. Ignores --cache\n"
+            "  --scan       Only read the size, tiles and connections of each world,\n"
+            "               and print a summary of them. Ignores every option but\n"
+            "               --jobs and --quiet\n"
+            "  --quiet      Only report worlds that fail\n"
+            "  --help       Show this message\n");
+}
+
+///----------------------------------------------------------------------------
+/// parseArguments - Fill in the options from the command line
+/// @return true if the arguments were valid, false if they were not.
+///----------------------------------------------------------------------------
+
+static bool parseArguments(int argc, char* argv[], CLIOptions& options) {
+
+    options.numJobs  = 1;
+    options.resave   = false;
+    options.useCache = false;
+    options.diagnose = false;
+    options.scan     = false;
+    options.quiet    = false;
+
+    for(int i = 1; i < argc; ++i) {
+
+        const std::string arg = argv[i];
+
+        if(arg == "--jobs" || arg == "-j") {
+
+            if(i + 1 >= argc) {
+                fprintf(stderr, "%s requires a number.\n", arg.c_str());
+                return false;
+            }
+
+            try {
+                const int numJobs = std::stoi(argv[++i]);
+                if(numJobs < 0) {
+                    throw std::out_of_range("Negative");
+                }
+                options.numJobs = numJobs;
+            }
+            catch(const std::exception&) {
+                fprintf(stderr, "Invalid number of jobs: %s\n", argv[i]);
+                return false;
+            }
+
+        }
+        else if(arg == "--resave") {
+            options.resave = true;
+        }
+        else if(arg == "--cache") {
+            options.useCache = true;
+        }
+        else if(arg == "--diagnose") {
+            options.diagnose = true;
+        }
+        else if(arg == "--scan") {
+            options.scan = true;
+        }
+        else if(arg == "--quiet" || arg == "-q") {
+            options.quiet = true;
+        }
+        else if(arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if(Frost::startsWith(arg, "-")) {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+        else {
+            options.paths.push_back(arg);
+        }
+
+    }
+
+    return !options.paths.empty();
+
+}
+
+//=============================================================================
+// Entry Point
+//=============================================================================
+
+int main(int argc, char* argv[]) {
+
+    CLIOptions options;
+
+    if(!parseArguments(argc, argv, options)) {
+        printUsage();
+        return CLIExitCodes::BadArguments;
+    }
+
+    std::vector<std::string> worldFiles;
+    int numFailed = 0;
+
+    for(size_t i = 0; i < options.paths.size(); ++i) {
+        if(!findWorldFiles(options.paths[i], worldFiles)) {
+            fprintf(stderr, "FAIL %s: No such file or directory\n", options.paths[i].c_str());
+            numFailed++;
+        }
+    }
+
+    std::vector<WorldJob*> worldJobs;
+    std::vector<WorkerJob*> jobs;
+    worldJobs.reserve(worldFiles.size());
+    jobs.reserve(worldFiles.size());
+
+    for(size_t i = 0; i < worldFiles.size(); ++i) {
+        WorldJob* job = new WorldJob(worldFiles[i], options);
+        worldJobs.push_back(job);
+        jobs.push_back(job);
+    }
+
+    WorkerPool workerPool(options.numJobs);
+    workerPool.runJobs(jobs);
+
+    // Report in the order the files were found so the output is the same
+    // no matter how many jobs were used.
+
+    for(size_t i = 0; i < worldJobs.size(); ++i) {
+
+        const WorldJob& job = *worldJobs[i];
+
+        if(job.getSucceeded()) {
+            if(!options.quiet) {
+                if(job.getMessage().empty()) {
+                    printf("OK   %s\n", job.getFullPath().c_str());
+                }
+                else {
+                    printf("OK   %s: %s\n", job.getFullPath().c_str(), job.getMessage().c_str());
+                }
+            }
+        }
+        else {
+            printf("FAIL %s: %s\n", job.getFullPath().c_str(), job.getMessage().c_str());
+            numFailed++;
+
+            const std::vector<WorldDiagnostic>& diagnostics = job.getDiagnostics();
+
+            for(size_t j = 0; j < diagnostics.size(); ++j) {
+                if(diagnostics[j].lineNumber) {
+                    printf("     %s:%u: %s\n", diagnostics[j].fileName.c_str(),
+                           static_cast<unsigned int>(diagnostics[j].lineNumber), diagnostics[j].message.c_str());
+                }
+                else {
+                    printf("     %s: %s\n", diagnostics[j].fileName.c_str(), diagnostics[j].message.c_str());
+                }
+            }
+        }
+
+        delete worldJobs[i];
+        worldJobs[i] = NULL;
+    }
+
+    if(!options.quiet) {
+        printf("%u world(s) checked, %d failed.\n", static_cast<unsigned int>(worldFiles.size()), numFailed);
+    }
+
+    return numFailed ? CLIExitCodes::WorldsFailed : CLIExitCodes::Success;
+
+}
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include "../compat/std_extras_compat.h"
 #include "../util/languagemapper.h"
+#include "../model/gamemap_cache.h"
+#include "../util/worldstorage.h"
 
 namespace KeyboardDirections {
     const int LEFT  = 0;
@@ -17,7 +19,7 @@ namespace KeyboardDirections {
 //=============================================================================
 
 GameWorldController::GameWorldController(MainWindowInterface* inMainWindow) : mainWindow (inMainWindow),
-changedSinceLastSave(false) {
+changedSinceLastSave(false), useWorldCache(EditorConstants::DefaultUseWorldCache) {
     gameMap = NULL; // new GameMap(EditorConstants::DefaultRows, EditorConstants::DefaultCols);
     worldFilePath = "";
     worldFileName = "";
@@ -848,10 +850,14 @@ bool GameWorldController::tryToggleSwitchState() {
     }
 
     updatedTile.sprite(newSprite);
-    gameMap->updateTile(gmKey, selectedTileIndex, updatedTile.build());
+
+    // Only the switch and the tiles it lights or opens need to be drawn again.
+
+    std::vector<int> changedTiles;
+    gameMap->updateTile(gmKey, selectedTileIndex, updatedTile.build(), changedTiles);
 
     changedSinceLastSave = true;
-    mainWindow->onTileUpdated(selectedTileIndex, EditorTileUpdateFlags::Type);
+    mainWindow->onSwitchToggled(selectedTileIndex, changedTiles);
 
     return true;
 }
@@ -1714,24 +1720,25 @@ bool GameWorldController::tryFinishSave(const std::string& newPath, const std::s
     }
 
     LanguageMapper& langMap = LanguageMapper::getInstance();
-    std::string fullPathName = tempFilePath + tempFileName;
-    std::ofstream ofs;
 
-#ifdef _WIN32
-    std::wstring wFullPathName = AtoW(fullPathName.c_str(), CP_UTF8);
-    ofs.open(wFullPathName.c_str(), std::ofstream::out | std::ios::binary);
-#else 
-    ofs.open(fullPathName.c_str(), std::ofstream::out | std::ios::binary);
-#endif // _Win32
-
-    if(!ofs) {
-        mainWindow->displayErrorMessage(langMap.get("ErrSavingWorldText"),
-                                        langMap.get("ErrSavingWorldTitle"));
+    try {
+        gameMap->writeMap(tempFilePath, tempFileName);
+    }
+    catch (const std::runtime_error& e) {
+
+        // Any files that were already replaced are put back from their
+        // backups, so the world on disk is usually as it was. If some could
+        // not be, the error names them, and the world is only partly saved,
+        // so the user has to be told why.
+
+        std::string errorText = langMap.get("ErrSavingWorldText");
+        errorText.append("\n\n");
+        errorText.append(e.what());
+
+        mainWindow->displayErrorMessage(errorText, langMap.get("ErrSavingWorldTitle"));
         return false;
     }
 
-    // TODO: Try
-    gameMap->writeMap(ofs, tempFilePath, tempFileName);
     changedSinceLastSave = false;
 
     // Save was successful, now we can update the paths.
@@ -1801,19 +1808,17 @@ bool GameWorldController::tryFinishLoad(const std::string& newPath, const std::s
 
     LanguageMapper& langMap = LanguageMapper::getInstance();
     std::string fileNameTemp = newPath + newFileName;
-    std::ifstream ifs;
 
 // TODO: 98 Compat testing
-    
+
 #ifdef _WIN32
     std::wstring wFullPathName = AtoW(fileNameTemp.c_str(), CP_UTF8);
-    ifs.open(wFullPathName.c_str(), std::ifstream::in | std::ios::binary);
-#else 
-    ifs.open(fileNameTemp.c_str(), std::ifstream::in | std::ios::binary);
+    const bool fileExists = Frost::doesFileExist(wFullPathName);
+#else
+    const bool fileExists = Frost::doesFileExist(fileNameTemp);
 #endif
-   
 
-    if(!ifs) {
+    if(!fileExists) {
         mainWindow->displayErrorMessage(langMap.get("ErrLoadingWorldText"),
                                         langMap.get("ErrLoadingWorldTitle"));
         return false;
@@ -1821,9 +1826,25 @@ bool GameWorldController::tryFinishLoad(const std::string& newPath, const std::s
 
     GameMap* newMap = new GameMap();
 
+    // Text is only decoded when a tile or entity is looked at, which most
+    // never are in a session.
+
+    newMap->setLazyText(true);
+
+    FileWorldStorage storage(newPath);
+    GameMapCache mapCache(storage, newFileName);
+
     try {
 
-        newMap->readMap(ifs, newPath, newFileName);
+        // If the cache is on, reopening a world that has not changed since
+        // it was last opened can skip parsing it.
+
+        if(useWorldCache) {
+            mapCache.load(*newMap);
+        }
+        else {
+            newMap->readMap(newPath, newFileName);
+        }
 
     }
     catch (const std::runtime_error& e) {
@@ -1873,6 +1894,11 @@ bool GameWorldController::tryFinishLoad(const std::string& newPath, const std::s
     mainWindow->onWorldInfoUpdated();
     mainWindow->onWorldStateChanged();    
 
+    // The world is already shown, so the cache is written after it, if it
+    // needs to be.
+
+    mapCache.update(*gameMap);
+
     return true;
 
 }
@@ -37,6 +37,9 @@ class GameWorldController {
         const GameTile& getSelectedTile() const;
 
         bool hasUnsavedChanges() const;
+
+        bool getUseWorldCache() const { return useWorldCache; }
+        void setUseWorldCache(const bool& inUseWorldCache) { useWorldCache = inUseWorldCache; }
         
         bool tryAlterObject(const int& alterType, const int& index);
         bool tryAddObject(GameObject::Builder& objectBuilder);
@@ -131,6 +134,7 @@ class GameWorldController {
         // Variables
 
         bool                            changedSinceLastSave;
+        bool                            useWorldCache;
 
         std::string                     worldFilePath;
         std::string                     worldFileName;
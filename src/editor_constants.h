@@ -18,6 +18,10 @@ namespace EditorConstants {
 
     const int IGNORE_ROW                    = -1;
     const int IGNORE_COL                    = -1;
+
+    // The world cache writes a file next to every world that is opened, so
+    // it is only used if it is turned on.
+    const bool DefaultUseWorldCache         = false;
 }           
 
 ///----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include "../model/gamecharacter.h"
 #include "../model/gameinfo.h"
 #include <string>
+#include <vector>
 
 namespace EditorDialogTypes {
     const int AlterObject           = 0;
@@ -149,6 +150,14 @@ class MainWindowInterface {
         ///--------------------------------------------------------------------
         virtual void onTileUpdated(const int& index, const int& tileUpdateFlags) = 0;
 
+        ///--------------------------------------------------------------------
+        /// Sent when a switch was turned on or off.
+        /// @param an integer specifying the index of the switch's tile
+        /// @param the indices of the tiles connected to it that were lit,
+        /// darkened, opened or closed by it
+        ///--------------------------------------------------------------------
+        virtual void onSwitchToggled(const int& index, const std::vector<int>& changedTiles) = 0;
+
         ///--------------------------------------------------------------------
         /// Sent when the user selected a new tile to draw with
         ///--------------------------------------------------------------------
@@ -0,0 +1,104 @@
+#include "connection_index.h"
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// reset - Removes every connection from the index.
+///----------------------------------------------------------------------------
+
+void ConnectionIndex::reset() {
+    byFirstPoint.reset(0);
+    bySecondPoint.reset(0);
+    pointTiles.clear();
+    firstOnTiles.clear();
+}
+
+///----------------------------------------------------------------------------
+/// insert - Adds a connection that was inserted into the map's vector. Every
+/// connection at or after its index is moved up by one.
+/// @param index the connection was inserted at
+/// @param tile of its first point, or NoGroup if it is not on the map
+/// @param tile of its second point, or NoGroup if it is not on the map
+///----------------------------------------------------------------------------
+
+void ConnectionIndex::insert(const size_t& connectionIndex, const int& firstTile, const int& secondTile) {
+
+    byFirstPoint.insert(connectionIndex, firstTile);
+    bySecondPoint.insert(connectionIndex, secondTile);
+
+    const int tiles[2] = { firstTile, secondTile };
+    pointTiles.insert(pointTiles.begin() + connectionIndex * 2, tiles, tiles + 2);
+
+    // Connections are nearly always added to the end, which can only change
+    // the first connection of its own tiles.
+
+    for(size_t i = pointTiles.size() - 1; i >= connectionIndex * 2; --i) {
+
+        updateFirst(pointTiles[i]);
+
+        if(i == 0) {
+            break;
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// erase - Removes a connection that was erased from the map's vector. Every
+/// connection after it is moved down by one.
+/// @param index the connection was at
+///----------------------------------------------------------------------------
+
+void ConnectionIndex::erase(const size_t& connectionIndex) {
+
+    byFirstPoint.erase(connectionIndex);
+    bySecondPoint.erase(connectionIndex);
+
+    const int erasedTiles[2] = { pointTiles[connectionIndex * 2], pointTiles[connectionIndex * 2 + 1] };
+    pointTiles.erase(pointTiles.begin() + connectionIndex * 2, pointTiles.begin() + connectionIndex * 2 + 2);
+
+    updateFirst(erasedTiles[0]);
+    updateFirst(erasedTiles[1]);
+
+    for(size_t i = connectionIndex * 2; i < pointTiles.size(); ++i) {
+        updateFirst(pointTiles[i]);
+    }
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// updateFirst - Finds the first connection a tile is part of again, after
+/// the connections on it have changed.
+/// @param the tile, or NoGroup, which is ignored
+///----------------------------------------------------------------------------
+
+void ConnectionIndex::updateFirst(const int& tile) {
+
+    if(tile < 0) {
+        return;
+    }
+
+    if(static_cast<size_t>(tile) >= firstOnTiles.size()) {
+        firstOnTiles.resize(tile + 1, -1);
+    }
+
+    const std::vector<size_t>& firsts = byFirstPoint.getEntities(tile);
+    const std::vector<size_t>& seconds = bySecondPoint.getEntities(tile);
+
+    if(firsts.empty() && seconds.empty()) {
+        firstOnTiles[tile] = -1;
+    }
+    else if(seconds.empty() || (!firsts.empty() && firsts.front() <= seconds.front())) {
+        firstOnTiles[tile] = static_cast<int>(firsts.front() * 2);
+    }
+    else {
+        firstOnTiles[tile] = static_cast<int>(seconds.front() * 2 + 1);
+    }
+
+}
@@ -0,0 +1,66 @@
+#ifndef __CONNECTION_INDEX_H__
+#define __CONNECTION_INDEX_H__
+
+#include "entitygroup_index.h"
+
+namespace ConnectionIndexConstants {
+    const size_t NotFound = (size_t)-1;
+}
+
+///----------------------------------------------------------------------------
+/// ConnectionIndex - Which connections (jumps or switches) each tile is part
+/// of, by their index in the map's vector of them. A tile can be part of
+/// more than one connection, and the first one in the vector is the one that
+/// counts, so every one is kept in order for each end of the connection, and
+/// the first one is kept in a table by tile so drawing only has to look
+/// once. The index has to be told about every connection that is added or
+/// removed.
+///----------------------------------------------------------------------------
+
+class ConnectionIndex {
+
+    public:
+
+        ConnectionIndex() {}
+
+        void reset();
+
+        void insert(const size_t& connectionIndex, const int& firstTile, const int& secondTile);
+        void erase(const size_t& connectionIndex);
+
+        ///--------------------------------------------------------------------
+        /// findFirst - Finds the first connection a tile is part of.
+        /// @param tile to find
+        /// @param (out) true if the tile is the connection's first point,
+        /// false if it is the second. If it is both, it is the first.
+        /// @return the index of the connection, or NotFound if there is none.
+        ///--------------------------------------------------------------------
+
+        size_t findFirst(const int& tile, bool& isFirstPoint) const {
+
+            if(tile < 0 || static_cast<size_t>(tile) >= firstOnTiles.size() || firstOnTiles[tile] < 0) {
+                return ConnectionIndexConstants::NotFound;
+            }
+
+            isFirstPoint = (firstOnTiles[tile] & 1) == 0;
+            return static_cast<size_t>(firstOnTiles[tile] >> 1);
+        }
+
+        const std::vector<size_t>& getWithFirstPoint(const int& tile) const { return byFirstPoint.getEntities(tile); }
+        const std::vector<size_t>& getWithSecondPoint(const int& tile) const { return bySecondPoint.getEntities(tile); }
+
+    private:
+
+        void updateFirst(const int& tile);
+
+        EntityGroupIndex    byFirstPoint;
+        EntityGroupIndex    bySecondPoint;
+        std::vector<int>    pointTiles;     // Both tiles of each connection, by index.
+
+        // By tile, the index of the first connection times 2, plus 1 if the
+        // tile is its second point. -1 if the tile is not part of any.
+        std::vector<int>    firstOnTiles;
+
+};
+
+#endif // __CONNECTION_INDEX_H__
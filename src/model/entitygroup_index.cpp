@@ -0,0 +1,162 @@
+#include "entitygroup_index.h"
+#include <algorithm>
+
+// Returned for groups that nothing has been put in.
+static const std::vector<size_t> noEntities;
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// reset - Empties the index, and sizes it for the number of groups given.
+/// The memory of each group's list is kept. More groups are added if an
+/// entity is put in one past the end.
+/// @param number of groups, such as the number of tiles in the map
+///----------------------------------------------------------------------------
+
+void EntityGroupIndex::reset(const size_t& numGroups) {
+
+    const size_t numKept = std::min(numGroups, groupEntities.size());
+
+    for(size_t i = 0; i < numKept; ++i) {
+        groupEntities[i].clear();
+    }
+
+    groupEntities.resize(numGroups);
+    entityGroups.clear();
+
+}
+
+///----------------------------------------------------------------------------
+/// insert - Adds an entity that was inserted into the map's vector. Every
+/// entity at or after its index is moved up by one, as they were in the
+/// vector.
+/// @param index the entity was inserted at
+/// @param group the entity is in, or NoGroup
+///----------------------------------------------------------------------------
+
+void EntityGroupIndex::insert(const size_t& entityIndex, const int& group) {
+
+    const size_t oldSize = entityGroups.size();
+    entityGroups.insert(entityGroups.begin() + entityIndex, EntityGroupIndexConstants::NoGroup);
+
+    // Highest first, so each group's list stays in order as it is renumbered.
+
+    for(size_t i = oldSize; i > entityIndex; --i) {
+        renumber(entityGroups[i], i - 1, i);
+    }
+
+    move(entityIndex, group);
+
+}
+
+///----------------------------------------------------------------------------
+/// erase - Removes an entity that was erased from the map's vector. Every
+/// entity after it is moved down by one.
+/// @param index the entity was at
+///----------------------------------------------------------------------------
+
+void EntityGroupIndex::erase(const size_t& entityIndex) {
+
+    move(entityIndex, EntityGroupIndexConstants::NoGroup);
+
+    // Lowest first, for the same reason as insert.
+
+    for(size_t i = entityIndex + 1; i < entityGroups.size(); ++i) {
+        renumber(entityGroups[i], i, i - 1);
+    }
+
+    entityGroups.erase(entityGroups.begin() + entityIndex);
+
+}
+
+///----------------------------------------------------------------------------
+/// move - Moves an entity to a different group, such as when it was replaced.
+/// @param index of the entity
+/// @param group it is now in, or NoGroup
+///----------------------------------------------------------------------------
+
+void EntityGroupIndex::move(const size_t& entityIndex, const int& group) {
+
+    int& currentGroup = entityGroups[entityIndex];
+
+    if(currentGroup == group) {
+        return;
+    }
+
+    removeFromGroup(entityIndex, currentGroup);
+    addToGroup(entityIndex, group);
+    currentGroup = group;
+
+}
+
+///----------------------------------------------------------------------------
+/// getEntities - Gets the entities in a group.
+/// @param the group
+/// @return the indices of the entities in it, in ascending order.
+///----------------------------------------------------------------------------
+
+const std::vector<size_t>& EntityGroupIndex::getEntities(const int& group) const {
+
+    if(group < 0 || static_cast<size_t>(group) >= groupEntities.size()) {
+        return noEntities;
+    }
+
+    return groupEntities[group];
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+void EntityGroupIndex::addToGroup(const size_t& entityIndex, const int& group) {
+
+    if(group < 0) {
+        return;
+    }
+
+    if(static_cast<size_t>(group) >= groupEntities.size()) {
+        groupEntities.resize(group + 1);
+    }
+
+    std::vector<size_t>& entities = groupEntities[group];
+    entities.insert(std::lower_bound(entities.begin(), entities.end(), entityIndex), entityIndex);
+
+}
+
+void EntityGroupIndex::removeFromGroup(const size_t& entityIndex, const int& group) {
+
+    if(group < 0 || static_cast<size_t>(group) >= groupEntities.size()) {
+        return;
+    }
+
+    std::vector<size_t>& entities = groupEntities[group];
+    std::vector<size_t>::iterator it = std::lower_bound(entities.begin(), entities.end(), entityIndex);
+
+    if(it != entities.end() && *it == entityIndex) {
+        entities.erase(it);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// renumber - Changes the index an entity is listed under in its group. The
+/// new index must not put it out of order with the others in that group.
+///----------------------------------------------------------------------------
+
+void EntityGroupIndex::renumber(const int& group, const size_t& oldIndex, const size_t& newIndex) {
+
+    if(group < 0 || static_cast<size_t>(group) >= groupEntities.size()) {
+        return;
+    }
+
+    std::vector<size_t>& entities = groupEntities[group];
+    std::vector<size_t>::iterator it = std::lower_bound(entities.begin(), entities.end(), oldIndex);
+
+    if(it != entities.end() && *it == oldIndex) {
+        *it = newIndex;
+    }
+
+}
@@ -0,0 +1,48 @@
+#ifndef __ENTITYGROUP_INDEX_H__
+#define __ENTITYGROUP_INDEX_H__
+
+#include <cstddef>
+#include <vector>
+
+namespace EntityGroupIndexConstants {
+    // Used for entities that are not in any group, such as objects being
+    // carried by a character when grouping by tile.
+    const int NoGroup = -1;
+}
+
+///----------------------------------------------------------------------------
+/// EntityGroupIndex - Which entities (objects or characters) are in each
+/// group, by their index in the map's vector of them. A group is whatever
+/// the map groups them by: the tile they are on, or the ID of something they
+/// refer to. Each group's indices are kept in ascending order, the same
+/// order the entities are in, so finding what is in a group only costs what
+/// is in it. The index has to be told about every entity that is added,
+/// changed or removed.
+///----------------------------------------------------------------------------
+
+class EntityGroupIndex {
+
+    public:
+
+        EntityGroupIndex() {}
+
+        void reset(const size_t& numGroups);
+
+        void insert(const size_t& entityIndex, const int& group);
+        void erase(const size_t& entityIndex);
+        void move(const size_t& entityIndex, const int& group);
+
+        const std::vector<size_t>& getEntities(const int& group) const;
+
+    private:
+
+        void addToGroup(const size_t& entityIndex, const int& group);
+        void removeFromGroup(const size_t& entityIndex, const int& group);
+        void renumber(const int& group, const size_t& oldIndex, const size_t& newIndex);
+
+        std::vector<std::vector<size_t> >   groupEntities;
+        std::vector<int>                    entityGroups;   // The group each entity is in, or NoGroup.
+
+};
+
+#endif // __ENTITYGROUP_INDEX_H__
@@ -0,0 +1,221 @@
+#include "entityid_index.h"
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// clear - Removes every entity from the index.
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::clear() {
+    entityIDs.clear();
+    firstIndices.clear();
+    useCounts.clear();
+    usedBits.clear();
+}
+
+///----------------------------------------------------------------------------
+/// insert - Adds an entity that was inserted into the map's vector. Every
+/// entity at or after its index is moved up by one, as they were in the
+/// vector.
+/// @param index the entity was inserted at
+/// @param ID of the entity
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::insert(const size_t& entityIndex, const int& id) {
+
+    entityIDs.insert(entityIDs.begin() + entityIndex, id);
+
+    // Highest first, so an ID used twice is not moved up twice.
+
+    for(size_t i = entityIDs.size() - 1; i > entityIndex; --i) {
+
+        const int& movedID = entityIDs[i];
+
+        if(isInTable(movedID) && firstIndices[movedID] == i - 1) {
+            firstIndices[movedID] = i;
+        }
+    }
+
+    addID(entityIndex, id);
+
+}
+
+///----------------------------------------------------------------------------
+/// erase - Removes an entity that was erased from the map's vector. Every
+/// entity after it is moved down by one.
+/// @param index the entity was at
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::erase(const size_t& entityIndex) {
+
+    removeID(entityIndex, entityIDs[entityIndex]);
+
+    // Lowest first, for the same reason as insert.
+
+    for(size_t i = entityIndex + 1; i < entityIDs.size(); ++i) {
+
+        const int& movedID = entityIDs[i];
+
+        if(isInTable(movedID) && firstIndices[movedID] == i) {
+            firstIndices[movedID] = i - 1;
+        }
+    }
+
+    entityIDs.erase(entityIDs.begin() + entityIndex);
+
+}
+
+///----------------------------------------------------------------------------
+/// change - Changes the ID of an entity, such as when it was replaced.
+/// @param index of the entity
+/// @param its new ID
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::change(const size_t& entityIndex, const int& id) {
+
+    if(entityIDs[entityIndex] == id) {
+        return;
+    }
+
+    removeID(entityIndex, entityIDs[entityIndex]);
+    entityIDs[entityIndex] = id;
+    addID(entityIndex, id);
+
+}
+
+///----------------------------------------------------------------------------
+/// find - Finds the entity with an ID.
+/// @param ID to find
+/// @return the index of the first entity with the ID, or NotFound if none
+/// have it.
+///----------------------------------------------------------------------------
+
+size_t EntityIDIndex::find(const int& id) const {
+
+    if(isInTable(id)) {
+
+        if(static_cast<size_t>(id) < useCounts.size() && useCounts[id] != 0) {
+            return firstIndices[id];
+        }
+
+        return EntityIDIndexConstants::NotFound;
+    }
+
+    for(size_t i = 0; i < entityIDs.size(); ++i) {
+        if(entityIDs[i] == id) {
+            return i;
+        }
+    }
+
+    return EntityIDIndexConstants::NotFound;
+
+}
+
+///----------------------------------------------------------------------------
+/// getFirstUnusedID - Gets the lowest ID, starting from 1, that no entity
+/// has.
+///----------------------------------------------------------------------------
+
+int EntityIDIndex::getFirstUnusedID() const {
+
+    for(size_t word = 0; word < usedBits.size(); ++word) {
+
+        // ID 0 is never given out.
+        const uint32_t freeBits = ~(word == 0 ? (usedBits[word] | 1) : usedBits[word]);
+
+        if(freeBits != 0) {
+
+            int bit = 0;
+
+            while(!(freeBits & (static_cast<uint32_t>(1) << bit))) {
+                ++bit;
+            }
+
+            return static_cast<int>(word * 32) + bit;
+        }
+    }
+
+    int id = usedBits.empty() ? 1 : static_cast<int>(usedBits.size() * 32);
+
+    // Past the table, which only happens if every ID in it is used.
+
+    while(find(id) != EntityIDIndexConstants::NotFound) {
+        ++id;
+    }
+
+    return id;
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// addID - Records that the entity at an index has an ID, growing the tables
+/// to fit it if needed.
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::addID(const size_t& entityIndex, const int& id) {
+
+    if(!isInTable(id)) {
+        return;
+    }
+
+    if(static_cast<size_t>(id) >= useCounts.size()) {
+
+        // Whole words, so the bitset always covers the table.
+        const size_t newSize = (static_cast<size_t>(id) / 32 + 1) * 32;
+
+        firstIndices.resize(newSize, 0);
+        useCounts.resize(newSize, 0);
+        usedBits.resize(newSize / 32, 0);
+    }
+
+    if(useCounts[id]++ == 0) {
+        firstIndices[id] = entityIndex;
+        usedBits[id / 32] |= static_cast<uint32_t>(1) << (id % 32);
+    }
+    else if(entityIndex < firstIndices[id]) {
+        firstIndices[id] = entityIndex;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// removeID - Records that the entity at an index no longer has an ID. If
+/// another entity has the same ID, it becomes the one that is found.
+///----------------------------------------------------------------------------
+
+void EntityIDIndex::removeID(const size_t& entityIndex, const int& id) {
+
+    if(!isInTable(id)) {
+        return;
+    }
+
+    if(--useCounts[id] == 0) {
+        usedBits[id / 32] &= ~(static_cast<uint32_t>(1) << (id % 32));
+    }
+    else if(firstIndices[id] == entityIndex) {
+        firstIndices[id] = findAfter(id, entityIndex);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// findAfter - Finds the first entity with an ID after the index given.
+///----------------------------------------------------------------------------
+
+size_t EntityIDIndex::findAfter(const int& id, const size_t& skipIndex) const {
+
+    for(size_t i = skipIndex + 1; i < entityIDs.size(); ++i) {
+        if(entityIDs[i] == id) {
+            return i;
+        }
+    }
+
+    return EntityIDIndexConstants::NotFound;
+
+}
@@ -0,0 +1,54 @@
+#ifndef __ENTITYID_INDEX_H__
+#define __ENTITYID_INDEX_H__
+
+#include <cstddef>
+#include <vector>
+#include "../compat/stdint_compat.h"
+
+namespace EntityIDIndexConstants {
+    const size_t NotFound   = (size_t)-1;
+
+    // IDs above this are still found, but by searching every entity, so a
+    // bad ID in a world file cannot make the tables huge.
+    const int MaxTableID    = 4095;
+}
+
+///----------------------------------------------------------------------------
+/// EntityIDIndex - Finds entities (objects or characters) by their ID, and
+/// which IDs are free, without going through all of them. Each ID in use has
+/// the index of the first entity with it, and a bit set in a bitset, so the
+/// lowest free ID is found a word at a time. Like EntityGroupIndex, it has to
+/// be told about every entity that is added, changed or removed.
+///----------------------------------------------------------------------------
+
+class EntityIDIndex {
+
+    public:
+
+        EntityIDIndex() {}
+
+        void clear();
+
+        void insert(const size_t& entityIndex, const int& id);
+        void erase(const size_t& entityIndex);
+        void change(const size_t& entityIndex, const int& id);
+
+        size_t find(const int& id) const;
+        int getFirstUnusedID() const;
+
+    private:
+
+        static bool isInTable(const int& id) { return id > 0 && id <= EntityIDIndexConstants::MaxTableID; }
+
+        void addID(const size_t& entityIndex, const int& id);
+        void removeID(const size_t& entityIndex, const int& id);
+        size_t findAfter(const int& id, const size_t& skipIndex) const;
+
+        std::vector<int>        entityIDs;      // The ID of each entity, by index.
+        std::vector<size_t>     firstIndices;   // By ID, only valid if the ID is in use.
+        std::vector<size_t>     useCounts;      // By ID, as a world file can repeat one.
+        std::vector<uint32_t>   usedBits;       // By ID, set if its count is not 0.
+
+};
+
+#endif // __ENTITYID_INDEX_H__
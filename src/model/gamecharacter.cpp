@@ -1,79 +1,81 @@
 #include "gamecharacter.h"
 #include "../util/frost.h"
 #include "../compat/std_extras_compat.h"
+#include "worldfile_reader.h"
+#include <cstring>
 
-void GameCharacter::Builder::readCharacter(std::ifstream& mapFile) {
-       
-    std::string line;
-    Frost::getLineWindows(mapFile, line);
-    ID(std::stoi(line));
+///----------------------------------------------------------------------------
+/// readCharacter - Reads a character from a buffer. Only the descriptions are
+/// allocated, everything else is parsed in place.
+/// @param reader positioned at the start of the character
+/// @throws runtime_error if the character could not be read.
+///----------------------------------------------------------------------------
 
-    for(int i = 0; i < GameCharacterDescriptions::NumDescriptions; ++i) {
-        std::getline(mapFile, line);
-        description(Frost::trim(Frost::rtrim(line, "\r"), "\""), i);
-    }
+void GameCharacter::Builder::readCharacter(WorldFileReader& reader) {
 
-    Frost::getLineWindows(mapFile, line);
-    flags(std::stoi(line));
+    ID(reader.readInteger());
 
-    Frost::getLineWindows(mapFile, line);
-    unused(std::stoi(line));
+    for(int i = 0; i < GameCharacterDescriptions::NumDescriptions; ++i) {
+        reader.readQuotedLine(base.description[i]);
+    }
 
-    Frost::getLineWindows(mapFile, line);
-    money(std::stoi(line));
+    flags(reader.readInteger());
+    unused(reader.readInteger());
+    money(reader.readInteger());
 
-    Frost::getVBString(mapFile, line);
+    const char* locStart;
+    size_t locLength;
+    reader.readQuotedLine(locStart, locLength);
 
-    std::vector<std::string> tokens = Frost::split(line, ',');   
+    const char* comma = static_cast<const char*>(memchr(locStart, ',', locLength));
+    const size_t firstLength = comma ? static_cast<size_t>(comma - locStart) : 0;
+    const size_t secondLength = comma ? locLength - firstLength - 1 : 0;
 
-    if(tokens.size() == 2) {
-        location(std::stoi(tokens[0]), std::stoi(tokens[1]));        
-    }
-    else {
-        throw std::invalid_argument("Tried to read invalid location type.");
+    if(comma == NULL || secondLength == 0 || memchr(comma + 1, ',', secondLength) != NULL) {
+        throw std::runtime_error("Tried to read invalid location type" + reader.positionString() + ".");
     }
 
-    for(int i = 0; i < AttributeTypes::NumTypesForCharacters; i++) {
-        Frost::getLineWindows(mapFile, line);
-        attribute(std::stoi(line), i);
+    location(reader.parseInteger(locStart, firstLength), reader.parseInteger(comma + 1, secondLength));
+
+    for(unsigned int i = 0; i < AttributeTypes::NumTypesForCharacters; i++) {
+        attribute(reader.readInteger(), i);
     }
 
-    Frost::getLineWindows(mapFile, line);
-    sight(std::stoi(line));
+    sight(reader.readInteger());
+    type(reader.readInteger());
 
-    Frost::getLineWindows(mapFile, line);
-    type(std::stoi(line));
+    reader.readLine(base.description[GameCharacterDescriptions::Icon]);
+    reader.readLine(base.description[GameCharacterDescriptions::Sound]);
 
-    Frost::getLineWindows(mapFile, line);
-    description(line, GameCharacterDescriptions::Icon);
+}
 
-    Frost::getLineWindows(mapFile, line);
-    description(line, GameCharacterDescriptions::Sound);
+void GameCharacter::writeCharacter(std::string& mapBuffer) const {
 
-}
+    // Descriptions are written without being kept decoded, so saving a
+    // world opened with lazy text does not decode all of it.
 
-void GameCharacter::writeCharacter(std::ofstream& mapFile) const {
+    std::string scratch;
 
-    Frost::writeVBInteger(mapFile, base.ID);
+    Frost::writeVBInteger(mapBuffer, base.ID);
 
     for (int i = 0; i < GameCharacterDescriptions::NumDescriptions; ++i) {
-        Frost::writeVBString(mapFile, base.description[i]);
+        Frost::writeVBString(mapBuffer, base.description[i].getText(scratch));
     }
 
-    Frost::writeVBInteger(mapFile, base.flags);
-    Frost::writeVBInteger(mapFile, base.unused);
-    Frost::writeVBInteger(mapFile, base.money);
+    Frost::writeVBInteger(mapBuffer, base.flags);
+    Frost::writeVBInteger(mapBuffer, base.unused);
+    Frost::writeVBInteger(mapBuffer, base.money);
 
-    Frost::writeVBString(mapFile, base.location);
+    Frost::writeVBString(mapBuffer, base.location);
 
     for (int k = 0; k < AttributeTypes::NumTypesForCharacters; ++k) {
-        Frost::writeVBInteger(mapFile, base.attribute[k]);
+        Frost::writeVBInteger(mapBuffer, base.attribute[k]);
     }
 
-    Frost::writeVBInteger(mapFile, base.sight);
-    Frost::writeVBInteger(mapFile, base.type);
+    Frost::writeVBInteger(mapBuffer, base.sight);
+    Frost::writeVBInteger(mapBuffer, base.type);
 
-    Frost::writeVBLine(mapFile, base.description[GameCharacterDescriptions::Icon]);
-    Frost::writeVBLine(mapFile, base.description[GameCharacterDescriptions::Sound]);
+    Frost::writeVBLine(mapBuffer, base.description[GameCharacterDescriptions::Icon].getText(scratch));
+    Frost::writeVBLine(mapBuffer, base.description[GameCharacterDescriptions::Sound].getText(scratch));
 
 }
@@ -4,11 +4,15 @@
 #include <string>
 #include <fstream>
 #include <assert.h>
+#include "../util/frost.h"
 #include "../compat/std_extras_compat.h"
 #include "../compat/stdint_compat.h"
+#include "lazystring.h"
 #include "../editor_constants.h"
 #include "../adventuregamer_constants.h"
 
+class WorldFileReader;
+
 //-----------------------------------------------------------------------------
 // GameCharacterConstants - Exactly what it says
 //-----------------------------------------------------------------------------
@@ -74,7 +78,7 @@ class GameCharacter {
 
         struct Base {
             int             attribute[AttributeTypes::NumTypesForCharacters];
-            std::string     description[GameCharacterDescriptions::NumAllDescriptions];
+            LazyString      description[GameCharacterDescriptions::NumAllDescriptions];
             uint8_t         flags;
             int             ID;
             std::string     location;
@@ -193,7 +197,7 @@ class GameCharacter {
 
                     #ifdef _DEBUG
                         if(unused != 0) {
-                            std::string info = "Character " + base.description[0] + " has the unused value set!";
+                            std::string info = "Character " + base.description[0].get() + " has the unused value set!";
                             MessageBoxA(NULL, info.c_str(), "Unused value found!", MB_OK | MB_ICONEXCLAMATION);
                         }
                     #endif
@@ -202,7 +206,7 @@ class GameCharacter {
                     return *this;
                 }
 
-                void readCharacter(std::ifstream& mapFile);
+                void readCharacter(WorldFileReader& reader);
 
                 GameCharacter build() {
                     // TOOD: Any additional error checking that must occur, we may also
@@ -248,7 +252,7 @@ class GameCharacter {
 
     public:
 
-        const std::string& getDescription(const int& which) const { return base.description[which]; }
+        const std::string& getDescription(const int& which) const { return base.description[which].get(); }
         const uint8_t& getFlags() const { return base.flags; }
         const int& getType() const { return base.type; }
         const int& getID() const { return base.ID; }
@@ -258,12 +262,15 @@ class GameCharacter {
         const int& getX() const { return base.x; }
         const int& getY() const { return base.y; }
 
-        const std::string& getName() const { return base.description[0]; }
+        const std::string& getName() const { return base.description[0].get(); }
 
-        void writeCharacter(std::ofstream& mapFile) const;
+        void writeCharacter(std::string& mapBuffer) const;
 
     private:
 
+        // Written and read directly by the world cache.
+        friend class GameMapCache;
+
         GameCharacter(Builder& builder) {
 
             for(int i = 0; i < AttributeTypes::NumTypesForCharacters ; i++) {
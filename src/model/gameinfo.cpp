@@ -1,6 +1,7 @@
 #include "gameinfo.h"
 #include "../compat/std_extras_compat.h"
 #include "../util/frost.h"
+#include "worldfile_reader.h"
 #include <sstream>
 #include <stdexcept>
 
@@ -20,103 +21,61 @@ GameInfo::GameInfo() : gameName("Untitled Game"), saveName("Master"), isSaveFile
 }
 
 ///----------------------------------------------------------------------------
-/// readHeader - Reads the header of map file.
-/// @param mapFile an ifstream of the file to be read from.
+/// readHeader - Reads the header of map file from a buffer.
+/// @param reader positioned at the start of the file.
 /// @throws std::runtime_error if the saveName isn't "Master".
-/// TODO: Save game editing?
 ///----------------------------------------------------------------------------
 
-void GameInfo::readHeader(std::ifstream& mapFile) {
+void GameInfo::readHeader(WorldFileReader& reader) {
 
-    Frost::getLineWindows(mapFile, gameName);
-    Frost::getLineWindows(mapFile, saveName);
-
-    // TODO: If the World doesn't load and this exception runs, it leaks memory.
-    // This is a good place to test that!
-    // TODO: Master needs to be defined somewhere.
+    reader.readLine(gameName);
+    reader.readLine(saveName);
 
     if(saveName.compare("Master")) {
         throw std::runtime_error("File is not an Adventure Gamer World File.");
-        isSaveFile = true; // Maybe in the future we can add this into the editor.
     }
 
-    Frost::getLineWindows(mapFile, currencyName);
+    reader.readLine(currencyName);
 
 }
 
 ///----------------------------------------------------------------------------
-/// readAttributes - Reads the player's attributes from the file.
-/// @param mapFile an ifstream of the file to be read from.
+/// readAttributes - Reads the player's attributes from a buffer.
+/// @param reader positioned at the "{attrb" section.
 /// @throws std::runtime_error if any of the numbers read are invalid.
 ///----------------------------------------------------------------------------
 
-void GameInfo::readPlayerAttributes(std::ifstream& mapFile) {
-    
-    std::string line;
-    std::string errorMsg = "Error reading attributes: ";
+void GameInfo::readPlayerAttributes(WorldFileReader& reader) {
 
-    // Try and read the Headings for each attribute, and their values
-    std::getline(mapFile, line);
-    line = Frost::rtrim(line, "\r");
+    std::string errorMsg = "Error reading attributes: ";
 
-    if(AdventureGamerHeadings::Attributes.compare(line)) {
-        errorMsg.append("Expected \"" + AdventureGamerHeadings::Attributes + "\", but got \"" + line + "\".");
+    if(!reader.compareLine(AdventureGamerHeadings::Attributes)) {
+        errorMsg.append("Expected \"" + AdventureGamerHeadings::Attributes + "\"" + reader.positionString() + ".");
         throw std::runtime_error(errorMsg);
     }
 
     try {
 
-        for(int i = 0; i < AttributeTypes::NumTypes; i++) {
-            
-            std::getline(mapFile, line);
+        for(unsigned int i = 0; i < AttributeTypes::NumTypes; i++) {
 
-            // TODO: Handle Energy/Stamina discrepancy
-            
-            if(!(line.compare(AdventureGamerSubHeadings::Attributes[i]))) {
-                errorMsg.append("Expected \"" + AdventureGamerSubHeadings::Attributes[i] + "\", but got \"" + line + "\".");
-                throw std::runtime_error(errorMsg);
-            }
-            
-
-            std::getline(mapFile, line);
-            baseAttributes[i]   = std::stoi(line);
-
-            std::getline(mapFile, line);
-            randomAttributes[i] = std::stoi(line);
+            // Attribute name. TODO: Handle Energy/Stamina discrepancy
+            const char* lineStart;
+            size_t lineLength;
+            reader.nextLine(lineStart, lineLength);
 
+            baseAttributes[i]   = reader.readInteger();
+            randomAttributes[i] = reader.readInteger();
         }
 
-        // Read last 4 remaining integer values
-
-        // Read the integer
-        // TODO: If save game editing is added, these values can be used.
-        
-        std::getline(mapFile, line);
-        const int newSight = std::stoi(line);
+        // Sight and Hearing only matter for save games, see above.
+        reader.readInteger();
+        reader.readInteger();
 
-        std::getline(mapFile, line);
-        const int newHearing = std::stoi(line);
+        playerStartX = reader.readInteger();
+        playerStartY = reader.readInteger();
 
-        // These have to be ignored if it's not a save file as if you start the
-        // game Blind/Ultra-Sonic, etc it will crash the game upon equipping
-        // things.
-
-        if(isSaveFile) {
-            //playerSight     = newSight;
-            //playerHearing   = newHearing;
-        }
-
-        std::getline(mapFile, line);
-        playerStartX = std::stoi(line);
-        std::getline(mapFile, line);
-        playerStartY = std::stoi(line);
-
-    }
-    catch (const std::invalid_argument& e) {
-        errorMsg.append(e.what());
-        throw std::runtime_error(errorMsg);
     }
-    catch (const std::out_of_range& e) {
+    catch (const std::runtime_error& e) {
         errorMsg.append(e.what());
         throw std::runtime_error(errorMsg);
     }
@@ -125,35 +84,35 @@ void GameInfo::readPlayerAttributes(std::ifstream& mapFile) {
 
 ///----------------------------------------------------------------------------
 /// writeAttributes - Writes the player's attributes to the file given
-/// @param mapFile an ofstream of the file being written to
+/// @param mapBuffer buffer the map file is being built in
 ///----------------------------------------------------------------------------
 
-void GameInfo::writePlayerAttributes(std::ofstream& mapFile) {
+void GameInfo::writePlayerAttributes(std::string& mapBuffer) {
     
-    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Attributes);
+    Frost::writeVBLine(mapBuffer, AdventureGamerHeadings::Attributes);
 
     for (int i = 0; i < AdventureGamerSubHeadings::NumAttributeSubHeadings; ++i) {
-        Frost::writeVBLine(mapFile, AdventureGamerSubHeadings::Attributes[i]);
-        Frost::writeVBInteger(mapFile, baseAttributes[i]);
-        Frost::writeVBInteger(mapFile, randomAttributes[i]);
+        Frost::writeVBLine(mapBuffer, AdventureGamerSubHeadings::Attributes[i]);
+        Frost::writeVBInteger(mapBuffer, baseAttributes[i]);
+        Frost::writeVBInteger(mapBuffer, randomAttributes[i]);
     }
 
-    Frost::writeVBInteger(mapFile, SightTypes::Normal().asInt());
-    Frost::writeVBInteger(mapFile, HearingTypes::Normal().asInt());
+    Frost::writeVBInteger(mapBuffer, SightTypes::Normal().asInt());
+    Frost::writeVBInteger(mapBuffer, HearingTypes::Normal().asInt());
     
-    Frost::writeVBInteger(mapFile, playerStartX);
-    Frost::writeVBInteger(mapFile, playerStartY);
+    Frost::writeVBInteger(mapBuffer, playerStartX);
+    Frost::writeVBInteger(mapBuffer, playerStartY);
 }
 
 ///----------------------------------------------------------------------------
 /// writeHeader - Writes the header of the map to the file given
-/// @param mapFile an ofstream of the file being written to
+/// @param mapBuffer buffer the map file is being built in
 ///----------------------------------------------------------------------------
 
-void GameInfo::writeHeader(std::ofstream& mapFile) {
+void GameInfo::writeHeader(std::string& mapBuffer) {
 
-    Frost::writeVBLine(mapFile, gameName);
-    Frost::writeVBLine(mapFile, saveName);
-    Frost::writeVBLine(mapFile, currencyName);
+    Frost::writeVBLine(mapBuffer, gameName);
+    Frost::writeVBLine(mapBuffer, saveName);
+    Frost::writeVBLine(mapBuffer, currencyName);
 
 }
\ No newline at end of file
@@ -42,6 +42,7 @@ namespace AdventureGamerSubHeadings {
 }
 
 class GameMap;
+class WorldFileReader;
 
 class GameInfo {
 
@@ -57,10 +58,10 @@ class GameInfo {
         };
         
 
-        inline void readHeader(Key, std::ifstream& mapFile) { readHeader(mapFile); }
-        inline void readPlayerAttributes(Key, std::ifstream& mapFile) { readPlayerAttributes(mapFile); }
-        inline void writeHeader(Key, std::ofstream& mapFile) { writeHeader(mapFile); }
-        inline void writePlayerAttributes(Key, std::ofstream& mapFile) { writePlayerAttributes(mapFile); }
+        inline void readHeader(Key, WorldFileReader& reader) { readHeader(reader); }
+        inline void readPlayerAttributes(Key, WorldFileReader& reader) { readPlayerAttributes(reader); }
+        inline void writeHeader(Key, std::string& mapBuffer) { writeHeader(mapBuffer); }
+        inline void writePlayerAttributes(Key, std::string& mapBuffer) { writePlayerAttributes(mapBuffer); }
 
         const std::string& getGameName() const { return gameName; }
         const std::string& getCurrencyName() const { return currencyName; }
@@ -95,10 +96,13 @@ class GameInfo {
 
 	private:
 
-        void readHeader(std::ifstream& mapFile);
-        void readPlayerAttributes(std::ifstream& mapFile);
-        void writePlayerAttributes(std::ofstream& mapFile);
-        void writeHeader(std::ofstream& mapFile);
+        // Written and read directly by the world cache.
+        friend class GameMapCache;
+
+        void readHeader(WorldFileReader& reader);
+        void readPlayerAttributes(WorldFileReader& reader);
+        void writePlayerAttributes(std::string& mapBuffer);
+        void writeHeader(std::string& mapBuffer);
 
 		std::string         gameName;
 		std::string         saveName; // If it isn't "Master", it's a save game
@@ -2,7 +2,89 @@
 #include "../util/frost.h"
 #include "../compat/std_extras_compat.h"
 #include "../editor_constants.h"
+#include "../util/linescanner.h"
+#include "../util/sharedbuffer.h"
+#include "../util/worldstorage.h"
+#include "worldfile_reader.h"
+#include "rowdescription_loader.h"
+#include "worldfile_index.h"
+#include "../util/workerpool.h"
 #include <algorithm>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// MapSectionRanks - Where each section comes in the map file. Rows are ranked
+// by their number, and the sections after them come after any possible row,
+// so comparing ranks tells a reader that is lost which way to look.
+//-----------------------------------------------------------------------------
+
+namespace MapSectionRanks {
+    const int Jumps         = GameMapConstants::MaxRows;
+    const int Switches      = GameMapConstants::MaxRows + 1;
+    const int Attributes    = GameMapConstants::MaxRows + 2;
+    const int Objects       = GameMapConstants::MaxRows + 3;
+    const int Characters    = GameMapConstants::MaxRows + 4;
+}
+
+//-----------------------------------------------------------------------------
+// ParallelReadConstants - When a map file is split across threads. Smaller
+// files are read faster on one thread than it takes to start the others.
+//-----------------------------------------------------------------------------
+
+namespace ParallelReadConstants {
+    const size_t        MinFileSize     = 64 * 1024;
+    const unsigned int  MaxThreads      = 8;
+    const unsigned int  ChunksPerThread = 2; // So rows of different sizes even out.
+}
+
+// 0 to use one thread per CPU, see setReadThreads.
+static unsigned int readThreads = 0;
+
+//=============================================================================
+// MapPartJob - Reads part of a map file on a worker thread.
+//=============================================================================
+
+class MapPartJob : public WorkerJob {
+
+    public:
+
+        MapPartJob(GameMap& inGameMap, const WorldFileReader& inReader, const int& inFirstRank,
+                   const int& inEndRank, RowDescriptionLoader& inRowDescriptionLoader) :
+                   gameMap(inGameMap), reader(inReader), firstRank(inFirstRank), endRank(inEndRank),
+                   rowDescriptionLoader(inRowDescriptionLoader), failed(false) {}
+
+        virtual void run();
+
+        const bool& getFailed() const { return failed; }
+
+    private:
+
+        void operator=(const MapPartJob&) {};
+
+        GameMap&                gameMap;
+        WorldFileReader         reader;
+        int                     firstRank;
+        int                     endRank;
+        RowDescriptionLoader&   rowDescriptionLoader;
+        bool                    failed;
+
+};
+
+///----------------------------------------------------------------------------
+/// run - Read the part. Any problem only marks the job as failed, as the map
+/// is read again on one thread to find out what it was.
+///----------------------------------------------------------------------------
+
+void MapPartJob::run() {
+
+    try {
+        failed = !gameMap.readPart(reader, firstRank, endRank, rowDescriptionLoader);
+    }
+    catch (const std::exception&) {
+        failed = true;
+    }
+
+}
 
 //=============================================================================
 // Constructors/Destructor
@@ -11,11 +93,14 @@
 GameMap::GameMap(const int& numRows, const int& numCols) {
 	this->numCols = numCols;
 	this->numRows = numRows;
+    lazyText = false;
 	GameTile::Builder builder;
 	GameTile gt = builder.build();
 	tiles.insert(tiles.begin(), getNumTiles(), gt);
     lastCharacterID = 0;
     lastObjectID = 0;
+    rebuildIndices();
+    markAllDirty();
 }
 
 //=============================================================================
@@ -30,7 +115,13 @@ GameMap::GameMap(const int& numRows, const int& numCols) {
 ///----------------------------------------------------------------------------
 
 const std::vector<size_t> GameMap::getCharacterInventory(const size_t& charID) const {
-    
+
+    if(charID <= static_cast<size_t>(EntityIDIndexConstants::MaxTableID) && charID > 0) {
+        return objectsHeldBy.getEntities(static_cast<int>(charID));
+    }
+
+    // IDs outside the index can still be in a world file.
+
     std::vector<size_t> objectIndices;
     objectIndices.reserve(4);
 
@@ -38,7 +129,7 @@ const std::vector<size_t> GameMap::getCharacterInventory(const size_t& charID) c
 
     for(size_t i = 0; i < goSize; ++i) {
 
-        if(gameObjects[i].getCreatureID() == charID) {
+        if(static_cast<size_t>(gameObjects[i].getCreatureID()) == charID) {
             objectIndices.push_back(i);
         }
     }
@@ -47,22 +138,13 @@ const std::vector<size_t> GameMap::getCharacterInventory(const size_t& charID) c
 }
 
 ///----------------------------------------------------------------------------
-/// getFirstUnusedObjectID - Get the first ID not used by any object
+/// getFirstUnusedObjectID - Get the first ID not used by any object. This
+/// is looked up in the ID index instead of going through the objects.
 /// @return an integer specifying the ID
 ///----------------------------------------------------------------------------
 
 const int GameMap::getFirstUnusedObjectID() const {
-
-    const size_t goSize = gameObjects.size();
-
-    for(size_t i = 0; i < goSize; ++i) {
-
-        if(gameObjects[i].getID() != static_cast<int>(i+1)) {
-            return i+1;            
-        }
-    }
-
-    return goSize+1;
+    return objectIDs.getFirstUnusedID();
 }
 
 ///----------------------------------------------------------------------------
@@ -71,17 +153,7 @@ const int GameMap::getFirstUnusedObjectID() const {
 ///----------------------------------------------------------------------------
 
 const int GameMap::getFirstUnusedCharacterID() const {
-
-    const size_t gcSize = gameCharacters.size();
-
-    for(size_t i = 0; i < gcSize; ++i) {
-
-        if(gameCharacters[i].getID() != static_cast<int>(i+1)) {
-            return i+1;            
-        }
-    }
-
-    return gcSize+1;
+    return characterIDs.getFirstUnusedID();
 }
 
 ///----------------------------------------------------------------------------
@@ -114,22 +186,13 @@ const std::vector<GameObject>& GameMap::getGameObjects() const {
 
 const std::vector<GameObject> GameMap::getGameObjectsAtRowCol(const int& row, const int& col) const {
         
-    std::vector<GameObject> objects;
-
-    if (!isRowColInMapBounds(row, col)) {
-        return objects;
-    }
-
-    const size_t numObjects = gameObjects.size();
-    
-    for (size_t i = 0; i < numObjects; ++i) {  
-        const GameObject& curObject = gameObjects[i];
+    const std::vector<size_t>& indices = getObjectIndicesAtRowCol(row, col);
 
+    std::vector<GameObject> objects;
+    objects.reserve(indices.size());
 
-        if (curObject.getIsLocated() == GameObjectConstants::LocatedOnGround &&
-           (curObject.getX() == col && curObject.getY() == row)) {
-            objects.push_back(curObject);
-        }
+    for (size_t i = 0; i < indices.size(); ++i) {
+        objects.push_back(gameObjects[indices[i]]);
     }
 
     return objects;
@@ -146,23 +209,44 @@ const std::vector<GameObject> GameMap::getGameObjectsAtRowCol(const int& row, co
 
 const std::vector<GameCharacter> GameMap::getGameCharactersAtRowCol(const int& row, const int& col) const {
 
+    const std::vector<size_t>& indices = getCharacterIndicesAtRowCol(row, col);
+
     std::vector<GameCharacter> chars;
+    chars.reserve(indices.size());
 
-    if (!isRowColInMapBounds(row, col)) {
-        return chars;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        chars.push_back(gameCharacters[indices[i]]);
     }
-    const size_t numChars = gameCharacters.size();
 
-    for (size_t i = 0; i < numChars; ++i) {
-        const GameCharacter& curChar = gameCharacters[i];
+    return chars;
 
-        if(curChar.getX() == col && curChar.getY() == row) {
-            chars.push_back(curChar);
-        }
-    }
+}
 
-    return chars;
+///----------------------------------------------------------------------------
+/// getObjectIndicesAtRowCol - Get the objects on the ground at the given row
+/// and column, without copying them.
+/// @param an integer indicating the row to search for
+/// @param an integer indicating the column to search for
+/// @return the indices of the objects in getGameObjects, in ascending order.
+/// It stays valid until the objects or the size of the map are changed.
+///----------------------------------------------------------------------------
+
+const std::vector<size_t>& GameMap::getObjectIndicesAtRowCol(const int& row, const int& col) const {
+    return objectsOnTiles.getEntities(getEntityTile(row, col));
+}
+
+///----------------------------------------------------------------------------
+/// getCharacterIndicesAtRowCol - Get the characters at the given row and
+/// column, without copying them.
+/// @param an integer indicating the row to search for
+/// @param an integer indicating the column to search for
+/// @return the indices of the characters in getGameCharacters, in ascending
+/// order. It stays valid until the characters or the size of the map are
+/// changed.
+///----------------------------------------------------------------------------
 
+const std::vector<size_t>& GameMap::getCharacterIndicesAtRowCol(const int& row, const int& col) const {
+    return charactersOnTiles.getEntities(getEntityTile(row, col));
 }
 
 ///----------------------------------------------------------------------------
@@ -200,7 +284,11 @@ const int& GameMap::getLastObjectID() const {
 ///----------------------------------------------------------------------------
 
 const std::vector<size_t> GameMap::getReliantObjectsFromID(const size_t& objectID) const {
-    
+
+    if(objectID <= static_cast<size_t>(EntityIDIndexConstants::MaxTableID) && objectID > 0) {
+        return objectsUsedWith.getEntities(static_cast<int>(objectID));
+    }
+
     std::vector<size_t> objectIndices;
     objectIndices.reserve(4);
 
@@ -208,7 +296,40 @@ const std::vector<size_t> GameMap::getReliantObjectsFromID(const size_t& objectI
 
     for(size_t i = 0; i < goSize; ++i) {
 
-        if(gameObjects[i].getUsedWithID() == objectID) {
+        if(static_cast<size_t>(gameObjects[i].getUsedWithID()) == objectID) {
+            objectIndices.push_back(i);
+        }
+    }
+
+    return objectIndices;
+}
+
+///----------------------------------------------------------------------------
+/// getDoorKeysAtRowCol - Gets the objects that are keys to the door at the
+/// given row and column.
+/// @param row of the door
+/// @param column of the door
+/// @return a vector containing indices of the keys, in ascending order.
+///----------------------------------------------------------------------------
+
+const std::vector<size_t> GameMap::getDoorKeysAtRowCol(const int& row, const int& col) const {
+
+    const int tileIndex = getEntityTile(row, col);
+
+    if(tileIndex != EntityGroupIndexConstants::NoGroup) {
+        return doorKeysOnTiles.getEntities(tileIndex);
+    }
+
+    // A key can name a door that is not on the map.
+
+    std::vector<size_t> objectIndices;
+
+    for(size_t i = 0; i < gameObjects.size(); ++i) {
+
+        const GameObject& gameObject = gameObjects[i];
+
+        if((gameObject.getFlags2() & GameObjectFlags2::Key) &&
+           gameObject.getDoorRow() == row && gameObject.getDoorColumn() == col) {
             objectIndices.push_back(i);
         }
     }
@@ -274,16 +395,24 @@ const int& GameMap::getWidth() const {
 /// @param GameCharacter to add
 ///----------------------------------------------------------------------------
 
-void GameMap::addCharacter(GMKey, GameCharacter& gameCharacter) {
+void GameMap::addCharacter(GMKey, const GameCharacter& gameCharacter) {
+
+    const int tileIndex = getEntityTile(gameCharacter.getY(), gameCharacter.getX());
 
     if(gameCharacter.getID() < static_cast<int>(gameCharacters.size())) {
         gameCharacters.insert(gameCharacters.begin()+gameCharacter.getID() - 1,
                              1, gameCharacter);
+        charactersOnTiles.insert(gameCharacter.getID() - 1, tileIndex);
+        characterIDs.insert(gameCharacter.getID() - 1, gameCharacter.getID());
     }
     else {
         gameCharacters.push_back(gameCharacter);
+        charactersOnTiles.insert(gameCharacters.size() - 1, tileIndex);
+        characterIDs.insert(gameCharacters.size() - 1, gameCharacter.getID());
     }
 
+    markSectionDirty(GameMapSections::Characters);
+
 }
 
 ///----------------------------------------------------------------------------
@@ -295,7 +424,8 @@ void GameMap::addCharacter(GMKey, GameCharacter& gameCharacter) {
 
 void GameMap::addJump(GMKey, SimplePoint& firstJump, SimplePoint& secondJump) {
     ConnectionPoint newJump = ConnectionPoint(firstJump, secondJump);
-    jumpPoints.push_back(newJump);
+    addConnection(jumpPoints, jumpIndex, newJump);
+    markSectionDirty(GameMapSections::Jumps);
 }
 
 ///----------------------------------------------------------------------------
@@ -307,7 +437,9 @@ void GameMap::addJump(GMKey, SimplePoint& firstJump, SimplePoint& secondJump) {
 
 void GameMap::addSwitch(GMKey, SimplePoint& firstConnection, SimplePoint& secondConnection) {
     ConnectionPoint newSwitch = ConnectionPoint(firstConnection, secondConnection);
-    switchConnections.push_back(newSwitch);
+    addConnection(switchConnections, switchIndex, newSwitch);
+    updateSwitchStates(firstConnection, secondConnection);
+    markSectionDirty(GameMapSections::Switches);
 }
 
 ///----------------------------------------------------------------------------
@@ -316,15 +448,19 @@ void GameMap::addSwitch(GMKey, SimplePoint& firstConnection, SimplePoint& second
 /// @param GameObject to add
 ///----------------------------------------------------------------------------
 
-void GameMap::addObject(GMKey, GameObject& gameObject) {
+void GameMap::addObject(GMKey, const GameObject& gameObject) {
 
     if(gameObject.getID() < static_cast<int>(gameObjects.size())) {
         gameObjects.insert(gameObjects.begin()+gameObject.getID() - 1, 1,
                            gameObject); 
+        indexObject(gameObject.getID() - 1, gameObject);
     }
     else {
         gameObjects.push_back(gameObject);
+        indexObject(gameObjects.size() - 1, gameObject);
     }
+
+    markSectionDirty(GameMapSections::Objects);
 }
 
 ///----------------------------------------------------------------------------
@@ -335,6 +471,9 @@ void GameMap::addObject(GMKey, GameObject& gameObject) {
 
 void GameMap::deleteCharacter(GMKey, const size_t& index) {   
     gameCharacters.erase(gameCharacters.begin() + index);
+    charactersOnTiles.erase(index);
+    characterIDs.erase(index);
+    markSectionDirty(GameMapSections::Characters);
 }
 
 ///----------------------------------------------------------------------------
@@ -345,6 +484,12 @@ void GameMap::deleteCharacter(GMKey, const size_t& index) {
 
 void GameMap::deleteObject(GMKey, const size_t& index) {
     gameObjects.erase(gameObjects.begin() + index);
+    objectsOnTiles.erase(index);
+    objectIDs.erase(index);
+    objectsUsedWith.erase(index);
+    objectsHeldBy.erase(index);
+    doorKeysOnTiles.erase(index);
+    markSectionDirty(GameMapSections::Objects);
 }
 
 ///----------------------------------------------------------------------------
@@ -356,6 +501,9 @@ void GameMap::deleteObject(GMKey, const size_t& index) {
 
 void GameMap::replaceCharacter(GMKey, const size_t& index, const GameCharacter& gameChar) {
     gameCharacters[index] = gameChar;
+    charactersOnTiles.move(index, getEntityTile(gameChar.getY(), gameChar.getX()));
+    characterIDs.change(index, gameChar.getID());
+    markSectionDirty(GameMapSections::Characters);
 }
 
 ///----------------------------------------------------------------------------
@@ -367,6 +515,12 @@ void GameMap::replaceCharacter(GMKey, const size_t& index, const GameCharacter&
 
 void GameMap::replaceObject(GMKey, const size_t& index, const GameObject& gameObject) {
     gameObjects[index] = gameObject;
+    objectsOnTiles.move(index, getObjectTile(gameObject));
+    objectIDs.change(index, gameObject.getID());
+    objectsUsedWith.move(index, getReferenceGroup(gameObject.getUsedWithID()));
+    objectsHeldBy.move(index, getReferenceGroup(gameObject.getCreatureID()));
+    doorKeysOnTiles.move(index, getDoorKeyTile(gameObject));
+    markSectionDirty(GameMapSections::Objects);
 }
 
 ///----------------------------------------------------------------------------
@@ -377,6 +531,7 @@ void GameMap::replaceObject(GMKey, const size_t& index, const GameObject& gameOb
 
 void GameMap::setStory(GMKey, const std::string& inStory) {
     story = inStory;
+    markSectionDirty(GameMapSections::Story);
 }
 
 ///----------------------------------------------------------------------------
@@ -387,6 +542,7 @@ void GameMap::setStory(GMKey, const std::string& inStory) {
 
 void GameMap::setSummary(GMKey, const std::string& inSummary) {
     summary = inSummary;
+    markSectionDirty(GameMapSections::Story);
 }
 
 ///----------------------------------------------------------------------------
@@ -398,6 +554,7 @@ void GameMap::setSummary(GMKey, const std::string& inSummary) {
 void GameMap::setPlayerCoordinates(const int& playerRow, const int& playerCol) {
     gameInfo.setPlayerX(playerCol);
     gameInfo.setPlayerY(playerRow);
+    markSectionDirty(GameMapSections::Info);
 }
 
 ///----------------------------------------------------------------------------
@@ -427,6 +584,7 @@ void GameMap::updateTileDescription(GMKey, const size_t& index,
     bd.description(tileDescription);
 
     tiles[index] = bd.build();
+    markRowDirty(index);
    
 }
 
@@ -438,6 +596,7 @@ void GameMap::updateTileDescription(GMKey, const size_t& index,
 
 void GameMap::updateGameInfo(GMKey, const GameInfo& newInfo) {    
     gameInfo = newInfo;
+    markSectionDirty(GameMapSections::Info);
 }
 
 //=============================================================================
@@ -446,7 +605,7 @@ void GameMap::updateGameInfo(GMKey, const GameInfo& newInfo) {
 
 const bool GameMap::isConnectedToOnSwitch(const int& row, const int& col) const {
 
-    const SimplePoint* switchPoint = findMatchingPoint(row, col, switchConnections);
+    const SimplePoint* switchPoint = findMatchingPoint(row, col, switchConnections, switchIndex);
 
     if(!switchPoint) {
         return false;
@@ -460,54 +619,50 @@ const bool GameMap::isConnectedToOnSwitch(const int& row, const int& col) const
 
 }
 
+///----------------------------------------------------------------------------
+/// isRowDirty - Check if a row's description file needs to be written on the
+/// next save.
+/// @param row to check
+/// @return true if any tile on the row changed, or the map has not been saved
+/// to its current location yet.
+///----------------------------------------------------------------------------
+
+bool GameMap::isRowDirty(const int& row) const {
+
+    if(savedBasePath.empty() || row < 0 || row >= static_cast<int>(dirtyRows.size())) {
+        return true;
+    }
+
+    return dirtyRows[row];
+
+}
+
 //=============================================================================
 // Public Functions
 //=============================================================================
 
 ///----------------------------------------------------------------------------
-/// characterIndexFromID - Search for a character via it's ID, then return
-/// its index in the gameCharacter vector if it is found.
+/// characterIndexFromID - Look up a character by its ID in the ID index, and
+/// return its index in the gameCharacter vector if it is found.
 /// @param character ID to search for.
 /// @return the index in the game character vector of the character if found,
 /// (size_t)-1 if it was not.
 ///----------------------------------------------------------------------------
 
 const size_t GameMap::characterIndexFromID(const int& charID) const {
-
-    const size_t gcSize = gameCharacters.size();
-
-    for(size_t i = 0; i < gcSize; ++i) {
-        
-        if(gameCharacters[i].getID() == charID) {
-            return i;
-        }
-    }
-
-    return (size_t)-1;
-
+    return characterIDs.find(charID);
 }
 
 ///----------------------------------------------------------------------------
-/// objectIndexFromID - Search for an object via it's ID, then return its index
-/// in the gameCharacter vector if it is found.
+/// objectIndexFromID - Look up an object by its ID in the ID index, and
+/// return its index in the gameObject vector if it is found.
 /// @param object ID to search for.
 /// @return the index in the game object vector of the object if found,
 /// (size_t)-1 if it was not.
 ///----------------------------------------------------------------------------
 
 const size_t GameMap::objectIndexFromID(const int& objectID) const {
-
-    const size_t goSize = gameObjects.size();
-
-    for(size_t i = 0; i < goSize; ++i) {
-        
-        if(gameObjects[i].getID() == objectID) {
-            return i;
-        }
-    }
-
-    return (size_t)-1;
-
+    return objectIDs.find(objectID);
 }
 
 ///----------------------------------------------------------------------------
@@ -620,7 +775,7 @@ bool GameMap::isIndexInMapBounds(const int& index) const {
 ///----------------------------------------------------------------------------
 
 const SimplePoint* GameMap::findSwitchPoint(const int& row, const int& col) const {
-    return findMatchingPoint(row, col, switchConnections);
+    return findMatchingPoint(row, col, switchConnections, switchIndex);
 }
 
 ///----------------------------------------------------------------------------
@@ -628,102 +783,223 @@ const SimplePoint* GameMap::findSwitchPoint(const int& row, const int& col) cons
 ///----------------------------------------------------------------------------
 
 const SimplePoint* GameMap::findJumpPoint(const int& row, const int& col) const {
-    return findMatchingPoint(row, col, jumpPoints);
+    return findMatchingPoint(row, col, jumpPoints, jumpIndex);
 }
 
 ///----------------------------------------------------------------------------
-/// readMap - Reads the SG0 and TXX file of the map name given, and then uses
-/// it to construct the game map.
-/// @param an ifstream of the map file
+/// scanMap - Reads only the layout of a world from its SG0 file: the size,
+/// each tile's sprite and flags, and the jumps and switches. Tile names are
+/// skipped without being copied, and the STY and TXX files are never opened,
+/// so a large number of worlds can be scanned quickly.
 /// @param a string to the path where the map file is located
 /// @param a string indicating the file's name
-/// @throws runtime_error
+/// @param (out) scan to fill in. Its vectors are reused.
+/// @throws runtime_error if the layout could not be read.
 ///----------------------------------------------------------------------------
 
-void GameMap::readMap(std::ifstream& mapFile, const std::string& filePath,
-                      const std::string& fileName) {
+void GameMap::scanMap(const std::string& filePath, const std::string& fileName, GameMapScan& outScan) {
+    scanMap(FileWorldStorage(filePath), fileName, outScan);
+}
 
-    lastCharacterID = 0;
-    lastObjectID = 0;
+///----------------------------------------------------------------------------
+/// scanMap - Same as above, but reads the SG0 file from a storage.
+/// @param storage the world is in
+/// @param a string indicating the file's name
+/// @param (out) scan to fill in. Its vectors are reused.
+/// @throws runtime_error if the layout could not be read.
+///----------------------------------------------------------------------------
+
+void GameMap::scanMap(const WorldStorage& storage, const std::string& fileName, GameMapScan& outScan) {
 
-    const std::string storyFilePath = filePath + fileName.substr(0, fileName.length() - 4) + ".STY";
+    StoragePart mapFile;
 
-    readStory(storyFilePath);
+    if(!storage.openPart(fileName, mapFile)) {
+        throw std::runtime_error("Could not open " + fileName + " for reading.");
+    }
 
-    // TODO: Throwing an error right now causes the object to be in an undefined state.
-    // We also need to do some better error checking.
-    // TODO: Verify correct extensions.
+    WorldFileReader reader(mapFile.getData(), mapFile.getSize());
 
-    gameInfo.readHeader(key, mapFile);
+    // The map does the reading, using the scan's vectors for the connections
+    // so their memory is kept between scans.
 
-    std::string line;
+    GameMap gameMap;
+    gameMap.jumpPoints.swap(outScan.jumpPoints);
+    gameMap.switchConnections.swap(outScan.switchConnections);
+    gameMap.jumpPoints.clear();
+    gameMap.switchConnections.clear();
 
-    // Whatever the value read is, it is always one more than it says.
+    outScan.numCols = 0;
+    outScan.numRows = 0;
+    outScan.sprites.clear();
+    outScan.flags.clear();
 
     try {
 
-        std::getline(mapFile, line);
-        numCols = std::stoi(line) + 1;
+        gameMap.gameInfo.readHeader(gameMap.key, reader);
+        gameMap.readDimensions(reader);
 
-        std::getline(mapFile, line);
-        numRows = std::stoi(line) + 1;
+        const size_t numTiles = static_cast<size_t>(gameMap.numRows * gameMap.numCols);
+        outScan.sprites.resize(numTiles);
+        outScan.flags.resize(numTiles);
+
+        // The switches are checked against the tiles they are on, so the
+        // tiles are still built, just without any of their text.
+
+        gameMap.tiles.reserve(numTiles);
+
+        for(int row = 0; row < gameMap.numRows; ++row) {
+
+            const std::string rowID = AdventureGamerHeadings::Row + std::to_string(row);
+
+            if(!reader.compareLine(rowID)) {
+                throw std::runtime_error("Row identifier not found. Expected \"" + rowID + "\"" +
+                                         reader.positionString() + ".");
+            }
+
+            for(int col = 0; col < gameMap.numCols; ++col) {
+
+                // Same as GameTile::Builder::readTile, which only has a name
+                // if the sprite is set.
+
+                const uint8_t sprite = static_cast<uint8_t>(reader.readInteger());
+                const uint8_t flags = static_cast<uint8_t>(reader.readInteger());
+
+                if(sprite != 0) {
+                    const char* lineStart;
+                    size_t lineLength;
+                    reader.nextLine(lineStart, lineLength);
+                }
+
+                outScan.sprites[gameMap.tiles.size()] = sprite;
+                outScan.flags[gameMap.tiles.size()] = flags;
+
+                GameTile::Builder tileBuilder;
+                gameMap.tiles.push_back(tileBuilder.sprite(sprite).flags(flags).build());
+            }
+
+        }
+
+        const DiagnosticLog log(NULL, fileName);
+        bool recovering = false;
+
+        gameMap.readSection(reader, MapSectionRanks::Jumps, log, recovering);
+        gameMap.readSection(reader, MapSectionRanks::Switches, log, recovering);
 
     }
-    catch (const std::invalid_argument& e) {
-        throw std::runtime_error(e.what());
-    }
-    catch (const std::out_of_range& e) {
-        throw std::runtime_error(e.what());
+    catch (const std::exception&) {
+        gameMap.jumpPoints.swap(outScan.jumpPoints);
+        gameMap.switchConnections.swap(outScan.switchConnections);
+        throw;
     }
 
-    tiles.reserve((numCols * numRows));
+    outScan.numCols = gameMap.numCols;
+    outScan.numRows = gameMap.numRows;
+    gameMap.jumpPoints.swap(outScan.jumpPoints);
+    gameMap.switchConnections.swap(outScan.switchConnections);
 
-    for (int row = 0; row < numRows; ++row) {
+}
 
-        const std::string rowID = AdventureGamerHeadings::Row + std::to_string(row);
+///----------------------------------------------------------------------------
+/// setReadThreads - Sets how many threads readMap can use for a large map.
+/// This is not thread safe, and is meant for comparing the two ways of
+/// reading a map.
+/// @param number of threads, 0 to use one per CPU (the default), or 1 to
+/// always read on the calling thread.
+///----------------------------------------------------------------------------
 
-        Frost::getLineWindows(mapFile, line);
+void GameMap::setReadThreads(const unsigned int& numThreads) {
+    readThreads = numThreads;
+}
 
-        // This is only true if they're not equal.
-        if (rowID.compare(line)) {
-            throw std::runtime_error("Row identifier not found. Expected \"" + rowID + "\", but got \"" + line + "\".");
-        }
+///----------------------------------------------------------------------------
+/// setLazyText - Sets if readMap should leave the names and descriptions of
+/// tiles, objects and characters undecoded until they are first asked for.
+/// The map then keeps a copy of its files in memory until every string in it
+/// has been read or replaced, but opening it only costs what it takes to
+/// read the numbers.
+/// @param true to decode text lazily, false to decode it as it is read.
+///----------------------------------------------------------------------------
 
-        std::string rowFilePath = filePath + fileName.substr(0, fileName.length() - 4) + ".T";
+void GameMap::setLazyText(const bool& inLazyText) {
+    lazyText = inLazyText;
+}
 
-        if (row < 10) {
-            rowFilePath += "0";
-        }
+///----------------------------------------------------------------------------
+/// getLazyText - See setLazyText.
+///----------------------------------------------------------------------------
 
-        rowFilePath += std::to_string(row);
+const bool& GameMap::getLazyText() const {
+    return lazyText;
+}
 
-        const std::map<unsigned int, std::string> rowDescriptions = readRowDescriptions(rowFilePath);
+///----------------------------------------------------------------------------
+/// readMap - Reads the SG0 and TXX files of the map name given by mapping
+/// them into memory and parsing them in place. This is much faster than
+/// reading them through a stream, as only the names and descriptions need
+/// to be allocated. The TXX files are all read up front, in parallel.
+/// @param a string to the path where the map file is located
+/// @param a string indicating the file's name
+/// @throws runtime_error
+///----------------------------------------------------------------------------
 
-        for (int col = 0; col < numCols; ++col) {
+void GameMap::readMap(const std::string& filePath, const std::string& fileName) {
+    readMapFiles(FileWorldStorage(filePath), fileName, DiagnosticLog(NULL, fileName));
+}
 
-            // Before we can read a tile, we'll need to get the description for it,
-            // if one exists.
+///----------------------------------------------------------------------------
+/// readMap - Same as above, but instead of stopping at the first problem,
+/// every problem found is added to the diagnostics and the reader carries on
+/// from the next row or section heading it can find. Whatever could be read
+/// is kept, so the map can still be looked at and fixed. Rows that could not
+/// be read are filled with empty tiles.
+/// @param a string to the path where the map file is located
+/// @param a string indicating the file's name
+/// @param (out) vector to add any problems found to
+/// @return true if the map was read without any problems, false if not. If
+/// there were problems, the whole map is marked as changed so saving it
+/// writes a clean copy of every file.
+///----------------------------------------------------------------------------
 
-            std::string tileDescription;
-            std::map<unsigned int, std::string>::const_iterator it;
-            it = rowDescriptions.find(col);
+bool GameMap::readMap(const std::string& filePath, const std::string& fileName,
+                      std::vector<WorldDiagnostic>& outDiagnostics) {
+    return readMap(FileWorldStorage(filePath), fileName, outDiagnostics);
+}
 
-            if (it != rowDescriptions.end()) {
-                tileDescription = it->second;
-            }
+///----------------------------------------------------------------------------
+/// readMap - Same as the path version, but reads the files from a storage,
+/// which may not be on disk at all.
+/// @param storage the world is in
+/// @param a string indicating the file's name
+/// @throws runtime_error
+///----------------------------------------------------------------------------
 
-            GameTile::Builder tileBuilder;
-            tileBuilder.readTile(mapFile, tileDescription);
-            tiles.push_back(tileBuilder.build());
-        }
+void GameMap::readMap(const WorldStorage& storage, const std::string& fileName) {
+    readMapFiles(storage, fileName, DiagnosticLog(NULL, fileName));
+}
 
+///----------------------------------------------------------------------------
+/// readMap - Same as the diagnostic path version, but reads the files from a
+/// storage.
+/// @param storage the world is in
+/// @param a string indicating the file's name
+/// @param (out) vector to add any problems found to
+/// @return true if the map was read without any problems, false if not.
+///----------------------------------------------------------------------------
+
+bool GameMap::readMap(const WorldStorage& storage, const std::string& fileName,
+                      std::vector<WorldDiagnostic>& outDiagnostics) {
+
+    const size_t numDiagnostics = outDiagnostics.size();
+
+    readMapFiles(storage, fileName, DiagnosticLog(&outDiagnostics, fileName));
+
+    if(outDiagnostics.size() != numDiagnostics) {
+        markAllDirty();
+        return false;
     }
 
-    readJumps(mapFile);
-    readSwitches(mapFile);
-    gameInfo.readPlayerAttributes(key, mapFile);
-    readObjects(mapFile);
-    readCharacters(mapFile);
+    return true;
+
 }
 
 ///----------------------------------------------------------------------------
@@ -735,14 +1011,9 @@ void GameMap::readMap(std::ifstream& mapFile, const std::string& filePath,
 
 bool GameMap::removeJumpPoint(const SimplePoint& point1, const SimplePoint& point2) {
 
-    const size_t jmpSize = jumpPoints.size();
-    const ConnectionPoint conPoint(point1, point2);
-
-    for (size_t i = 0; i < jmpSize; ++i) {
-        if (jumpPoints[i] == conPoint) {
-            jumpPoints.erase(jumpPoints.begin() + i);
-            return true;
-        }
+    if (removeConnection(jumpPoints, jumpIndex, ConnectionPoint(point1, point2))) {
+        markSectionDirty(GameMapSections::Jumps);
+        return true;
     }
     
     return false;
@@ -757,14 +1028,10 @@ bool GameMap::removeJumpPoint(const SimplePoint& point1, const SimplePoint& poin
 
 bool GameMap::removeSwitch(const SimplePoint& point1, const SimplePoint& point2) {
 
-    const size_t switchSize = switchConnections.size();
-    const ConnectionPoint conPoint(point1, point2);
-
-    for (size_t i = 0; i < switchSize; ++i) {
-        if (switchConnections[i] == conPoint) {
-            switchConnections.erase(switchConnections.begin() + i);
-            return true;
-        }
+    if (removeConnection(switchConnections, switchIndex, ConnectionPoint(point1, point2))) {
+        updateSwitchStates(point1, point2);
+        markSectionDirty(GameMapSections::Switches);
+        return true;
     }
 
     return false;
@@ -790,77 +1057,140 @@ bool GameMap::updateTileFlags(GMKey, const int& row, const int& col, const uint8
     tb.flags(newFlags);
 
     tiles[index] = tb.build();
+    markRowDirty(index);
+    updateTileStates(index, NULL);
 
     return true;
 
 }
 
 ///----------------------------------------------------------------------------
-/// writeMap - Writes the SG0 and TXX files of the map given.
-/// @param an ofstream of the map file
+/// writeMap - Writes the SG0 and TXX files of the map given. If the map was
+/// last read from or written to the same place, only the TXX files of rows
+/// that changed are written, and the STY file only if the story changed.
+/// The files are written as one transaction, so if saving fails, the world
+/// on disk is left as it was.
 /// @param a string to the path where the map file is located
 /// @param a string indicating the file's name
-/// @throws runtime_error
+/// @throws runtime_error if the files could not be written
 ///----------------------------------------------------------------------------
 
-void GameMap::writeMap(std::ofstream& mapFile, const std::string& filePath,
-                       const std::string& fileName) {
+void GameMap::writeMap(const std::string& filePath, const std::string& fileName) {
+    FileWorldStorage storage(filePath);
+    writeMap(storage, fileName);
+}
 
-    const std::string storyFilePath = filePath + fileName.substr(0, fileName.length() - 4) + ".STY";
-    writeStory(storyFilePath);
-    
-    gameInfo.writeHeader(key, mapFile);
-    Frost::writeVBInteger(mapFile, numCols - 1);
-    Frost::writeVBInteger(mapFile, numRows - 1);
+///----------------------------------------------------------------------------
+/// writeMap - Same as above, but writes the files to a storage. The parts
+/// are staged in the storage and committed together.
+/// @param storage to write the world to
+/// @param a string indicating the file's name
+/// @throws runtime_error if the files could not be written
+///----------------------------------------------------------------------------
+
+void GameMap::writeMap(WorldStorage& storage, const std::string& fileName) {
+
+    const std::string baseName = fileName.substr(0, fileName.length() - 4);
+    const std::string basePath = storage.getPartPath(baseName);
+
+    // Saving somewhere new means none of the files there are up to date.
+
+    if (basePath != savedBasePath) {
+        markAllDirty();
+    }
+
+    // Every file is built in memory and staged in the storage, which only
+    // replaces them once all of them have been written.
+
+    try {
+        writeParts(storage, baseName, fileName);
+        storage.commitParts();
+    }
+    catch (...) {
+        storage.discardParts();
+        throw;
+    }
+
+    clearDirty(basePath);
+
+}
+
+///----------------------------------------------------------------------------
+/// writeParts - Stages every file of the map that needs to be written. See
+/// writeMap.
+/// @param storage to stage the files in
+/// @param name of the map file, without its extension
+/// @param name of the map file
+///----------------------------------------------------------------------------
+
+void GameMap::writeParts(WorldStorage& storage, const std::string& baseName, const std::string& fileName) {
+
+    if (isSectionDirty(GameMapSections::Story)) {
+        writeStory(storage.addPart(baseName + ".STY"));
+    }
+
+    std::string& mapBuffer = storage.addPart(fileName);
+    mapBuffer.reserve(estimateMapFileSize());
+
+    gameInfo.writeHeader(key, mapBuffer);
+    Frost::writeVBInteger(mapBuffer, numCols - 1);
+    Frost::writeVBInteger(mapBuffer, numRows - 1);
+
+    std::string rowFileName = baseName + ".T00";
+    const size_t rowDigitPos = rowFileName.length() - 2;
+    std::string descriptionScratch;
 
     for (int row = 0; row < numRows; ++row) {
 
         const std::string rowID = AdventureGamerHeadings::Row + std::to_string(row);
-        Frost::writeVBLine(mapFile, rowID);
+        Frost::writeVBLine(mapBuffer, rowID);
 
-        std::string rowFilePath = filePath + fileName.substr(0, fileName.length() - 4) + ".T";
+        const size_t rowStart = indexFromRowCol(row, 0);
 
-        if (row < 10) {
-            rowFilePath += "0";
+        for (int col = 0; col < numCols; ++col) {
+            tiles[rowStart + col].write(mapBuffer);
         }
 
-        rowFilePath += std::to_string(row);
-        std::map<int, std::string> rowDescriptions;
+        // Only rewrite the row's descriptions if something on it changed,
+        // so the descriptions of other rows are not even looked at.
 
-        for (int col = 0; col < numCols; ++col) {
+        if (!isRowDirty(row)) {
+            continue;
+        }
+
+        int numDescriptions = 0;
 
-            size_t currentTile = indexFromRowCol(row, col);
-            
-            if (!tiles[currentTile].getDescription().empty()) {
-                rowDescriptions[col] = tiles[currentTile].getDescription();
+        for (int col = 0; col < numCols; ++col) {
+            if (tiles[rowStart + col].hasDescription()) {
+                numDescriptions++;
             }
+        }
 
-            tiles[currentTile].write(mapFile);
+        rowFileName[rowDigitPos] = static_cast<char>('0' + (row / 10));
+        rowFileName[rowDigitPos + 1] = static_cast<char>('0' + (row % 10));
+
+        std::string& rowBuffer = storage.addPart(rowFileName);
+        Frost::writeVBInteger(rowBuffer, numDescriptions);
+
+        for (int col = 0; col < numCols && numDescriptions != 0; ++col) {
+
+            const GameTile& currentTile = tiles[rowStart + col];
+
+            if (currentTile.hasDescription()) {
+                Frost::writeVBInteger(rowBuffer, col);
+                currentTile.writeDescription(rowBuffer, descriptionScratch);
+                numDescriptions--;
+            }
 
-        }
-        #ifdef _WIN32
-            std::wstring wFullPathName = AtoW(rowFilePath.c_str(), CP_UTF8);
-            std::ofstream rowDescFile(wFullPathName.c_str(), std::ofstream::out | std::ios::binary);
-        #else 
-            std::ofstream rowDescFile(rowFilePath.c_str(), std::ofstream::out | std::ios::binary);
-        #endif
-                                                        
-
-        Frost::writeVBInteger(rowDescFile, rowDescriptions.size());
-
-        for (std::map<int, std::string>::iterator it = rowDescriptions.begin();
-                it != rowDescriptions.end(); ++it) {
-            Frost::writeVBInteger(rowDescFile, it->first);
-            Frost::writeVBString(rowDescFile, it->second);
         }
 
     }
 
-    writeJumps(mapFile);
-    writeSwitches(mapFile);
-    gameInfo.writePlayerAttributes(key, mapFile);
-    writeObjects(mapFile);
-    writeCharacters(mapFile);
+    writeJumps(mapBuffer);
+    writeSwitches(mapBuffer);
+    gameInfo.writePlayerAttributes(key, mapBuffer);
+    writeObjects(mapBuffer);
+    writeCharacters(mapBuffer);
 
 }
 
@@ -872,6 +1202,10 @@ void GameMap::writeMap(std::ofstream& mapFile, const std::string& filePath,
 
 const int GameMap::validateTileDirections() const {
 
+    if(tiles.empty()) {
+        return -1;
+    }
+
     // Check for tiles that go North
     for(int i = 0; i < numCols; ++i) {
         if(tiles[i].canEntitiesMoveNorth()) {
@@ -909,526 +1243,1356 @@ const int GameMap::validateTileDirections() const {
 //=============================================================================
 
 ///----------------------------------------------------------------------------
-/// ifConnectionExists - Checks to see if a connection exists in the specified
-/// connection vector, at the given coordinates given.
-/// @param vector containing the connection points
-/// @param ConnectionPoint to check for
-/// @return true if the connection was found, false if it was not.
+/// markRowDirty - Flag the row a tile is on as changed, so its row file is
+/// written on the next save.
+/// @param index of the tile that changed
+///----------------------------------------------------------------------------
+
+void GameMap::markRowDirty(const size_t& tileIndex) {
+
+    dirtySections |= GameMapSections::Tiles;
+
+    const size_t row = tileIndex / numCols;
+
+    if(row < dirtyRows.size()) {
+        dirtyRows[row] = true;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// markAllDirty - Flag everything as changed, so the next save writes every
+/// file.
+///----------------------------------------------------------------------------
+
+void GameMap::markAllDirty() {
+    dirtySections = GameMapSections::All;
+    dirtyRows.clear();
+    savedBasePath.clear();
+}
+
+///----------------------------------------------------------------------------
+/// clearDirty - Flag everything as unchanged, after the map has been read
+/// from, or written to the location given.
+/// @param path and file name of the map, without the extension.
+///----------------------------------------------------------------------------
+
+void GameMap::clearDirty(const std::string& basePath) {
+    dirtySections = 0;
+    dirtyRows.assign(numRows, false);
+    savedBasePath = basePath;
+}
+
+///----------------------------------------------------------------------------
+/// getEntityTile - Get the tile an entity at the given row and column is on.
+/// @param row the entity is on
+/// @param column the entity is on
+/// @return the index of the tile, or NoGroup if it is outside the map.
+///----------------------------------------------------------------------------
+
+int GameMap::getEntityTile(const int& row, const int& col) const {
+
+    if(row < 0 || col < 0 || row >= numRows || col >= numCols) {
+        return EntityGroupIndexConstants::NoGroup;
+    }
+
+    return (row * numCols) + col;
+}
+
+///----------------------------------------------------------------------------
+/// getObjectTile - Get the tile an object is on, if it is on the ground.
+/// @param object to check
+/// @return the index of the tile, or NoGroup if it is not on the map.
+///----------------------------------------------------------------------------
+
+int GameMap::getObjectTile(const GameObject& gameObject) const {
+
+    if(gameObject.getIsLocated() != GameObjectConstants::LocatedOnGround) {
+        return EntityGroupIndexConstants::NoGroup;
+    }
+
+    return getEntityTile(gameObject.getY(), gameObject.getX());
+}
+
+///----------------------------------------------------------------------------
+/// getDoorKeyTile - Get the tile of the door an object is the key to.
+/// @param object to check
+/// @return the index of the tile, or NoGroup if it is not a key or its door
+/// is not on the map.
+///----------------------------------------------------------------------------
+
+int GameMap::getDoorKeyTile(const GameObject& gameObject) const {
+
+    if(!(gameObject.getFlags2() & GameObjectFlags2::Key)) {
+        return EntityGroupIndexConstants::NoGroup;
+    }
+
+    return getEntityTile(gameObject.getDoorRow(), gameObject.getDoorColumn());
+}
+
+///----------------------------------------------------------------------------
+/// getReferenceGroup - Get the group an object is put in for the ID of the
+/// object or character it refers to.
+/// @param ID that is referred to
+/// @return the ID, or NoGroup if it is 0 or too large to be indexed. Those
+/// are found by searching every object instead.
+///----------------------------------------------------------------------------
+
+int GameMap::getReferenceGroup(const int& id) {
+
+    if(id <= 0 || id > EntityIDIndexConstants::MaxTableID) {
+        return EntityGroupIndexConstants::NoGroup;
+    }
+
+    return id;
+}
+
+///----------------------------------------------------------------------------
+/// indexObject - Adds an object that was inserted at an index to each of the
+/// object indices.
+/// @param index the object was inserted at
+/// @param the object
+///----------------------------------------------------------------------------
+
+void GameMap::indexObject(const size_t& index, const GameObject& gameObject) {
+    objectsOnTiles.insert(index, getObjectTile(gameObject));
+    objectIDs.insert(index, gameObject.getID());
+    objectsUsedWith.insert(index, getReferenceGroup(gameObject.getUsedWithID()));
+    objectsHeldBy.insert(index, getReferenceGroup(gameObject.getCreatureID()));
+    doorKeysOnTiles.insert(index, getDoorKeyTile(gameObject));
+}
+
+///----------------------------------------------------------------------------
+/// rebuildIndices - Index every object and character by the tile they are
+/// on, by their ID and by what they refer to, and every jump and switch by
+/// the tiles they connect, after they have all been read or the map has
+/// changed size.
+///----------------------------------------------------------------------------
+
+void GameMap::rebuildIndices() {
+
+    const size_t numTiles = static_cast<size_t>(numRows > 0 && numCols > 0 ? numRows * numCols : 0);
+
+    objectsOnTiles.reset(numTiles);
+    charactersOnTiles.reset(numTiles);
+    objectIDs.clear();
+    characterIDs.clear();
+    objectsUsedWith.reset(0);
+    objectsHeldBy.reset(0);
+    doorKeysOnTiles.reset(numTiles);
+
+    for(size_t i = 0; i < gameObjects.size(); ++i) {
+        indexObject(i, gameObjects[i]);
+    }
+
+    for(size_t i = 0; i < gameCharacters.size(); ++i) {
+        charactersOnTiles.insert(i, getEntityTile(gameCharacters[i].getY(), gameCharacters[i].getX()));
+        characterIDs.insert(i, gameCharacters[i].getID());
+    }
+
+    std::vector<ConnectionPoint>* connectionLists[2] = { &jumpPoints, &switchConnections };
+    ConnectionIndex* connectionIndices[2] = { &jumpIndex, &switchIndex };
+
+    for(int list = 0; list < 2; ++list) {
+
+        const std::vector<ConnectionPoint>& connections = *connectionLists[list];
+        connectionIndices[list]->reset();
+
+        for(size_t i = 0; i < connections.size(); ++i) {
+            const SimplePoint& point1 = connections[i].getConnectPoint1();
+            const SimplePoint& point2 = connections[i].getConnectPoint2();
+            connectionIndices[list]->insert(i, getEntityTile(point1.getRow(), point1.getColumn()),
+                                            getEntityTile(point2.getRow(), point2.getColumn()));
+        }
+    }
+
+    tileStates.assign(tiles.size(), 0);
+
+    for(size_t i = 0; i < tiles.size(); ++i) {
+        tileStates[i] = calculateTileState(i);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// calculateTileState - Work out the TileStateFlags of a tile from the
+/// switch it is connected to. This is what the map view used to do for each
+/// tile it drew.
+/// @param index of the tile
+/// @return the tile's TileStateFlags
+///----------------------------------------------------------------------------
+
+uint8_t GameMap::calculateTileState(const size_t& index) const {
+
+    const GameTile::DrawInfo drawInfo = tiles[index].getDrawInfo();
+
+    if(!drawInfo.dark && !drawInfo.hasGate) {
+        return 0;
+    }
+
+    bool isFirstPoint = true;
+    const size_t switchConIndex = switchIndex.findFirst(static_cast<int>(index), isFirstPoint);
+
+    if(switchConIndex == ConnectionIndexConstants::NotFound) {
+        return 0;
+    }
+
+    const ConnectionPoint& switchConnection = switchConnections[switchConIndex];
+    const SimplePoint& switchPoint = isFirstPoint ? switchConnection.getConnectPoint2() : switchConnection.getConnectPoint1();
+    const int switchTile = getEntityTile(switchPoint.getRow(), switchPoint.getColumn());
+
+    if(switchTile == EntityGroupIndexConstants::NoGroup || !tiles[switchTile].hasOnSwitch()) {
+        return 0;
+    }
+
+    return (drawInfo.dark ? TileStateFlags::Lit : 0) | (drawInfo.hasGate ? TileStateFlags::GateOpen : 0);
+
+}
+
+///----------------------------------------------------------------------------
+/// updateTileState - Work out the TileStateFlags of a tile again.
+/// @param index of the tile, or NoGroup, which is ignored
+/// @param (out) vector to add the tile to if its state changed, or NULL
+///----------------------------------------------------------------------------
+
+void GameMap::updateTileState(const int& index, std::vector<int>* outChangedStates) {
+
+    if(index < 0 || static_cast<size_t>(index) >= tileStates.size()) {
+        return;
+    }
+
+    const uint8_t newState = calculateTileState(index);
+
+    if(tileStates[index] != newState) {
+
+        tileStates[index] = newState;
+
+        if(outChangedStates) {
+            outChangedStates->push_back(index);
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// updateTileStates - Work out the TileStateFlags of a tile that changed, and
+/// of every tile connected to it by a switch, as it may be the switch.
+/// @param index of the tile that changed
+/// @param (out) vector to add each tile whose state changed to, or NULL
+///----------------------------------------------------------------------------
+
+void GameMap::updateTileStates(const size_t& index, std::vector<int>* outChangedStates) {
+
+    const int tileIndex = static_cast<int>(index);
+
+    updateTileState(tileIndex, outChangedStates);
+
+    const std::vector<size_t>& firsts = switchIndex.getWithFirstPoint(tileIndex);
+    const std::vector<size_t>& seconds = switchIndex.getWithSecondPoint(tileIndex);
+
+    for(size_t i = 0; i < firsts.size(); ++i) {
+        const SimplePoint& point = switchConnections[firsts[i]].getConnectPoint2();
+        updateTileState(getEntityTile(point.getRow(), point.getColumn()), outChangedStates);
+    }
+
+    for(size_t i = 0; i < seconds.size(); ++i) {
+        const SimplePoint& point = switchConnections[seconds[i]].getConnectPoint1();
+        updateTileState(getEntityTile(point.getRow(), point.getColumn()), outChangedStates);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// updateSwitchStates - Work out the TileStateFlags of both ends of a switch
+/// connection after it was added or removed.
+/// @param first point of the connection
+/// @param second point of the connection
+///----------------------------------------------------------------------------
+
+void GameMap::updateSwitchStates(const SimplePoint& point1, const SimplePoint& point2) {
+    updateTileState(getEntityTile(point1.getRow(), point1.getColumn()), NULL);
+    updateTileState(getEntityTile(point2.getRow(), point2.getColumn()), NULL);
+}
+
+///----------------------------------------------------------------------------
+/// ifConnectionExists - Checks to see if a connection exists in the specified
+/// connection vector, at the given coordinates given. Only the connections
+/// its first point is part of are checked.
+/// @param vector containing the connection points
+/// @param index of the connections in the vector
+/// @param ConnectionPoint to check for
+/// @return true if the connection was found, false if it was not.
 ///----------------------------------------------------------------------------
 
 const bool GameMap::ifConnectionExists(const std::vector<ConnectionPoint>& connections,
+                                       const ConnectionIndex& connectionIndex,
                                        const ConnectionPoint& connectionPoint) const {
-    
-    if(!connections.size()) {
-        return false;
+
+    const SimplePoint& point = connectionPoint.getConnectPoint1();
+    const int tileIndex = getEntityTile(point.getRow(), point.getColumn());
+
+    if(tileIndex == EntityGroupIndexConstants::NoGroup) {
+        std::vector<ConnectionPoint>::const_iterator it = find(connections.begin(), connections.end(),
+                                                               connectionPoint);
+        return !(it == connections.end());
     }
-    
-    std::vector<ConnectionPoint>::const_iterator it = find(connections.begin(), connections.end(),
-                                                           connectionPoint);
-    return !(it == connections.end());
+
+    const std::vector<size_t>& firsts = connectionIndex.getWithFirstPoint(tileIndex);
+    const std::vector<size_t>& seconds = connectionIndex.getWithSecondPoint(tileIndex);
+
+    for(size_t i = 0; i < firsts.size(); ++i) {
+        if(connections[firsts[i]] == connectionPoint) {
+            return true;
+        }
+    }
+
+    for(size_t i = 0; i < seconds.size(); ++i) {
+        if(connections[seconds[i]] == connectionPoint) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///----------------------------------------------------------------------------
+/// findMatchingPoint - Give the row and column, find the matching point if one
+/// exists.
+/// @param row of the connection point to search for
+/// @param column of the connection point to search for
+/// @param vector containing the connection points
+/// @param index of the connections in the vector
+/// @return value NULL if nothing was found, a valid connection point if it was
+///----------------------------------------------------------------------------
+const SimplePoint* GameMap::findMatchingPoint(const int& row, const int& col, const std::vector<ConnectionPoint>& connections,
+                                              const ConnectionIndex& connectionIndex) const {
+
+    const int tileIndex = getEntityTile(row, col);
+
+    if (tileIndex != EntityGroupIndexConstants::NoGroup) {
+
+        bool isFirstPoint = true;
+        const size_t conIndex = connectionIndex.findFirst(tileIndex, isFirstPoint);
+
+        if (conIndex == ConnectionIndexConstants::NotFound) {
+            return NULL;
+        }
+
+        return isFirstPoint ? &connections[conIndex].getConnectPoint2() : &connections[conIndex].getConnectPoint1();
+    }
+
+    // Only a connection read from a bad file can be off the map.
+
+    const size_t conSize = connections.size();
+
+    for (size_t i = 0; i < conSize; ++i) {
+
+        const SimplePoint& conPoint1 = connections[i].getConnectPoint1();
+        const SimplePoint& conPoint2 = connections[i].getConnectPoint2();
+
+        if (conPoint1.getColumn() == col && conPoint1.getRow() == row) {
+            return &conPoint2;
+        }
+        else if (conPoint2.getColumn() == col && conPoint2.getRow() == row) {
+            return &conPoint1;
+        }
+    }
+
+    return NULL;
+}
+
+///----------------------------------------------------------------------------
+/// addConnection - Adds a connection to the end of a connection vector.
+/// @param vector containing the connection points
+/// @param index of the connections in the vector
+/// @param ConnectionPoint to add
+///----------------------------------------------------------------------------
+
+void GameMap::addConnection(std::vector<ConnectionPoint>& connections, ConnectionIndex& connectionIndex,
+                            const ConnectionPoint& connectionPoint) {
+
+    const SimplePoint& point1 = connectionPoint.getConnectPoint1();
+    const SimplePoint& point2 = connectionPoint.getConnectPoint2();
+
+    connections.push_back(connectionPoint);
+    connectionIndex.insert(connections.size() - 1, getEntityTile(point1.getRow(), point1.getColumn()),
+                           getEntityTile(point2.getRow(), point2.getColumn()));
+}
+
+///----------------------------------------------------------------------------
+/// removeConnection - Removes the first matching connection from a
+/// connection vector.
+/// @param vector containing the connection points
+/// @param index of the connections in the vector
+/// @param ConnectionPoint to remove
+/// @return true if it was removed, false if it was not found.
+///----------------------------------------------------------------------------
+
+bool GameMap::removeConnection(std::vector<ConnectionPoint>& connections, ConnectionIndex& connectionIndex,
+                               const ConnectionPoint& connectionPoint) {
+
+    const size_t conSize = connections.size();
+
+    for (size_t i = 0; i < conSize; ++i) {
+        if (connections[i] == connectionPoint) {
+            connections.erase(connections.begin() + i);
+            connectionIndex.erase(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///----------------------------------------------------------------------------
+/// readCharacters - Reads the "{cretr" section of the map from a buffer.
+/// @param reader positioned at the "{cretr" section
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void GameMap::readCharacters(WorldFileReader& reader) {
+
+    std::string errorMsg = "Error reading characters: ";
+
+    if(!reader.compareLine(AdventureGamerHeadings::Characters)) {
+        errorMsg.append("Expected \"" + AdventureGamerHeadings::Characters + "\"" + reader.positionString() + ".");
+        throw std::runtime_error(errorMsg);
+    }
+
+    try {
+
+        const int numChars = reader.readInteger();
+        gameCharacters.reserve(numChars > 0 ? numChars : 0);
+
+        for(int i = 0; i < numChars; i++) {
+
+            GameCharacter::Builder characterBuilder;
+            characterBuilder.readCharacter(reader);
+            gameCharacters.push_back(characterBuilder.build());
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readJumps - Read the "{jumps" section of the map from a buffer.
+/// @param reader positioned at the "{jumps" section
+/// @param log to report bad jumps to. If it is recording, they are skipped.
+/// @throws runtime_error if there are any problems reading the file.
+///----------------------------------------------------------------------------
+
+void GameMap::readJumps(WorldFileReader& reader, const DiagnosticLog& log) {
+
+    std::string errorMsg = "Error reading Jumps: ";
+
+    if(!reader.compareLine(AdventureGamerHeadings::Jumps)) {
+        errorMsg.append("Expected \"" + AdventureGamerHeadings::Jumps + "\"" + reader.positionString() + ".");
+        throw std::runtime_error(errorMsg);
+    }
+
+    try {
+
+        const int numJumps = reader.readInteger();
+        jumpPoints.reserve(numJumps > 0 ? numJumps : 0);
+
+        for(int i = 0; i < numJumps; i++) {
+
+            // TODO: Jump pads can be one way, so the tiles do not have to be
+            // jump pads, they just need to be on the map.
+
+            // Both points are always read, so a bad jump can be skipped.
+
+            bool isValid = true;
+
+            int x = reader.readInteger();
+            int y = reader.readInteger();
+            SimplePoint jumpA(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                log.report(reader.getLineNumber(), errorMsg, "Tile index was out of bounds" +
+                           reader.positionString() + ".");
+                isValid = false;
+            }
+
+            x = reader.readInteger();
+            y = reader.readInteger();
+            SimplePoint jumpB(x, y);
+
+            if(isValid && !isRowColInMapBounds(y, x)) {
+                log.report(reader.getLineNumber(), errorMsg, "Tile index was out of bounds" +
+                           reader.positionString() + ".");
+                isValid = false;
+            }
+
+            if(!isValid) {
+                continue;
+            }
+
+            ConnectionPoint jumpConnection(jumpA, jumpB);
+
+            if(ifConnectionExists(jumpPoints, jumpIndex, jumpConnection)) {
+                log.report(reader.getLineNumber(), errorMsg, "Duplicate Jump Point was read" +
+                           reader.positionString() + ".");
+                continue;
+            }
+
+            addConnection(jumpPoints, jumpIndex, jumpConnection);
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readObjects - Reads the "{objct" section of the map from a buffer.
+/// @param reader positioned at the "{objct" section
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void GameMap::readObjects(WorldFileReader& reader) {
+
+    std::string errorMsg = "Error reading objects: ";
+
+    if(!reader.compareLine(AdventureGamerHeadings::Objects)) {
+        errorMsg.append("Expected \"" + AdventureGamerHeadings::Objects + "\"" + reader.positionString() + ".");
+        throw std::runtime_error(errorMsg);
+    }
+
+    try {
+
+        const int numObjects = reader.readInteger();
+        gameObjects.reserve(numObjects > 0 ? numObjects : 0);
+
+        for(int i = 0; i < numObjects; i++) {
+
+            GameObject::Builder objectBuilder;
+            objectBuilder.readObject(reader);
+            gameObjects.push_back(objectBuilder.build());
+        }
+    }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
 }
 
-///----------------------------------------------------------------------------
-/// findMatchingPoint - Give the row and column, find the matching point if one
-/// exists.
-/// @param row of the connection point to search for
-/// @param column of the connection point to search for
-/// @return value NULL if nothing was found, a valid connection point if it was
-///----------------------------------------------------------------------------
-const SimplePoint* GameMap::findMatchingPoint(const int& row, const int& col, const std::vector<ConnectionPoint>& connections) const {
+///----------------------------------------------------------------------------
+/// readStory - Reads the STY file. It holds two quoted strings, the summary
+/// and then the story, which are found in place so each is only copied once.
+/// If there is no quote to end the summary, the whole file is the summary.
+/// @param storage the world is in
+/// @param a string indicating the name of the story file.
+///----------------------------------------------------------------------------
+
+void GameMap::readStory(const WorldStorage& storage, const std::string& storyFileName) {
+
+    StoragePart storyFile;
+
+    // Story files aren't mandatory, so if they're not found, there is no
+    // error.
+
+    if(!storage.openPart(storyFileName, storyFile)) {
+        summary = "";
+        story = "";
+        return;
+    }
+
+    const char* data = storyFile.getData();
+    const size_t size = storyFile.getSize();
+
+    const char* summaryEnd = LineScanner::findVBTerminator(data, size);
+
+    Frost::StringToken summaryText(data, summaryEnd ? static_cast<size_t>(summaryEnd - data) : size);
+    Frost::StringToken storyText(data + size, 0);
+
+    if(summaryEnd) {
+        const size_t storyStart = summaryText.length + 3;
+        storyText = Frost::StringToken(data + storyStart, size - storyStart);
+    }
+
+    summaryText = Frost::rtrimToken(Frost::ltrimToken(summaryText, "\""), "\n\r");
+    storyText = Frost::rtrimToken(Frost::ltrimToken(storyText, "\""), "\"\n\r");
+
+    summary.assign(summaryText.data, summaryText.length);
+    story.assign(storyText.data, storyText.length);
+
+}
+
+///----------------------------------------------------------------------------
+/// readSwitches - Read the "{swtchs" section of the map from a buffer.
+/// @param reader positioned at the "{swtchs" section
+/// @param log to report bad switches to. If it is recording, they are skipped.
+/// @throws runtime_error if there are any problems reading the file
+///----------------------------------------------------------------------------
+
+void GameMap::readSwitches(WorldFileReader& reader, const DiagnosticLog& log) {
+
+    std::string errorMsg = "Error reading switches: ";
+
+    if(!reader.compareLine(AdventureGamerHeadings::Switches)) {
+        errorMsg.append("Expected \"" + AdventureGamerHeadings::Switches + "\"" + reader.positionString() + ".");
+        throw std::runtime_error(errorMsg);
+    }
+
+    try {
+
+        const int numSwitches = reader.readInteger();
+        switchConnections.reserve(numSwitches > 0 ? numSwitches : 0);
+
+        for(int i = 0; i < numSwitches; i++) {
+
+            // Both points are always read, so a bad switch can be skipped.
+
+            bool isValid = true;
+
+            // Get the tile with the switch on it
+            int x = reader.readInteger();
+            int y = reader.readInteger();
+            SimplePoint connectionA(x, y);
+
+            if(!isRowColInMapBounds(y, x)) {
+                log.report(reader.getLineNumber(), errorMsg, "Tile index was out of bounds" +
+                           reader.positionString() + ".");
+                isValid = false;
+            }
+            else if(!(tiles[indexFromRowCol(y, x)].hasSwitch())) {
+                log.report(reader.getLineNumber(), errorMsg,
+                           "Read switch, but no switch was found at the coordinates read" +
+                           reader.positionString() + ".");
+                isValid = false;
+            }
+
+            // Get the tile effected
+            x = reader.readInteger();
+            y = reader.readInteger();
+            SimplePoint connectionB(x, y);
+
+            if(!isValid) {
+                continue;
+            }
+
+            if(!isRowColInMapBounds(y, x)) {
+                log.report(reader.getLineNumber(), errorMsg, "Tile index was out of bounds" +
+                           reader.positionString() + ".");
+                continue;
+            }
+
+            const GameTile& effectedTile = tiles[indexFromRowCol(y, x)];
 
-    const size_t conSize = connections.size();
-    SimplePoint* matchingPoint = NULL;
+            if(!(effectedTile.hasGate() || effectedTile.isDark())) {
+                log.report(reader.getLineNumber(), errorMsg,
+                           "Read switch, but the tile it effects is not a gate or dark space" +
+                           reader.positionString() + ".");
+                continue;
+            }
 
-    for (size_t i = 0; i < conSize; ++i) {
+            ConnectionPoint switchConnection(connectionA, connectionB);
 
-        const SimplePoint& conPoint1 = connections[i].getConnectPoint1();
-        const SimplePoint& conPoint2 = connections[i].getConnectPoint2();
+            if(ifConnectionExists(switchConnections, switchIndex, switchConnection)) {
+                log.report(reader.getLineNumber(), errorMsg, "Duplicate Switch Connection was read" +
+                           reader.positionString() + ".");
+                continue;
+            }
 
-        if (conPoint1.getColumn() == col && conPoint1.getRow() == row) {
-            return &conPoint2;
-        }
-        else if (conPoint2.getColumn() == col && conPoint2.getRow() == row) {
-            return &conPoint1;
+            addConnection(switchConnections, switchIndex, switchConnection);
         }
     }
+    catch (const std::runtime_error& e) {
+        errorMsg.append(e.what());
+        throw std::runtime_error(errorMsg);
+    }
 
-    return NULL;
 }
 
 ///----------------------------------------------------------------------------
-/// readCharacters - Reads the "{cretr" section of the map file
-/// @param mapFile an ifstream of the map file to be read from already at the
-/// "{cretr" section
-/// @throws runtime_error if there is a problem reading the file.
+/// readMapFiles - Reads the map from the files in a storage. See readMap.
+/// @param storage the world is in
+/// @param a string indicating the file's name
+/// @param log to record problems in. If it is not recording, the first
+/// problem is thrown instead.
+/// @throws runtime_error if the log is not recording and there is a problem
+/// reading the map.
 ///----------------------------------------------------------------------------
 
-void GameMap::readCharacters(std::ifstream& mapFile) {
+void GameMap::readMapFiles(const WorldStorage& storage, const std::string& fileName, const DiagnosticLog& log) {
 
-    std::string line;
-    std::string errorMsg = "Error reading characters: ";
-    Frost::getLineWindows(mapFile, line);
+    lastCharacterID = 0;
+    lastObjectID = 0;
 
-    if(AdventureGamerHeadings::Characters.compare(line)) {
-        errorMsg.append("Expected \"" + AdventureGamerHeadings::Characters + "\", but got \"" + line + "\".");
-        throw std::runtime_error(errorMsg);
+    StoragePart mapFile;
+
+    if(!storage.openPart(fileName, mapFile)) {
+
+        if(!log.isRecording()) {
+            throw std::runtime_error("Could not open " + fileName + " for reading.");
+        }
+
+        log.record(0, "Could not open " + fileName + " for reading.");
+        numCols = 0;
+        numRows = 0;
+        rebuildIndices();
+        return;
     }
 
-    std::getline(mapFile, line);
-    const int numChars = std::stoi(line);
-    gameCharacters.reserve(numChars);
+    readStory(storage, fileName.substr(0, fileName.length() - 4) + ".STY");
 
-    for(int i = 0; i < numChars; i++) {
-        GameCharacter::Builder characterBuilder;
+    // With lazy text, names and descriptions point into a copy of the file
+    // instead of being decoded, so the file itself can be closed.
 
-        try {
-            characterBuilder.readCharacter(mapFile);
-        }
-        catch (const std::invalid_argument e) {
-            errorMsg.append(e.what());
-            throw std::runtime_error(errorMsg);
-        }
+    SharedBuffer* textBuffer = lazyText ? SharedBuffer::create(mapFile.getData(), mapFile.getSize()) : NULL;
+    const char* mapData = textBuffer ? textBuffer->getData() : mapFile.getData();
 
-        GameCharacter gameCharacter = characterBuilder.build();
-        gameCharacters.push_back(gameCharacter);
+    WorldFileReader reader(mapData, mapFile.getSize());
+    reader.setTextBuffer(textBuffer);
+
+    try {
+        readMapText(reader, storage, fileName, log);
+    }
+    catch (...) {
 
-        if(gameCharacter.getID() > lastCharacterID) {
-            lastCharacterID = gameCharacter.getID();
+        if(textBuffer) {
+            textBuffer->release();
         }
 
+        throw;
     }
+
+    if(textBuffer) {
+        textBuffer->release();
+    }
+
 }
 
 ///----------------------------------------------------------------------------
-/// readJumps - Read the "{jumps" section of the file.
-/// @param mapFile an ifstream of the map file to be read from, already at the
-/// "{jumps" section.
-/// @throws runtime_error if there are any problems reading the file.
+/// readDimensions - Reads the size of the map, which follows the header.
+/// @param reader positioned just after the header
+/// @throws runtime_error if the size could not be read, or is out of range.
 ///----------------------------------------------------------------------------
 
-void GameMap::readJumps(std::ifstream& mapFile) {
+void GameMap::readDimensions(WorldFileReader& reader) {
 
-    std::string line;
-    std::string errorMsg = "Error reading Jumps: ";
-    Frost::getLineWindows(mapFile, line);
+    // Whatever the value read is, it is always one more than it says.
 
-    // Read the header
+    numCols = reader.readInteger() + 1;
+    numRows = reader.readInteger() + 1;
 
-    if(AdventureGamerHeadings::Jumps.compare(line)) {
-        errorMsg.append("Expected \"" + AdventureGamerHeadings::Jumps + "\", but got \"" + line + "\".");
-        throw std::runtime_error(errorMsg);
+    if(numCols < 1 || numRows < 1 || numCols > static_cast<int>(GameMapConstants::MaxCols) ||
+       numRows > static_cast<int>(GameMapConstants::MaxRows)) {
+        throw std::runtime_error("Map dimensions are out of range" + reader.positionString() + ".");
     }
 
+}
+
+///----------------------------------------------------------------------------
+/// readMapText - Reads everything in the map file after the story. See
+/// readMapFiles.
+/// @param reader at the start of the map file
+/// @param storage the world is in
+/// @param name of the map file
+/// @param log to record problems in
+/// @throws runtime_error if the log is not recording and there is a problem
+/// reading the map.
+///----------------------------------------------------------------------------
+
+void GameMap::readMapText(WorldFileReader& reader, const WorldStorage& storage, const std::string& fileName,
+                          const DiagnosticLog& log) {
+
+    const std::string baseName = fileName.substr(0, fileName.length() - 4);
+
+    // Nothing after the dimensions can be found without them, so this is the
+    // one problem that stops a diagnostic read.
+
     try {
 
-        std::getline(mapFile, line);
-        const int numJumps = std::stoi(line);
-        jumpPoints.reserve(numJumps);
+        gameInfo.readHeader(key, reader);
+        readDimensions(reader);
+    }
+    catch (const std::runtime_error& e) {
 
-        for(int i = 0; i < numJumps; i++) {
+        if(!log.isRecording()) {
+            throw;
+        }
 
-            std::getline(mapFile, line);
-            int x = std::stoi(line);
-            std::getline(mapFile, line);
-            int y = std::stoi(line);
-            SimplePoint jumpA(x, y);
+        log.record(reader.getLineNumber(), e.what());
+        numCols = 0;
+        numRows = 0;
+        rebuildIndices();
+        return;
+    }
 
-            if(!isRowColInMapBounds(y, x)) {
-                errorMsg.append("Tile index was out of bounds");
-                throw std::out_of_range(errorMsg);
-            }
+    tiles.assign(numRows * numCols, GameTile::Builder().build());
 
-            unsigned int tileIndex = indexFromRowCol(y, x);
-            if(!(tiles[tileIndex].hasJumpPad())) {
-                // TODO: Jump pad features don't actually have to be in the jump list.
-                errorMsg.append("Jump Pad position was read, but the coordinates given were not that of a Jump Pad tile.");
-                //throw std::runtime_error(errorMsg);
-            }
+    RowDescriptionLoader rowDescriptionLoader(storage, baseName, numRows, numCols, lazyText);
 
-            std::getline(mapFile, line);
-            x = std::stoi(line);
-            std::getline(mapFile, line);
-            y = std::stoi(line);
-            SimplePoint jumpB(x, y);
+    // Reading in parallel only stops at the first problem, so it is never
+    // used for diagnostics.
 
-            if(!isRowColInMapBounds(y, x)) {
-                errorMsg.append("Tile index was out of bounds");
-                throw std::out_of_range(errorMsg);
-            }
+    if(log.isRecording() || !readInParallel(reader, rowDescriptionLoader)) {
 
-            tileIndex = indexFromRowCol(y, x);
+        if(log.isRecording()) {
+            rowDescriptionLoader.load(*log.getDiagnostics());
+        }
+        else {
+            rowDescriptionLoader.load();
+        }
 
+        // Set after a problem, so the lines skipped to get past it are not
+        // reported as well.
+        bool recovering = false;
 
-            if(!(tiles[tileIndex].hasJumpPad())) {
-                // TODO: Jumppads can be one way, that is jump to a non-jumppad tile.
-                errorMsg.append("Jump Pad position was read, but the coordinates given were not that of a Jump Pad tile.");
-                //throw std::runtime_error(errorMsg);
-            }
+        readTileRows(reader, 0, numRows, rowDescriptionLoader, log, recovering);
 
-            ConnectionPoint jumpConnection(jumpA, jumpB);
-            
-            if(!ifConnectionExists(jumpPoints, jumpConnection)) {
-                jumpPoints.push_back(jumpConnection);
-            }
-            else {
-                errorMsg.append("Duplicate Jump Point was read.");
-                throw std::runtime_error(errorMsg);
-            }
+        for(int sectionRank = MapSectionRanks::Jumps; sectionRank <= MapSectionRanks::Characters; ++sectionRank) {
+            readSection(reader, sectionRank, log, recovering);
         }
+
     }
-    catch (const std::invalid_argument& e) {
-        errorMsg.append(e.what());
-        throw std::runtime_error(errorMsg);
+
+    // TODO: Objects should be counted towards lastObjectID.
+
+    for(size_t i = 0; i < gameObjects.size(); ++i) {
+        if(gameObjects[i].getID() > lastCharacterID) {
+            lastCharacterID = gameObjects[i].getID();
+        }
     }
-    catch (const std::out_of_range& e) {
-        errorMsg.append(e.what());
-        throw std::runtime_error(errorMsg);
+
+    for(size_t i = 0; i < gameCharacters.size(); ++i) {
+        if(gameCharacters[i].getID() > lastCharacterID) {
+            lastCharacterID = gameCharacters[i].getID();
+        }
     }
+
+    rebuildIndices();
+    clearDirty(storage.getPartPath(baseName));
+
 }
 
 ///----------------------------------------------------------------------------
-/// readRowDescriptions - Reads the descriptions from the file given, if it
-/// exists. If it does not, it is possible that there are no descriptions for
-/// this row.
-/// @param a string indicating the full path to the row file.
-/// @return a map containing the strings, with they key being the column index
-/// @throws runtime_error if there is a problem reading the file.
+/// readTileRows - Reads the tiles of the rows given into the tiles vector,
+/// which must already be the size of the map. Rows that could not be read
+/// are left as they were.
+/// @param reader positioned at the first row, or before it if recovering
+/// @param first row to read
+/// @param row after the last row to read
+/// @param row descriptions, which must be loaded for every row read
+/// @param log to record problems in
+/// @param (in/out) true if the reader is recovering from an earlier problem.
+/// Set to true if there was a problem with the last row, false if not.
+/// @throws runtime_error if the log is not recording and there is a problem
+/// reading any of the rows.
 ///----------------------------------------------------------------------------
 
-std::map<unsigned int, std::string> GameMap::readRowDescriptions(const std::string& rowFileName) {
+void GameMap::readTileRows(WorldFileReader& reader, const int& firstRow, const int& endRow,
+                           const RowDescriptionLoader& rowDescriptionLoader, const DiagnosticLog& log,
+                           bool& recovering) {
 
-    std::ifstream ifs;
-    std::string line;
-    std::string errorMsg = "Error reading row descriptions: ";
-    std::map<unsigned int, std::string> descriptionMap;
+    for (int row = firstRow; row < endRow; ++row) {
 
-#ifdef _WIN32
-    std::wstring wFullPathName = AtoW(rowFileName.c_str(), CP_UTF8);
-    ifs.open(wFullPathName.c_str(), std::ifstream::in | std::ios::binary);
-#else
-    ifs.open(rowFileName.c_str(), std::ifstream::in | std::ios::binary);
-#endif // _WIN32
-    
-    if(ifs) {
+        if(!syncToSection(reader, row, log, recovering)) {
+            recovering = true;
+            continue;
+        }
 
-        try {
-            std::getline(ifs, line);
-            const unsigned long numDescriptions = std::stoul(line);
+        const std::string rowID = AdventureGamerHeadings::Row + std::to_string(row);
 
-            for(unsigned long i = 0; i < numDescriptions; i++) {
-                std::getline(ifs, line);
+        if(!reader.compareLine(rowID)) {
+            throw std::runtime_error("Row identifier not found. Expected \"" + rowID + "\"" + reader.positionString() + ".");
+        }
 
-                if(line.empty()) {
-                    break; // Nothing left.
-                }
-                
-                const unsigned int colID = std::stoi(line);
+        recovering = false;
 
-                if(colID >= static_cast<unsigned int>(numCols)) {
-                    errorMsg.append("The column indicated is outside the boundaries of the map.");
-                    throw std::runtime_error(errorMsg);
-                }
+        const std::vector<LazyString>& rowDescriptions = rowDescriptionLoader.getRow(row);
+        size_t tileIndex = row * numCols;
+
+        try {
 
-                descriptionMap[colID] = Frost::readVBString(ifs);
+            for (int col = 0; col < numCols; ++col) {
+                GameTile::Builder tileBuilder;
+                tileBuilder.readTile(reader, rowDescriptions[col]);
+                tiles[tileIndex++] = tileBuilder.build();
             }
+
         }
-        catch (const std::invalid_argument& e) {
-            errorMsg.append(e.what());            
-            throw std::runtime_error(errorMsg);
-        }
-        catch (const std::out_of_range& e) {
-            errorMsg.append(e.what());
-            throw std::runtime_error(errorMsg);
-        }
-    }
-    else {
-        if(Frost::doesFileExist(rowFileName.c_str())) {
-            errorMsg.append("could not open " + rowFileName + " for reading.");
-            throw std::runtime_error(errorMsg);
+        catch (const std::runtime_error& e) {
+
+            if(!log.isRecording()) {
+                throw;
+            }
+
+            log.record(reader.getLineNumber(), "Error reading row " + std::to_string(row) + ": " + e.what());
+            recovering = true;
         }
+
     }
 
-    return descriptionMap;
 }
 
 ///----------------------------------------------------------------------------
-/// readObjects - Reads the "{objct" section of the map file
-/// @param mapFile an ifstream of the map file to be read from already at the
-/// "{objct" section
+/// readInParallel - Finds where each part of the map file starts, then reads
+/// the rows, objects and characters on several threads at once. The small
+/// sections in between are read on this thread once they are done.
+/// @param reader positioned just after the map dimensions. It is not moved,
+/// and each part gets a copy of it.
+/// @param row descriptions, which are read by the threads along with their
+/// rows
+/// @return true if the map was read, false if it was not worth using more
+/// than one thread, or there was a problem. If there was a problem, the map
+/// is left as it was so it can be read again on one thread, which finds out
+/// exactly what the problem was.
 ///----------------------------------------------------------------------------
 
-void GameMap::readObjects(std::ifstream& mapFile) {
+bool GameMap::readInParallel(const WorldFileReader& reader, RowDescriptionLoader& rowDescriptionLoader) {
 
-    std::string line;
-    std::string errorMsg = "Error reading objects: ";
-    Frost::getLineWindows(mapFile, line);
+    unsigned int numThreads = readThreads ? readThreads : WorkerPool::getHardwareThreadCount();
 
-    if(AdventureGamerHeadings::Objects.compare(line)) {
-        errorMsg.append("Expected \"" + AdventureGamerHeadings::Objects + "\", but got \"" + line + "\".");
-        throw std::runtime_error(errorMsg); 
+    if(numThreads > ParallelReadConstants::MaxThreads) {
+        numThreads = ParallelReadConstants::MaxThreads;
     }
 
-    std::getline(mapFile, line);
-    const int numObjects = std::stoi(line);
-    gameObjects.reserve(numObjects);
+    if(numThreads < 2 || reader.getSize() < ParallelReadConstants::MinFileSize) {
+        return false;
+    }
 
-    for(int i = 0; i < numObjects; i++) {
-        GameObject::Builder objectBuilder;
-        objectBuilder.readObject(mapFile);
-        GameObject gameObject = objectBuilder.build();
-        gameObjects.push_back(gameObject);
-        
-        if(gameObject.getID() > lastCharacterID) {
-            lastCharacterID = gameObject.getID();
+    WorldFileIndex index;
+
+    if(!index.scan(reader.getData(), reader.getSize(), reader.getOffset(), reader.getLineNumber(), numRows)) {
+        return false;
+    }
+
+    rowDescriptionLoader.prepareRows();
+
+    // Each part gets a reader that ends where the next part begins, so a
+    // part that is too short is caught instead of read past.
+
+    std::vector<MapPartJob*> partJobs;
+    const int numChunks = std::min(static_cast<int>(numThreads * ParallelReadConstants::ChunksPerThread),
+                                   numRows);
+
+    WorldFileReader objectsReader(reader);
+    objectsReader.setEnd(index.getCharacters().offset);
+    objectsReader.seek(index.getObjects().offset, index.getObjects().lineNumber - 1);
+
+    WorldFileReader charactersReader(reader);
+    charactersReader.seek(index.getCharacters().offset, index.getCharacters().lineNumber - 1);
+
+    // Objects and characters go first, as each one is a single job.
+
+    partJobs.push_back(new MapPartJob(*this, objectsReader, MapSectionRanks::Objects,
+                                      MapSectionRanks::Characters, rowDescriptionLoader));
+    partJobs.push_back(new MapPartJob(*this, charactersReader, MapSectionRanks::Characters,
+                                      MapSectionRanks::Characters + 1, rowDescriptionLoader));
+
+    for(int chunk = 0; chunk < numChunks; ++chunk) {
+
+        const int firstRow = (numRows * chunk) / numChunks;
+        const int endRow = (numRows * (chunk + 1)) / numChunks;
+        const size_t endOffset = endRow < numRows ? index.getRow(endRow).offset : index.getJumps().offset;
+
+        WorldFileReader rowsReader(reader);
+        rowsReader.setEnd(endOffset);
+        rowsReader.seek(index.getRow(firstRow).offset, index.getRow(firstRow).lineNumber - 1);
+
+        partJobs.push_back(new MapPartJob(*this, rowsReader, firstRow, endRow, rowDescriptionLoader));
+    }
+
+    std::vector<WorkerJob*> jobs(partJobs.begin(), partJobs.end());
+    bool succeeded = true;
+
+    try {
+        WorkerPool workerPool(numThreads);
+        workerPool.runJobs(jobs);
+    }
+    catch (const std::exception&) {
+        succeeded = false;
+    }
+
+    for(size_t i = 0; i < partJobs.size(); ++i) {
+
+        if(partJobs[i]->getFailed()) {
+            succeeded = false;
+        }
+
+        delete partJobs[i];
+        partJobs[i] = NULL;
+    }
+
+    if(succeeded) {
+
+        WorldFileReader sectionReader(reader);
+        sectionReader.setEnd(index.getObjects().offset);
+        sectionReader.seek(index.getJumps().offset, index.getJumps().lineNumber - 1);
+
+        try {
+            succeeded = readPart(sectionReader, MapSectionRanks::Jumps, MapSectionRanks::Objects,
+                                 rowDescriptionLoader);
         }
+        catch (const std::exception&) {
+            succeeded = false;
+        }
+
+    }
 
+    if(!succeeded) {
+        tiles.assign(numRows * numCols, GameTile::Builder().build());
+        jumpPoints.clear();
+        switchConnections.clear();
+        jumpIndex.reset();
+        switchIndex.reset();
+        gameObjects.clear();
+        gameCharacters.clear();
     }
+
+    return succeeded;
+
 }
 
 ///----------------------------------------------------------------------------
-/// readStory - Reads the STY file.
-/// @param a string indicating the full path to the story file.
+/// readPart - Reads the rows or sections given, which must be the only thing
+/// the reader has left to read.
+/// @param reader positioned at the first row or section
+/// @param MapSectionRanks value, or row number, of the first part to read
+/// @param the rank after the last part to read
+/// @param row descriptions. The rows read are loaded first.
+/// @return true if every part was read and the reader is at its end, false
+/// if it is not.
+/// @throws runtime_error if there is a problem reading any part.
 ///----------------------------------------------------------------------------
 
-void GameMap::readStory(const std::string& storyFilePath) {
-	
-    std::ifstream ifs;
-#ifdef _WIN32
-    std::wstring wFullPathName = AtoW(storyFilePath.c_str(), CP_UTF8);
-    ifs.open(wFullPathName.c_str(), std::ifstream::in | std::ios::binary);
-#else
-	ifs.open(storyFilePath.c_str(), std::ifstream::in | std::ios::binary);
-#endif // _WIN32
+bool GameMap::readPart(WorldFileReader& reader, const int& firstRank, const int& endRank,
+                       RowDescriptionLoader& rowDescriptionLoader) {
+
+    const DiagnosticLog log(NULL, "");
+    bool recovering = false;
+
+    if(firstRank < MapSectionRanks::Jumps) {
+
+        for(int row = firstRank; row < endRank; ++row) {
+            if(!rowDescriptionLoader.loadRow(row)) {
+                return false;
+            }
+        }
 
-	if(ifs) {
-		ifs.seekg(0, std::ios::end);
-		story.resize(static_cast<size_t>(ifs.tellg()));
-		ifs.seekg(0, std::ios::beg);
-		ifs.read(&story[0], story.size());
-		ifs.close();
+        readTileRows(reader, firstRank, endRank, rowDescriptionLoader, log, recovering);
     }
     else {
-        // No Story or summary exists.
-        summary = "";
-        story = "";
+        for(int sectionRank = firstRank; sectionRank < endRank; ++sectionRank) {
+            readSection(reader, sectionRank, log, recovering);
+        }
+    }
+
+    // Anything after the characters is ignored, the same as when the map is
+    // read on one thread.
+
+    return endRank > MapSectionRanks::Characters || reader.atEnd();
+
+}
+
+///----------------------------------------------------------------------------
+/// readSection - Reads one of the sections that come after the rows. If the
+/// log is recording, a problem in the section is recorded and whatever was
+/// read before it is kept.
+/// @param reader positioned at the section, or before it if recovering
+/// @param MapSectionRanks value of the section to read
+/// @param log to record problems in
+/// @param (in/out) true if the reader is recovering from an earlier problem.
+/// Set to true if there was a problem with this section, false if not.
+/// @throws runtime_error if the log is not recording and there is a problem
+/// reading the section.
+///----------------------------------------------------------------------------
+
+void GameMap::readSection(WorldFileReader& reader, const int& sectionRank, const DiagnosticLog& log,
+                          bool& recovering) {
+
+    if(!syncToSection(reader, sectionRank, log, recovering)) {
+        recovering = true;
         return;
     }
 
-    const size_t summarySize = story.find("\"\r\n"); 
+    try {
 
-    summary = story.substr(0, summarySize);
-    story = story.substr(summarySize + 3, std::string::npos);
-    
-    // Story files aren't mandatory, so if they're not found, there is no
-    // error.
+        switch(sectionRank) {
+            case MapSectionRanks::Jumps:        readJumps(reader, log);                         break;
+            case MapSectionRanks::Switches:     readSwitches(reader, log);                      break;
+            case MapSectionRanks::Attributes:   gameInfo.readPlayerAttributes(key, reader);     break;
+            case MapSectionRanks::Objects:      readObjects(reader);                            break;
+            case MapSectionRanks::Characters:   readCharacters(reader);                         break;
+        }
+
+        recovering = false;
+
+    }
+    catch (const std::runtime_error& e) {
+
+        if(!log.isRecording()) {
+            throw;
+        }
 
-    story = Frost::rtrim(Frost::ltrim(story, "\""), "\"\n\r");
-    summary =  Frost::rtrim(Frost::ltrim(summary, "\""), "\n\r");
+        log.record(reader.getLineNumber(), e.what());
+        recovering = true;
+    }
 
 }
 
 ///----------------------------------------------------------------------------
-/// readSwitches - Read the "{swtchs" section of the file.
-/// @param mapFile an ifstream of the map file to be read from already at the
-/// "{swtchs" section.
-/// @throws runtime_error if there are any problems reading the file
+/// getSectionRank - Checks if a line is the heading of a row or section.
+/// @param pointer to the start of the line
+/// @param length of the line, which may end with carriage returns
+/// @return the MapSectionRanks value of the heading, the row number if it is
+/// a row heading, or -1 if it is not a heading.
 ///----------------------------------------------------------------------------
 
-void GameMap::readSwitches(std::ifstream& mapFile) {
-    
-    std::string line;
-    std::string errorMsg = "Error reading switches: ";
-    Frost::getLineWindows(mapFile, line);
-
-    // Read the header
+int GameMap::getSectionRank(const char* line, size_t length) {
 
-    if(AdventureGamerHeadings::Switches.compare(line)) {
-        errorMsg.append("Expected \"" + AdventureGamerHeadings::Switches + "\", but got \"" + line + "\".");
-        throw std::runtime_error(errorMsg);
+    while(length != 0 && line[length - 1] == '\r') {
+        length--;
     }
 
-    try {
+    const std::string& rowHeading = AdventureGamerHeadings::Row;
 
-        std::getline(mapFile, line);
-        const int numSwitches = std::stoi(line);
-        switchConnections.reserve(numSwitches);
+    if(length > rowHeading.length() && !memcmp(line, rowHeading.c_str(), rowHeading.length())) {
 
-        for(int i = 0; i < numSwitches; i++) {
+        int row = 0;
 
-            // Get the tile with the switch on it
-            std::getline(mapFile, line);
-            int x = std::stoi(line);
-            std::getline(mapFile, line);
-            int y = std::stoi(line);
-            SimplePoint connectionA(x, y);
+        for(size_t i = rowHeading.length(); i < length; ++i) {
 
-            if(!isRowColInMapBounds(y, x)) {
-                errorMsg.append("Tile index was out of bounds");
-                throw std::out_of_range(errorMsg);
+            if(line[i] < '0' || line[i] > '9' || row >= static_cast<int>(GameMapConstants::MaxRows)) {
+                return -1;
             }
 
-            unsigned int tileIndex = indexFromRowCol(y, x);
+            row = (row * 10) + (line[i] - '0');
+        }
 
-            if(!(tiles[tileIndex].hasSwitch())) {
-                errorMsg.append("Read switch, but no switch was found at the coordinates read.");
-                throw std::runtime_error(errorMsg);
-            }
-            
-            // Get the tile effected
-            std::getline(mapFile, line);
-            x = std::stoi(line);
-            std::getline(mapFile, line);
-            y = std::stoi(line);
-            SimplePoint connectionB(x, y);
+        return row < static_cast<int>(GameMapConstants::MaxRows) ? row : -1;
+    }
 
-            if(!isRowColInMapBounds(y, x)) {
-                errorMsg.append("Tile index was out of bounds");
-                throw std::out_of_range(errorMsg);
-            }
+    for(int sectionRank = MapSectionRanks::Jumps; sectionRank <= MapSectionRanks::Characters; ++sectionRank) {
 
-            tileIndex = indexFromRowCol(y, x);
+        const std::string heading = getSectionName(sectionRank);
 
-            if(! (tiles[tileIndex].hasGate() || tiles[tileIndex].isDark()) ) {
-                errorMsg.append("Read switch, but the tile it effects is not a gate or dark space.");
-                throw std::runtime_error(errorMsg);
-            }
+        if(length == heading.length() && !memcmp(line, heading.c_str(), length)) {
+            return sectionRank;
+        }
+    }
 
-            ConnectionPoint switchConnection(connectionA, connectionB);
+    return -1;
 
-            if (!ifConnectionExists(switchConnections, switchConnection)) {
-                switchConnections.push_back(switchConnection);
-            }
-            else {
-                errorMsg.append("Duplicate Switch Connection was read.");
-                throw std::runtime_error(errorMsg);
-            }
+}
+
+///----------------------------------------------------------------------------
+/// getSectionName - Gets the heading of a row or section.
+/// @param MapSectionRanks value, or row number
+/// @return the heading as it appears in the map file.
+///----------------------------------------------------------------------------
+
+std::string GameMap::getSectionName(const int& sectionRank) {
+
+    switch(sectionRank) {
+        case MapSectionRanks::Jumps:        return AdventureGamerHeadings::Jumps;
+        case MapSectionRanks::Switches:     return AdventureGamerHeadings::Switches;
+        case MapSectionRanks::Attributes:   return AdventureGamerHeadings::Attributes;
+        case MapSectionRanks::Objects:      return AdventureGamerHeadings::Objects;
+        case MapSectionRanks::Characters:   return AdventureGamerHeadings::Characters;
+    }
+
+    return AdventureGamerHeadings::Row + std::to_string(sectionRank);
 
+}
+
+///----------------------------------------------------------------------------
+/// syncToSection - When the log is recording, moves the reader up to the
+/// heading of the row or section given, skipping any lines that belong to an
+/// earlier one. If a later heading is found first, or the file ends, the
+/// section is missing and the reader is left where it is. When the log is
+/// not recording, nothing is done and the section reader checks the heading
+/// itself.
+/// @param reader to move
+/// @param MapSectionRanks value, or row number, of the heading to find
+/// @param log to record skipped lines and missing headings in
+/// @param true if the reader is recovering from an earlier problem, in which
+/// case skipping lines is expected and not recorded.
+/// @return true if the reader is at the heading, false if it is missing.
+///----------------------------------------------------------------------------
+
+bool GameMap::syncToSection(WorldFileReader& reader, const int& sectionRank, const DiagnosticLog& log,
+                            const bool& recovering) {
+
+    if(!log.isRecording()) {
+        return true;
+    }
+
+    const size_t firstLine = reader.getLineNumber() + 1;
+    const size_t firstOffset = reader.getOffset();
+    size_t numSkipped = 0;
+    bool found = false;
+
+    const char* lineStart;
+    size_t lineLength;
+
+    while(reader.peekLine(lineStart, lineLength)) {
+
+        const int lineRank = getSectionRank(lineStart, lineLength);
+
+        if(lineRank == sectionRank) {
+            found = true;
+            break;
+        }
+
+        if(lineRank > sectionRank) {
+            break;
         }
+
+        reader.nextLine(lineStart, lineLength);
+        numSkipped++;
     }
-    catch (const std::invalid_argument& e) {
-        errorMsg.append(e.what());
-        throw std::runtime_error(errorMsg);
+
+    // If the heading is missing, the lines skipped were what was left of
+    // it, so only the missing heading is worth reporting.
+
+    if(found && numSkipped && !recovering) {
+        log.record(firstLine, "Skipped " + std::to_string(numSkipped) + " unexpected line" +
+                   (numSkipped == 1 ? "" : "s") + " before \"" + getSectionName(sectionRank) + "\"" +
+                   Frost::positionString(firstLine, firstOffset) + ".");
     }
-    catch (const std::out_of_range& e) {
-        errorMsg.append(e.what());
-        throw std::out_of_range(errorMsg);
+
+    if(!found) {
+        log.record(reader.getLineNumber() + 1, "\"" + getSectionName(sectionRank) + "\" is missing" +
+                   Frost::positionString(reader.getLineNumber() + 1, reader.getOffset()) + ".");
     }
 
+    return found;
+
 }
 
 ///----------------------------------------------------------------------------
-/// writeStory - Writes the STY file.
-/// @param a string indicating the full path to the story file.
+/// estimateMapFileSize - Works out roughly how big the SG0 file will be, so
+/// the buffer it is built in rarely has to grow.
+/// @return the estimated size of the map file in bytes
 ///----------------------------------------------------------------------------
 
-void GameMap::writeStory(const std::string& storyFilePath) {
-    
-    std::ofstream ofs;
-
-#ifdef _WIN32
-    std::wstring wFullPathName = AtoW(storyFilePath.c_str(), CP_UTF8);
-    ofs.open(wFullPathName.c_str(), std::ofstream::out | std::ios::binary);
-#else 
-    ofs.open(storyFilePath.c_str(), std::ofstream::out | std::ios::binary);
-#endif // _WIN32_
-
-    if (ofs) {
-        ofs.put('\"');
-        ofs.write(&summary[0], summary.size());
-        ofs.put('\"');
-        ofs.put('\r');
-        ofs.put('\n');
-        
+size_t GameMap::estimateMapFileSize() const {
 
-        ofs.put('\"');
-        ofs.write(&story[0], story.size());
-        ofs.put('\"');
-        ofs.put('\r');
-        ofs.put('\n');
-        
+    // An integer line is at most 14 bytes, and most are 5. Tiles are two
+    // integers plus their name, objects and characters are about 30 lines.
+
+    size_t estimatedSize = 1024 + (tiles.size() * 18);
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        estimatedSize += tiles[i].getStoredNameLength();
     }
 
+    estimatedSize += (jumpPoints.size() + switchConnections.size()) * 32;
+    estimatedSize += (gameObjects.size() + gameCharacters.size()) * 512;
+
+    return estimatedSize;
+
+}
+
+///----------------------------------------------------------------------------
+/// writeStory - Builds the contents of the STY file.
+/// @param buffer to build the story file in
+///----------------------------------------------------------------------------
+
+void GameMap::writeStory(std::string& storyBuffer) {
+
+    storyBuffer.reserve(summary.size() + story.size() + 8);
+
+    storyBuffer.push_back('\"');
+    storyBuffer.append(summary);
+    storyBuffer.append("\"\r\n", 3);
+
+    storyBuffer.push_back('\"');
+    storyBuffer.append(story);
+    storyBuffer.append("\"\r\n", 3);
+
 }
 
 ///----------------------------------------------------------------------------
 /// writeJumps - Write the Jump points to the map file
-/// @param ofstream of the map file to be written to.
+/// @param buffer the map file is being built in.
 ///----------------------------------------------------------------------------
 
-void GameMap::writeJumps(std::ofstream& mapFile) {
+void GameMap::writeJumps(std::string& mapBuffer) {
     
-    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Jumps);
+    Frost::writeVBLine(mapBuffer, AdventureGamerHeadings::Jumps);
 
     const size_t numJumps = jumpPoints.size();
 
-    Frost::writeVBInteger(mapFile, numJumps);
+    Frost::writeVBInteger(mapBuffer, numJumps);
 
     for (size_t i = 0; i < numJumps; ++i) {
         const SimplePoint& firstPoint = jumpPoints[i].getConnectPoint1();
         const SimplePoint& secondPoint = jumpPoints[i].getConnectPoint2();
-        Frost::writeVBInteger(mapFile, firstPoint.getX());
-        Frost::writeVBInteger(mapFile, firstPoint.getY());
-        Frost::writeVBInteger(mapFile, secondPoint.getX());
-        Frost::writeVBInteger(mapFile, secondPoint.getY());
+        Frost::writeVBInteger(mapBuffer, firstPoint.getX());
+        Frost::writeVBInteger(mapBuffer, firstPoint.getY());
+        Frost::writeVBInteger(mapBuffer, secondPoint.getX());
+        Frost::writeVBInteger(mapBuffer, secondPoint.getY());
     }
 }
 
 ///----------------------------------------------------------------------------
 /// writeSwitches - Write the Switch Connections to the map file
-/// @param ofstream of the map file to be written to.
+/// @param buffer the map file is being built in.
 ///----------------------------------------------------------------------------
 
-void GameMap::writeSwitches(std::ofstream& mapFile) {
+void GameMap::writeSwitches(std::string& mapBuffer) {
     
-    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Switches);
+    Frost::writeVBLine(mapBuffer, AdventureGamerHeadings::Switches);
     const size_t numSwitches = switchConnections.size();
 
-    Frost::writeVBInteger(mapFile, numSwitches);
+    Frost::writeVBInteger(mapBuffer, numSwitches);
 
     for (size_t i = 0; i < numSwitches; ++i) {
         const SimplePoint& firstPoint = switchConnections[i].getConnectPoint1();
         const SimplePoint& secondPoint = switchConnections[i].getConnectPoint2();
-        Frost::writeVBInteger(mapFile, firstPoint.getX());
-        Frost::writeVBInteger(mapFile, firstPoint.getY());
-        Frost::writeVBInteger(mapFile, secondPoint.getX());
-        Frost::writeVBInteger(mapFile, secondPoint.getY());
+        Frost::writeVBInteger(mapBuffer, firstPoint.getX());
+        Frost::writeVBInteger(mapBuffer, firstPoint.getY());
+        Frost::writeVBInteger(mapBuffer, secondPoint.getX());
+        Frost::writeVBInteger(mapBuffer, secondPoint.getY());
     }
 
 }
 
 ///----------------------------------------------------------------------------
 /// writeObjects - Write the objects section to the map file given.
-/// @param ofstream of the map file to be written to.
+/// @param buffer the map file is being built in.
 ///----------------------------------------------------------------------------
 
-void GameMap::writeObjects(std::ofstream& mapFile) {
+void GameMap::writeObjects(std::string& mapBuffer) {
     
-    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Objects);
+    Frost::writeVBLine(mapBuffer, AdventureGamerHeadings::Objects);
     
     const size_t numObjects = gameObjects.size();
 
-    Frost::writeVBInteger(mapFile, numObjects);
+    Frost::writeVBInteger(mapBuffer, numObjects);
 
     for (size_t i = 0; i < numObjects; ++i) {
-        gameObjects[i].writeObject(mapFile);
+        gameObjects[i].writeObject(mapBuffer);
     }
 }
 
 ///----------------------------------------------------------------------------
 /// writeCharacters - Write the characters section to the map file given.
-/// @param ofstream of the map file to be written to.
+/// @param buffer the map file is being built in.
 ///----------------------------------------------------------------------------
 
-void GameMap::writeCharacters(std::ofstream& mapFile) {
+void GameMap::writeCharacters(std::string& mapBuffer) {
 
-    Frost::writeVBLine(mapFile, AdventureGamerHeadings::Characters);
+    Frost::writeVBLine(mapBuffer, AdventureGamerHeadings::Characters);
     
     const size_t numChars = gameCharacters.size();
 
-    Frost::writeVBInteger(mapFile, numChars);
+    Frost::writeVBInteger(mapBuffer, numChars);
 
     for (size_t i = 0; i < numChars; ++i) {
-        gameCharacters[i].writeCharacter(mapFile);
+        gameCharacters[i].writeCharacter(mapBuffer);
     }
 }
 
@@ -1436,8 +2600,26 @@ void GameMap::writeCharacters(std::ofstream& mapFile) {
 // New Functions to be moved after
 //=============================================================================
 
-void GameMap::updateTile(GMKey, const size_t& index, GameTile& gameTile) {
+void GameMap::updateTile(GMKey, const size_t& index, const GameTile& gameTile) {
+    tiles[index] = gameTile;
+    markRowDirty(index);
+    updateTileStates(index, NULL);
+}
+
+///----------------------------------------------------------------------------
+/// updateTile - Same as above, but also gives the tiles whose state changed
+/// because of it, such as the tiles a switch lights when it is turned on.
+/// @param GMKey used to restrict access of this function.
+/// @param index of the tile to update
+/// @param the new tile
+/// @param (out) vector to add the index of each tile whose TileStateFlags
+/// changed to, which can include the tile itself.
+///----------------------------------------------------------------------------
+
+void GameMap::updateTile(GMKey, const size_t& index, const GameTile& gameTile, std::vector<int>& outChangedStates) {
     tiles[index] = gameTile;
+    markRowDirty(index);
+    updateTileStates(index, &outChangedStates);
 }
 
 bool GameMap::resizeMap(const int& newRows, const int& newCols) {
@@ -1446,6 +2628,9 @@ bool GameMap::resizeMap(const int& newRows, const int& newCols) {
         return true;
     }
 
+    // Every row file has to be written again, as do any that were added.
+    markAllDirty();
+
     bool onlyClearTiles = false;
 
     GameTile::Builder builder;
@@ -1453,6 +2638,8 @@ bool GameMap::resizeMap(const int& newRows, const int& newCols) {
 
     if (newCols == numCols && newRows > numRows) {
         tiles.resize(newCols * newRows, gt);
+        numRows = newRows;
+        rebuildIndices();
         return true;
     }
     else if (newCols == numCols && newRows < numRows) {
@@ -1532,6 +2719,7 @@ bool GameMap::resizeMap(const int& newRows, const int& newCols) {
     if (onlyClearTiles) {
         numRows = newRows;
         numCols = newCols;
+        rebuildIndices();
         return true;
     }
 
@@ -1559,6 +2747,7 @@ bool GameMap::resizeMap(const int& newRows, const int& newCols) {
     tiles = newTiles;
     numRows = newRows;
     numCols = newCols;
+    rebuildIndices();
     return true;
 }
 
@@ -1567,5 +2756,7 @@ void GameMap::clearTileFeature(const size_t& index) {
     GameTile::Builder tileBuilder(tiles[index]);
     tileBuilder.clearModifers();
     tiles[index] = tileBuilder.build();
+    markRowDirty(index);
+    updateTileStates(index, NULL);
 
 }
\ No newline at end of file
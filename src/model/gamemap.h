@@ -9,8 +9,17 @@
 #include "gamecharacter.h"
 #include "gameinfo.h"
 #include "connection_point.h"
+#include "world_diagnostic.h"
+#include "gamemap_scan.h"
+#include "entityid_index.h"
+#include "entitygroup_index.h"
+#include "connection_index.h"
 #include "../compat/stdint_compat.h"
 
+class WorldFileReader;
+class RowDescriptionLoader;
+class WorldStorage;
+
 #ifdef _WIN32
     #define _WINSOCK2API_ // Otherwise it won't include cstring
     #include <wxx_cstring.h>
@@ -36,6 +45,33 @@ namespace GameMapConstants {
     const unsigned int MaxSummaryText       = 8192;
 }
 
+//-----------------------------------------------------------------------------
+// GameMapSections - Parts of the map that are tracked for changes so that
+// saving only has to write out what changed.
+//-----------------------------------------------------------------------------
+
+namespace GameMapSections {
+    const uint8_t Jumps         = 1;
+    const uint8_t Switches      = 2;
+    const uint8_t Objects       = 4;
+    const uint8_t Characters    = 8;
+    const uint8_t Story         = 16;
+    const uint8_t Info          = 32;
+    const uint8_t Tiles         = 64;
+    const uint8_t All           = 127;
+}
+
+//-----------------------------------------------------------------------------
+// TileStateFlags - What a tile looks like because of the switch it is
+// connected to. Kept by the map, so it does not have to be worked out each
+// time the tile is drawn.
+//-----------------------------------------------------------------------------
+
+namespace TileStateFlags {
+    const uint8_t Lit           = 1;    // Dark, but connected to a switch that is on.
+    const uint8_t GateOpen      = 2;    // Has a gate connected to a switch that is on.
+}
+
 class GameMap {
 
     public:
@@ -51,7 +87,8 @@ class GameMap {
             GMKey(GMKey &t) {};
         };
 
-		GameMap() {};
+		GameMap() : numCols(0), numRows(0), lastObjectID(0), lastCharacterID(0), lazyText(false),
+                    dirtySections(GameMapSections::All) {};
 		GameMap(const int& numRows, const int& numCols);
     
         // Accessors
@@ -65,14 +102,19 @@ class GameMap {
         const std::string& getStory() const { return story; }
         const std::string& getSummary() const { return summary; }
         inline const GameTile& getTile(const int& index) const { return tiles[index]; }
+        inline const uint8_t& getTileState(const int& index) const { return tileStates[index]; }
+        const std::vector<uint8_t>& getTileStates() const { return tileStates; }
         const GameInfo& getGameInfo() const { return gameInfo; }
 
         // Collection Accessors
         const std::vector<size_t> getCharacterInventory(const size_t& charID) const;
         const std::vector<size_t> getReliantObjectsFromID(const size_t& objectID) const;
+        const std::vector<size_t> getDoorKeysAtRowCol(const int& row, const int& col) const;
 		const std::vector<GameObject>& getGameObjects() const;
         const std::vector<GameObject> getGameObjectsAtRowCol(const int& row, const int& col) const;
         const std::vector<GameCharacter> getGameCharactersAtRowCol(const int& row, const int& col) const;
+        const std::vector<size_t>& getObjectIndicesAtRowCol(const int& row, const int& col) const;
+        const std::vector<size_t>& getCharacterIndicesAtRowCol(const int& row, const int& col) const;
         const std::vector<GameCharacter>& getGameCharacters() const;
         const std::vector<GameTile::DrawInfo> getTileDrawData() const;
         const std::vector<GameTile>& getTiles() const;
@@ -80,10 +122,13 @@ class GameMap {
         // Information Functions
 
         const bool isConnectedToOnSwitch(const int& row, const int& col) const;
+        bool hasUnsavedChanges() const { return dirtySections != 0; }
+        bool isSectionDirty(const uint8_t& section) const { return (dirtySections & section) != 0; }
+        bool isRowDirty(const int& row) const;
 
         // Mutators
-        void addCharacter(GMKey, GameCharacter& gameCharacter);
-        void addObject(GMKey, GameObject& gameObject);
+        void addCharacter(GMKey, const GameCharacter& gameCharacter);
+        void addObject(GMKey, const GameObject& gameObject);
         void deleteCharacter(GMKey, const size_t& index);
         void deleteObject(GMKey, const size_t& index);
         void addJump(GMKey, SimplePoint& firstConnection, SimplePoint& secondConnection);
@@ -105,9 +150,12 @@ class GameMap {
             bd.flags(flags);
 
             tiles[index] = bd.build();
+            markRowDirty(index);
+            updateTileStates(index, NULL);
         }
 
-        void updateTile(GMKey, const size_t& index, GameTile& gameTile);
+        void updateTile(GMKey, const size_t& index, const GameTile& gameTile);
+        void updateTile(GMKey, const size_t& index, const GameTile& gameTile, std::vector<int>& outChangedStates);
 
         void updateTileDescription(GMKey, const size_t& index, const std::string& tileName, const std::string& tileDescription);
         void updateGameInfo(GMKey, const GameInfo& newInfo);
@@ -125,8 +173,19 @@ class GameMap {
         bool isRowColInMapBounds(const int& row, const int& col) const;
         bool isIndexInMapBounds(const int& index) const;
 
-        void readMap(std::ifstream& mapFile, const std::string& filePath, const std::string& fileName);
-        void writeMap(std::ofstream& mapFile, const std::string& filePath, const std::string& fileName);
+        void readMap(const std::string& filePath, const std::string& fileName);
+        bool readMap(const std::string& filePath, const std::string& fileName,
+                     std::vector<WorldDiagnostic>& outDiagnostics);
+        void readMap(const WorldStorage& storage, const std::string& fileName);
+        bool readMap(const WorldStorage& storage, const std::string& fileName,
+                     std::vector<WorldDiagnostic>& outDiagnostics);
+        static void scanMap(const std::string& filePath, const std::string& fileName, GameMapScan& outScan);
+        static void scanMap(const WorldStorage& storage, const std::string& fileName, GameMapScan& outScan);
+        static void setReadThreads(const unsigned int& numThreads);
+        void setLazyText(const bool& inLazyText);
+        const bool& getLazyText() const;
+        void writeMap(const std::string& filePath, const std::string& fileName);
+        void writeMap(WorldStorage& storage, const std::string& fileName);
 
         // TODO: inline these?
         const SimplePoint* findSwitchPoint(const int& row, const int& col) const;
@@ -144,22 +203,68 @@ class GameMap {
 
     private:
 
-        const bool ifConnectionExists(const std::vector<ConnectionPoint>& connections, const ConnectionPoint& connectionPoint) const;
-        const SimplePoint* findMatchingPoint(const int& row, const int& col, const std::vector<ConnectionPoint>& connections) const;
+        // Written and read directly by the world cache.
+        friend class GameMapCache;
+        friend class MapPartJob;
+
+        void markRowDirty(const size_t& tileIndex);
+        void markSectionDirty(const uint8_t& section) { dirtySections |= section; }
+        void markAllDirty();
+        void clearDirty(const std::string& basePath);
+
+        int getEntityTile(const int& row, const int& col) const;
+        int getObjectTile(const GameObject& gameObject) const;
+        int getDoorKeyTile(const GameObject& gameObject) const;
+        static int getReferenceGroup(const int& id);
+        void indexObject(const size_t& index, const GameObject& gameObject);
+        void rebuildIndices();
+
+        uint8_t calculateTileState(const size_t& index) const;
+        void updateTileState(const int& index, std::vector<int>* outChangedStates);
+        void updateTileStates(const size_t& index, std::vector<int>* outChangedStates);
+        void updateSwitchStates(const SimplePoint& point1, const SimplePoint& point2);
+
+        const bool ifConnectionExists(const std::vector<ConnectionPoint>& connections, const ConnectionIndex& connectionIndex,
+                                      const ConnectionPoint& connectionPoint) const;
+        const SimplePoint* findMatchingPoint(const int& row, const int& col, const std::vector<ConnectionPoint>& connections,
+                                             const ConnectionIndex& connectionIndex) const;
+        void addConnection(std::vector<ConnectionPoint>& connections, ConnectionIndex& connectionIndex,
+                           const ConnectionPoint& connectionPoint);
+        bool removeConnection(std::vector<ConnectionPoint>& connections, ConnectionIndex& connectionIndex,
+                              const ConnectionPoint& connectionPoint);
         
-        std::map<unsigned int, std::string> readRowDescriptions(const std::string& rowFileName);
-
-        void readCharacters(std::ifstream& mapFile);
-        void readJumps(std::ifstream& mapFile);
-        void readObjects(std::ifstream& mapFile);
-        void readStory(const std::string& storyFileName);
-        void readSwitches(std::ifstream& mapFile);        
 
-        void writeStory(const std::string& storyFileName);
-        void writeJumps(std::ofstream& mapFile);
-        void writeSwitches(std::ofstream& mapFile);
-        void writeObjects(std::ofstream& mapFile);
-        void writeCharacters(std::ofstream& mapFile);
+        void readStory(const WorldStorage& storage, const std::string& storyFileName);
+
+        void readCharacters(WorldFileReader& reader);
+        void readJumps(WorldFileReader& reader, const DiagnosticLog& log);
+        void readObjects(WorldFileReader& reader);
+        void readSwitches(WorldFileReader& reader, const DiagnosticLog& log);
+
+        void readMapFiles(const WorldStorage& storage, const std::string& fileName, const DiagnosticLog& log);
+        void readDimensions(WorldFileReader& reader);
+        void readMapText(WorldFileReader& reader, const WorldStorage& storage, const std::string& fileName,
+                         const DiagnosticLog& log);
+        void readTileRows(WorldFileReader& reader, const int& firstRow, const int& endRow,
+                          const RowDescriptionLoader& rowDescriptionLoader, const DiagnosticLog& log,
+                          bool& recovering);
+        bool readInParallel(const WorldFileReader& reader, RowDescriptionLoader& rowDescriptionLoader);
+        bool readPart(WorldFileReader& reader, const int& firstRank, const int& endRank,
+                      RowDescriptionLoader& rowDescriptionLoader);
+        void readSection(WorldFileReader& reader, const int& sectionRank, const DiagnosticLog& log,
+                         bool& recovering);
+        static int getSectionRank(const char* line, size_t length);
+        static std::string getSectionName(const int& sectionRank);
+        bool syncToSection(WorldFileReader& reader, const int& sectionRank, const DiagnosticLog& log,
+                           const bool& recovering);
+
+        size_t estimateMapFileSize() const;
+        void writeParts(WorldStorage& storage, const std::string& baseName, const std::string& fileName);
+        void writeStory(std::string& storyBuffer);
+        void writeJumps(std::string& mapBuffer);
+        void writeSwitches(std::string& mapBuffer);
+        void writeObjects(std::string& mapBuffer);
+        void writeCharacters(std::string& mapBuffer);
 
         GameInfo gameInfo;
         
@@ -168,6 +273,7 @@ class GameMap {
         int lastObjectID;
         int lastCharacterID;
         int lastUnusedCharacterID;
+        bool lazyText;
 
         std::string summary;
         std::string story;
@@ -177,6 +283,32 @@ class GameMap {
         std::vector<GameObject> gameObjects;
         std::vector<GameCharacter> gameCharacters;
 
+        // The objects on the ground and the characters on each tile, and
+        // where each ID is.
+        EntityGroupIndex objectsOnTiles;
+        EntityGroupIndex charactersOnTiles;
+        EntityIDIndex objectIDs;
+        EntityIDIndex characterIDs;
+
+        // What refers to what: the objects used with each object ID, the
+        // objects held by each character ID, and the keys for each door tile.
+        EntityGroupIndex objectsUsedWith;
+        EntityGroupIndex objectsHeldBy;
+        EntityGroupIndex doorKeysOnTiles;
+
+        // The jumps and switches each tile is part of.
+        ConnectionIndex jumpIndex;
+        ConnectionIndex switchIndex;
+
+        // TileStateFlags for each tile.
+        std::vector<uint8_t> tileStates;
+
+        // What has changed since the map was last read or written, and where
+        // it was. Saving anywhere else has to write everything.
+        std::vector<bool> dirtyRows;
+        uint8_t dirtySections;
+        std::string savedBasePath;
+
         GameInfo::Key key;
         
 
@@ -0,0 +1,963 @@
+#include "gamemap_cache.h"
+#include <stdexcept>
+#include <cstring>
+#include <map>
+#include "gamemap.h"
+#include "worldfile_reader.h"
+#include "../util/sharedbuffer.h"
+#include "../util/worldstorage.h"
+
+//-----------------------------------------------------------------------------
+// Layout of the cache file. All numbers are stored in the machine's own byte
+// order, and strings as a 32-bit length followed by the bytes. Names and
+// descriptions have a byte before that saying how the text is encoded.
+//
+// Header:  Magic, Version, ByteOrderMark, number of sources, then for each
+//          source (SG0, STY, T00, T01, ...): exists, size, modified time and
+//          content hash.
+// Body:    Map dimensions and last IDs, GameInfo, summary, story, tiles,
+//          jumps, switches, objects, characters, then EndMagic.
+//-----------------------------------------------------------------------------
+
+namespace GameMapCacheLayout {
+    const char      Magic[4]        = { 'A', 'G', 'M', 'C' };
+    const char      EndMagic[4]     = { 'A', 'G', 'M', 'E' };
+    const uint32_t  ByteOrderMark   = 0x01020304;
+    const size_t    NumFixedSources = 2; // SG0 and STY, the TXX files follow.
+
+    // The fewest bytes each connection, object and character can take, so
+    // their counts can be checked against what is left of the cache. The
+    // world files put no limit on how many there are.
+
+    const size_t    StringSize      = sizeof(uint32_t);
+    const size_t    TextSize        = sizeof(uint8_t) + StringSize;
+    const size_t    ConnectionSize  = 4 * sizeof(int32_t);
+    const size_t    MinObjectSize   = (2 * AttributeTypes::NumTypes * sizeof(int32_t)) +
+                                      (GameObjectDescriptions::NumAllDescriptions * TextSize) +
+                                      (2 * sizeof(uint8_t)) + StringSize + (12 * sizeof(int32_t));
+    const size_t    MinCharacterSize = (AttributeTypes::NumTypesForCharacters * sizeof(int32_t)) +
+                                       (GameCharacterDescriptions::NumAllDescriptions * TextSize) +
+                                       sizeof(uint8_t) + StringSize + (7 * sizeof(int32_t));
+}
+
+//=============================================================================
+// CacheReader - Reads values from the cache, making sure it never reads past
+// the end of it. If it is given a copy of the cache as a text buffer, strings
+// read into a LazyString point into the copy instead of being copied out, and
+// are only decoded when they are first used.
+//=============================================================================
+
+class CacheReader {
+
+    public:
+
+        CacheReader(const char* inData, const size_t& inSize) : data(inData), size(inSize), offset(0),
+                                                                textBuffer(NULL) {}
+
+        ~CacheReader() {
+            if(textBuffer) {
+                textBuffer->release();
+            }
+        }
+
+        // Takes over the reference given.
+
+        void setTextBuffer(SharedBuffer* inTextBuffer) {
+            textBuffer = inTextBuffer;
+        }
+
+        bool atEnd() const { return offset == size; }
+
+        void readBytes(void* outData, const size_t& length) {
+            checkRemaining(length);
+            memcpy(outData, data + offset, length);
+            offset += length;
+        }
+
+        uint8_t readU8() {
+            checkRemaining(1);
+            return static_cast<uint8_t>(data[offset++]);
+        }
+
+        uint32_t readU32() {
+            uint32_t value;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        int32_t readI32() {
+            int32_t value;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        uint64_t readU64() {
+            uint64_t value;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        int64_t readI64() {
+            int64_t value;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        void readString(std::string& outString) {
+            const uint32_t length = readU32();
+            checkRemaining(length);
+            outString.assign(data + offset, length);
+            offset += length;
+        }
+
+        void readString(LazyString& outString) {
+
+            const uint8_t encoding = readU8();
+
+            if(encoding != LazyString::Plain && encoding != LazyString::VBString) {
+                throw std::runtime_error("Cache text encoding out of range.");
+            }
+
+            const uint32_t length = readU32();
+            checkRemaining(length);
+
+            if(textBuffer) {
+                outString.setReference(textBuffer, offset, length, static_cast<LazyString::Encoding>(encoding));
+            }
+            else if(encoding == LazyString::VBString) {
+                WorldFileReader::decodeVBString(data + offset, length, outString.edit());
+            }
+            else {
+                outString.edit().assign(data + offset, length);
+            }
+
+            offset += length;
+        }
+
+        // Counts are checked against the limit given so a damaged cache
+        // cannot make us allocate huge amounts of memory.
+
+        uint32_t readCount(const uint32_t& maxCount) {
+            const uint32_t count = readU32();
+            if(count > maxCount) {
+                throw std::runtime_error("Cache count out of range.");
+            }
+            return count;
+        }
+
+        // Same as above, but for things stored one after another, which
+        // cannot be more than what is left of the cache could hold.
+
+        uint32_t readItemCount(const size_t& minItemSize) {
+            const uint32_t count = readU32();
+            if(count > (size - offset) / minItemSize) {
+                throw std::runtime_error("Cache count out of range.");
+            }
+            return count;
+        }
+
+    private:
+
+        CacheReader() {};
+        CacheReader(const CacheReader&) {};
+        void operator=(const CacheReader&) {};
+
+        void checkRemaining(const size_t& length) const {
+            if(length > size - offset) {
+                throw std::runtime_error("Cache ended early.");
+            }
+        }
+
+        const char*     data;
+        size_t          size;
+        size_t          offset;
+        SharedBuffer*   textBuffer;
+
+};
+
+//=============================================================================
+// HashingStorage - Passes everything through to another storage, but hashes
+// each of the world's files as it is opened. This lets a world be hashed as
+// it is parsed, instead of reading every file again afterwards. Row files
+// may be opened on several threads at once, but each file has its own slot,
+// so nothing needs to be locked.
+//=============================================================================
+
+class HashingStorage : public WorldStorage {
+
+    public:
+
+        HashingStorage(WorldStorage& inStorage, const std::vector<std::string>& partNames) :
+                       storage(inStorage), hashes(partNames.size(), 0), hashed(partNames.size(), 0) {
+            for(size_t i = 0; i < partNames.size(); ++i) {
+                partIndices[partNames[i]] = i;
+            }
+        }
+
+        virtual bool openPart(const std::string& partName, StoragePart& outPart) const;
+
+        virtual bool getPartStamp(const std::string& partName, PartStamp& outStamp) const {
+            return storage.getPartStamp(partName, outStamp);
+        }
+
+        virtual std::string& addPart(const std::string& partName) { return storage.addPart(partName); }
+        virtual void commitParts() { storage.commitParts(); }
+        virtual void discardParts() { storage.discardParts(); }
+
+        virtual std::string getPartPath(const std::string& partName) const {
+            return storage.getPartPath(partName);
+        }
+
+        ///--------------------------------------------------------------------
+        /// getHash - Gets the hash of a file, if it has been opened.
+        /// @param index of the file in the names given to the constructor
+        /// @param (out) the hash of the file's contents
+        /// @return true if it was opened, false if not.
+        ///--------------------------------------------------------------------
+
+        bool getHash(const size_t& partIndex, uint64_t& outHash) const {
+            outHash = hashes[partIndex];
+            return hashed[partIndex] != 0;
+        }
+
+    private:
+
+        HashingStorage(const HashingStorage&);
+        HashingStorage& operator=(const HashingStorage&);
+
+        WorldStorage&                   storage;
+        std::map<std::string, size_t>   partIndices;
+        mutable std::vector<uint64_t>   hashes;
+        mutable std::vector<char>       hashed;
+
+};
+
+//=============================================================================
+// Helper Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// hashBytes - 64-bit FNV-1a hash of a block of memory, taken 8 bytes at a
+/// time so hashing a world while it is read costs little. It only has to
+/// tell if a file changed, and any change to a single word always changes
+/// the hash. Words are read in the machine's byte order, like the rest of
+/// the cache.
+/// @param pointer to the data to hash
+/// @param number of bytes to hash
+/// @return the hash
+///----------------------------------------------------------------------------
+
+static uint64_t hashBytes(const char* data, const size_t& size) {
+
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+
+    for(; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static void writeU8(std::string& buffer, const uint8_t& value) {
+    buffer.push_back(static_cast<char>(value));
+}
+
+static void writeU32(std::string& buffer, const uint32_t& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeI32(std::string& buffer, const int32_t& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeU64(std::string& buffer, const uint64_t& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeI64(std::string& buffer, const int64_t& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeString(std::string& buffer, const std::string& value) {
+    writeU32(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+// Text is written the way it is stored, so text that has not been decoded
+// yet is copied as it is rather than decoded just to be written.
+
+static void writeString(std::string& buffer, const LazyString& value) {
+    LazyString::Encoding encoding;
+    const Frost::StringToken text = value.getRawText(encoding);
+    writeU8(buffer, static_cast<uint8_t>(encoding));
+    writeU32(buffer, static_cast<uint32_t>(text.length));
+    buffer.append(text.data, text.length);
+}
+
+///----------------------------------------------------------------------------
+/// openPart - See WorldStorage. If the part is one of the world's files, its
+/// contents are hashed before it is returned.
+///----------------------------------------------------------------------------
+
+bool HashingStorage::openPart(const std::string& partName, StoragePart& outPart) const {
+
+    if(!storage.openPart(partName, outPart)) {
+        return false;
+    }
+
+    std::map<std::string, size_t>::const_iterator it = partIndices.find(partName);
+
+    if(it != partIndices.end()) {
+        hashes[it->second] = hashBytes(outPart.getData(), outPart.getSize());
+        hashed[it->second] = 1;
+    }
+
+    return true;
+
+}
+
+//=============================================================================
+// Constructors
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// Constructor
+/// @param storage the world is in. The cache is kept in it as well.
+/// @param name of the world's SG0 file
+///----------------------------------------------------------------------------
+
+GameMapCache::GameMapCache(WorldStorage& inStorage, const std::string& inFileName) :
+                           storage(inStorage), fileName(inFileName), stampsOutdated(false),
+                           updatePending(false) {
+    baseName = fileName.substr(0, fileName.length() - 4);
+    cacheName = fileName + GameMapCacheConstants::FileExtension;
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// getCachePath - Gets where the cache is kept, for messages.
+///----------------------------------------------------------------------------
+
+std::string GameMapCache::getCachePath() const {
+    return storage.getPartPath(cacheName);
+}
+
+///----------------------------------------------------------------------------
+/// load - Reads the world from the cache if it is still valid. Otherwise the
+/// world is read from its text files, hashing each one as it is read. Either
+/// way, nothing is written; call update afterwards to rewrite the cache.
+/// @param GameMap to read into. It should be newly constructed, apart from
+/// setLazyText, which is kept.
+/// @return true if the cache was used, false if the text files were read.
+/// @throws runtime_error if the text files had to be read, and could not be.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::load(GameMap& gameMap) {
+
+    pendingStamps.clear();
+    updatePending = false;
+
+    if(readMap(gameMap)) {
+
+        // If any files had to be hashed, store their new times so that the
+        // next load does not have to hash them again.
+
+        if(stampsOutdated) {
+            pendingStamps = sourceStamps;
+            updatePending = true;
+        }
+
+        return true;
+    }
+
+    // The cache may have been partially read before it was found to be bad.
+
+    const bool lazyText = gameMap.getLazyText();
+
+    gameMap = GameMap();
+    gameMap.setLazyText(lazyText);
+
+    // Stamp every file the world could use before parsing, so that if any
+    // of them change while we parse, we do not cache the wrong contents.
+
+    std::vector<std::string> sourceNames;
+    getSourceNames(sourceNames, GameMapConstants::MaxRows);
+
+    std::vector<SourceStamp> parsedStamps(sourceNames.size());
+
+    for(size_t i = 0; i < sourceNames.size(); ++i) {
+        getSourceStamp(sourceNames[i], parsedStamps[i]);
+    }
+
+    HashingStorage hashingStorage(storage, sourceNames);
+    gameMap.readMap(hashingStorage, fileName);
+
+    for(size_t i = 0; i < parsedStamps.size(); ++i) {
+        parsedStamps[i].hashed = hashingStorage.getHash(i, parsedStamps[i].contentHash);
+    }
+
+    pendingStamps.swap(parsedStamps);
+    updatePending = true;
+
+    return false;
+
+}
+
+///----------------------------------------------------------------------------
+/// update - Rewrites the cache if the last load found it missing or out of
+/// date. It is separate from load so that the world can be shown before the
+/// cache is written. Failing to write the cache is not an error.
+/// @param GameMap that was loaded. It must not have been changed since.
+/// @return true if the cache was written, false if it was not.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::update(const GameMap& gameMap) {
+
+    if(!updatePending) {
+        return false;
+    }
+
+    updatePending = false;
+    return writeMap(gameMap, pendingStamps);
+
+}
+
+///----------------------------------------------------------------------------
+/// readMap - Reads the world from the cache, if the cache exists and all of
+/// the world's files are the same as when the cache was written.
+/// @param GameMap to read into. It should be newly constructed.
+/// @return true if the map was read, false if the cache was not valid. If it
+/// is false, the map may have been partially filled in.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::readMap(GameMap& gameMap) {
+
+    sourceStamps.clear();
+    stampsOutdated = false;
+
+    StoragePart cacheFile;
+
+    if(!storage.openPart(cacheName, cacheFile)) {
+        return false;
+    }
+
+    SourceStamp cacheStamp;
+
+    if(!getSourceStamp(cacheName, cacheStamp)) {
+        return false;
+    }
+
+    try {
+
+        CacheReader reader(cacheFile.getData(), cacheFile.getSize());
+
+        char magic[sizeof(GameMapCacheLayout::Magic)];
+        reader.readBytes(magic, sizeof(magic));
+
+        if(memcmp(magic, GameMapCacheLayout::Magic, sizeof(magic)) != 0 ||
+           reader.readU32() != GameMapCacheConstants::Version ||
+           reader.readU32() != GameMapCacheLayout::ByteOrderMark) {
+            return false;
+        }
+
+        // Make sure none of the files the world was read from have changed.
+
+        const uint32_t numSources = reader.readCount(GameMapCacheLayout::NumFixedSources +
+                                                     GameMapConstants::MaxRows);
+
+        if(numSources <= GameMapCacheLayout::NumFixedSources) {
+            return false;
+        }
+
+        std::vector<std::string> sourceNames;
+        getSourceNames(sourceNames, numSources - GameMapCacheLayout::NumFixedSources);
+
+        sourceStamps.resize(numSources);
+
+        for(uint32_t i = 0; i < numSources; ++i) {
+
+            SourceStamp cachedStamp;
+            cachedStamp.exists          = reader.readU8() != 0;
+            cachedStamp.size            = reader.readU64();
+            cachedStamp.modifiedTime    = reader.readI64();
+            cachedStamp.contentHash     = reader.readU64();
+
+
+            bool wasHashed = false;
+
+            if(!isSourceUnchanged(sourceNames[i], cachedStamp, cacheStamp.modifiedTime,
+                                  sourceStamps[i], wasHashed)) {
+                return false;
+            }
+
+            stampsOutdated = stampsOutdated || wasHashed;
+        }
+
+        // It's still good, so read the world. The cache offsets are the
+        // same in a copy of it, which lazy text can keep once this closes.
+
+        if(gameMap.lazyText) {
+            reader.setTextBuffer(SharedBuffer::create(cacheFile.getData(), cacheFile.getSize()));
+        }
+
+        gameMap.numCols         = reader.readI32();
+        gameMap.numRows         = reader.readI32();
+        gameMap.lastObjectID    = reader.readI32();
+        gameMap.lastCharacterID = reader.readI32();
+
+        if(gameMap.numCols < 1 || gameMap.numRows < 1 ||
+           gameMap.numCols > static_cast<int>(GameMapConstants::MaxCols) ||
+           gameMap.numRows != static_cast<int>(numSources - GameMapCacheLayout::NumFixedSources)) {
+            return false;
+        }
+
+        GameInfo& gameInfo = gameMap.gameInfo;
+
+        reader.readString(gameInfo.gameName);
+        reader.readString(gameInfo.saveName);
+        reader.readString(gameInfo.currencyName);
+        reader.readBytes(gameInfo.baseAttributes, sizeof(gameInfo.baseAttributes));
+        reader.readBytes(gameInfo.randomAttributes, sizeof(gameInfo.randomAttributes));
+        gameInfo.playerStartX = reader.readU8();
+        gameInfo.playerStartY = reader.readU8();
+
+        reader.readString(gameMap.summary);
+        reader.readString(gameMap.story);
+
+        // Tiles are copied from an empty one, and then filled in directly
+        // as the builder's checks were all done when the world was parsed.
+
+        GameTile::Builder tileBuilder;
+        gameMap.tiles.assign(gameMap.numCols * gameMap.numRows, tileBuilder.build());
+
+        for(size_t i = 0; i < gameMap.tiles.size(); ++i) {
+
+            GameTile::Base& tileBase = gameMap.tiles[i].base;
+
+            tileBase.sprite                     = reader.readU8();
+            tileBase.flags                      = reader.readU8();
+            tileBase.drawInfo.spriteIndex       = reader.readU8();
+            tileBase.drawInfo.spriteModifier    = reader.readU8();
+            tileBase.drawInfo.dark              = reader.readU8();
+            tileBase.drawInfo.hasGate           = reader.readU8() != 0;
+            reader.readString(tileBase.name);
+            reader.readString(tileBase.description);
+
+        }
+
+        std::vector<ConnectionPoint>* connectionLists[2] = { &gameMap.jumpPoints, &gameMap.switchConnections };
+
+        for(int list = 0; list < 2; ++list) {
+
+            const uint32_t numConnections = reader.readItemCount(GameMapCacheLayout::ConnectionSize);
+            connectionLists[list]->reserve(numConnections);
+
+            for(uint32_t i = 0; i < numConnections; ++i) {
+                const int x1 = reader.readI32();
+                const int y1 = reader.readI32();
+                const int x2 = reader.readI32();
+                const int y2 = reader.readI32();
+                connectionLists[list]->push_back(ConnectionPoint(SimplePoint(x1, y1), SimplePoint(x2, y2)));
+            }
+        }
+
+        const uint32_t numObjects = reader.readItemCount(GameMapCacheLayout::MinObjectSize);
+        GameObject::Builder objectBuilder;
+        gameMap.gameObjects.assign(numObjects, objectBuilder.build());
+
+        for(uint32_t i = 0; i < numObjects; ++i) {
+
+            GameObject::Base& objectBase = gameMap.gameObjects[i].base;
+
+            for(unsigned int k = 0; k < AttributeTypes::NumTypes; ++k) {
+                objectBase.attributeBase[k]     = reader.readI32();
+                objectBase.attributeRandom[k]   = reader.readI32();
+            }
+
+            for(int k = 0; k < GameObjectDescriptions::NumAllDescriptions; ++k) {
+                reader.readString(objectBase.description[k]);
+            }
+
+            objectBase.doorColumn       = reader.readI32();
+            objectBase.doorRow          = reader.readI32();
+            objectBase.flags1           = reader.readU8();
+            objectBase.flags2           = reader.readU8();
+            objectBase.ID               = reader.readI32();
+            reader.readString(objectBase.location);
+            objectBase.makesSight       = reader.readI32();
+            objectBase.makesHearing     = reader.readI32();
+            objectBase.monetaryWorth    = reader.readI32();
+            objectBase.uses             = reader.readI32();
+            objectBase.usedWithID       = reader.readI32();
+            objectBase.creatureID       = reader.readI32();
+            objectBase.isLocated        = reader.readI32();
+            objectBase.x                = reader.readI32();
+            objectBase.y                = reader.readI32();
+
+        }
+
+        const uint32_t numCharacters = reader.readItemCount(GameMapCacheLayout::MinCharacterSize);
+        GameCharacter::Builder characterBuilder;
+        gameMap.gameCharacters.assign(numCharacters, characterBuilder.build());
+
+        for(uint32_t i = 0; i < numCharacters; ++i) {
+
+            GameCharacter::Base& characterBase = gameMap.gameCharacters[i].base;
+
+            for(unsigned int k = 0; k < AttributeTypes::NumTypesForCharacters; ++k) {
+                characterBase.attribute[k] = reader.readI32();
+            }
+
+            for(int k = 0; k < GameCharacterDescriptions::NumAllDescriptions; ++k) {
+                reader.readString(characterBase.description[k]);
+            }
+
+            characterBase.flags     = reader.readU8();
+            characterBase.ID        = reader.readI32();
+            reader.readString(characterBase.location);
+            characterBase.money     = reader.readI32();
+            characterBase.sight     = reader.readI32();
+            characterBase.type      = reader.readI32();
+            characterBase.unused    = reader.readI32();
+            characterBase.x         = reader.readI32();
+            characterBase.y         = reader.readI32();
+
+        }
+
+        char endMagic[sizeof(GameMapCacheLayout::EndMagic)];
+        reader.readBytes(endMagic, sizeof(endMagic));
+
+        if(memcmp(endMagic, GameMapCacheLayout::EndMagic, sizeof(endMagic)) != 0 || !reader.atEnd()) {
+            return false;
+        }
+
+    }
+    catch (const std::runtime_error&) {
+        return false;
+    }
+
+    gameMap.rebuildIndices();
+    gameMap.clearDirty(storage.getPartPath(baseName));
+
+    return true;
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// writeMap - Writes the cache for a world that was just read. The cache is
+/// not written if any of the files changed since they were stamped.
+/// @param GameMap that was read
+/// @param stamps of each possible source file, taken before the world was
+/// read, with the hashes of the files that were read.
+/// @return true if the cache was written, false if it was not.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::writeMap(const GameMap& gameMap, const std::vector<SourceStamp>& stamps) {
+
+    std::vector<std::string> sourceNames;
+    getSourceNames(sourceNames, gameMap.numRows);
+
+    if(sourceNames.size() > stamps.size()) {
+        return false;
+    }
+
+    // The cache is about as big as the files it was read from, so growing
+    // the buffer as it is written would copy it several times over.
+
+    uint64_t sourceSize = 0;
+
+    for(size_t i = 0; i < sourceNames.size(); ++i) {
+        sourceSize += stamps[i].exists ? stamps[i].size : 0;
+    }
+
+    std::string cacheBuffer;
+    cacheBuffer.reserve(4096 + gameMap.tiles.size() * 16 + static_cast<size_t>(sourceSize));
+
+    cacheBuffer.append(GameMapCacheLayout::Magic, sizeof(GameMapCacheLayout::Magic));
+    writeU32(cacheBuffer, GameMapCacheConstants::Version);
+    writeU32(cacheBuffer, GameMapCacheLayout::ByteOrderMark);
+    writeU32(cacheBuffer, static_cast<uint32_t>(sourceNames.size()));
+
+    for(size_t i = 0; i < sourceNames.size(); ++i) {
+
+        SourceStamp stamp = stamps[i];
+        SourceStamp currentStamp;
+
+        if(getSourceStamp(sourceNames[i], currentStamp) != stamp.exists) {
+            return false;
+        }
+
+        if(stamp.exists) {
+
+            // The hash is of what was read, so it only needs the file to
+            // still be the same as when it was stamped. Files the world
+            // was not read from are hashed now.
+
+            if(currentStamp.size != stamp.size || currentStamp.modifiedTime != stamp.modifiedTime ||
+               (!stamp.hashed && !hashPart(sourceNames[i], stamp.contentHash))) {
+                return false;
+            }
+
+        }
+
+        writeU8(cacheBuffer, stamp.exists ? 1 : 0);
+        writeU64(cacheBuffer, stamp.exists ? stamp.size : 0);
+        writeI64(cacheBuffer, stamp.exists ? stamp.modifiedTime : 0);
+        writeU64(cacheBuffer, stamp.contentHash);
+
+    }
+
+    writeI32(cacheBuffer, gameMap.numCols);
+    writeI32(cacheBuffer, gameMap.numRows);
+    writeI32(cacheBuffer, gameMap.lastObjectID);
+    writeI32(cacheBuffer, gameMap.lastCharacterID);
+
+    const GameInfo& gameInfo = gameMap.gameInfo;
+
+    writeString(cacheBuffer, gameInfo.gameName);
+    writeString(cacheBuffer, gameInfo.saveName);
+    writeString(cacheBuffer, gameInfo.currencyName);
+    cacheBuffer.append(reinterpret_cast<const char*>(gameInfo.baseAttributes), sizeof(gameInfo.baseAttributes));
+    cacheBuffer.append(reinterpret_cast<const char*>(gameInfo.randomAttributes), sizeof(gameInfo.randomAttributes));
+    writeU8(cacheBuffer, gameInfo.playerStartX);
+    writeU8(cacheBuffer, gameInfo.playerStartY);
+
+    writeString(cacheBuffer, gameMap.summary);
+    writeString(cacheBuffer, gameMap.story);
+
+    for(size_t i = 0; i < gameMap.tiles.size(); ++i) {
+
+        const GameTile::Base& tileBase = gameMap.tiles[i].base;
+
+        writeU8(cacheBuffer, tileBase.sprite);
+        writeU8(cacheBuffer, tileBase.flags);
+        writeU8(cacheBuffer, tileBase.drawInfo.spriteIndex);
+        writeU8(cacheBuffer, tileBase.drawInfo.spriteModifier);
+        writeU8(cacheBuffer, tileBase.drawInfo.dark);
+        writeU8(cacheBuffer, tileBase.drawInfo.hasGate ? 1 : 0);
+        writeString(cacheBuffer, tileBase.name);
+        writeString(cacheBuffer, tileBase.description);
+
+    }
+
+    const std::vector<ConnectionPoint>* connectionLists[2] = { &gameMap.jumpPoints, &gameMap.switchConnections };
+
+    for(int list = 0; list < 2; ++list) {
+
+        const std::vector<ConnectionPoint>& connections = *connectionLists[list];
+        writeU32(cacheBuffer, static_cast<uint32_t>(connections.size()));
+
+        for(size_t i = 0; i < connections.size(); ++i) {
+            writeI32(cacheBuffer, connections[i].getConnectPoint1().getX());
+            writeI32(cacheBuffer, connections[i].getConnectPoint1().getY());
+            writeI32(cacheBuffer, connections[i].getConnectPoint2().getX());
+            writeI32(cacheBuffer, connections[i].getConnectPoint2().getY());
+        }
+    }
+
+    writeU32(cacheBuffer, static_cast<uint32_t>(gameMap.gameObjects.size()));
+
+    for(size_t i = 0; i < gameMap.gameObjects.size(); ++i) {
+
+        const GameObject::Base& objectBase = gameMap.gameObjects[i].base;
+
+        for(unsigned int k = 0; k < AttributeTypes::NumTypes; ++k) {
+            writeI32(cacheBuffer, objectBase.attributeBase[k]);
+            writeI32(cacheBuffer, objectBase.attributeRandom[k]);
+        }
+
+        for(int k = 0; k < GameObjectDescriptions::NumAllDescriptions; ++k) {
+            writeString(cacheBuffer, objectBase.description[k]);
+        }
+
+        writeI32(cacheBuffer, objectBase.doorColumn);
+        writeI32(cacheBuffer, objectBase.doorRow);
+        writeU8(cacheBuffer, objectBase.flags1);
+        writeU8(cacheBuffer, objectBase.flags2);
+        writeI32(cacheBuffer, objectBase.ID);
+        writeString(cacheBuffer, objectBase.location);
+        writeI32(cacheBuffer, objectBase.makesSight);
+        writeI32(cacheBuffer, objectBase.makesHearing);
+        writeI32(cacheBuffer, objectBase.monetaryWorth);
+        writeI32(cacheBuffer, objectBase.uses);
+        writeI32(cacheBuffer, objectBase.usedWithID);
+        writeI32(cacheBuffer, objectBase.creatureID);
+        writeI32(cacheBuffer, objectBase.isLocated);
+        writeI32(cacheBuffer, objectBase.x);
+        writeI32(cacheBuffer, objectBase.y);
+
+    }
+
+    writeU32(cacheBuffer, static_cast<uint32_t>(gameMap.gameCharacters.size()));
+
+    for(size_t i = 0; i < gameMap.gameCharacters.size(); ++i) {
+
+        const GameCharacter::Base& characterBase = gameMap.gameCharacters[i].base;
+
+        for(unsigned int k = 0; k < AttributeTypes::NumTypesForCharacters; ++k) {
+            writeI32(cacheBuffer, characterBase.attribute[k]);
+        }
+
+        for(int k = 0; k < GameCharacterDescriptions::NumAllDescriptions; ++k) {
+            writeString(cacheBuffer, characterBase.description[k]);
+        }
+
+        writeU8(cacheBuffer, characterBase.flags);
+        writeI32(cacheBuffer, characterBase.ID);
+        writeString(cacheBuffer, characterBase.location);
+        writeI32(cacheBuffer, characterBase.money);
+        writeI32(cacheBuffer, characterBase.sight);
+        writeI32(cacheBuffer, characterBase.type);
+        writeI32(cacheBuffer, characterBase.unused);
+        writeI32(cacheBuffer, characterBase.x);
+        writeI32(cacheBuffer, characterBase.y);
+
+    }
+
+    cacheBuffer.append(GameMapCacheLayout::EndMagic, sizeof(GameMapCacheLayout::EndMagic));
+
+    try {
+        storage.addPart(cacheName).swap(cacheBuffer);
+        storage.commitParts();
+    }
+    catch (const std::runtime_error&) {
+        return false;
+    }
+
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// getSourceNames - Get the names of each part a world is read from, in the
+/// order the cache stores them.
+/// @param (out) vector to store the names in
+/// @param number of rows in the world
+///----------------------------------------------------------------------------
+
+void GameMapCache::getSourceNames(std::vector<std::string>& outNames, const int& numRows) const {
+
+    outNames.clear();
+    outNames.reserve(GameMapCacheLayout::NumFixedSources + numRows);
+
+    outNames.push_back(fileName);
+    outNames.push_back(baseName + ".STY");
+
+    std::string rowFileName = baseName + ".T00";
+    const size_t rowDigitPos = rowFileName.length() - 2;
+
+    for(int row = 0; row < numRows; ++row) {
+        rowFileName[rowDigitPos] = static_cast<char>('0' + (row / 10));
+        rowFileName[rowDigitPos + 1] = static_cast<char>('0' + (row % 10));
+        outNames.push_back(rowFileName);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// isSourceUnchanged - Checks if a source file is the same as when the cache
+/// was written. If the size and time match, the file's contents are assumed
+/// to be the same, unless it was changed right around when the cache was
+/// written. If only the time differs, the contents are hashed to check.
+/// @param name of the source file's part
+/// @param stamp the cache has for the file
+/// @param when the cache was written, in nanoseconds since 1970
+/// @param (out) the file's current stamp, with the cached hash
+/// @param (out) true if the file's contents had to be hashed
+/// @return true if the file is unchanged, false if it changed.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::isSourceUnchanged(const std::string& sourceName, const SourceStamp& cachedStamp,
+                                     const int64_t& cacheModifiedTime, SourceStamp& outStamp,
+                                     bool& outWasHashed) const {
+
+    SourceStamp& stamp = outStamp;
+    const bool exists = getSourceStamp(sourceName, stamp);
+    stamp.contentHash = cachedStamp.contentHash;
+    stamp.hashed = true;
+    outWasHashed = false;
+
+    if(exists != cachedStamp.exists) {
+        return false;
+    }
+
+    if(!exists) {
+        return true;
+    }
+
+    if(stamp.size != cachedStamp.size) {
+        return false;
+    }
+
+    if(stamp.modifiedTime == cachedStamp.modifiedTime &&
+       stamp.modifiedTime < cacheModifiedTime - GameMapCacheConstants::RacyWindow) {
+        return true;
+    }
+
+    uint64_t contentHash;
+    outWasHashed = true;
+
+    if(!hashPart(sourceName, contentHash)) {
+        return false;
+    }
+
+    return contentHash == cachedStamp.contentHash;
+
+}
+
+///----------------------------------------------------------------------------
+/// getSourceStamp - Get the size and modified time of a part.
+/// @param name of the part
+/// @param (out) stamp to store the size and time in
+/// @return true if the part exists, false if it does not.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::getSourceStamp(const std::string& partName, SourceStamp& outStamp) const {
+
+    PartStamp partStamp;
+
+    outStamp.exists         = storage.getPartStamp(partName, partStamp);
+    outStamp.size           = partStamp.size;
+    outStamp.modifiedTime   = partStamp.modifiedTime;
+    outStamp.contentHash    = 0;
+    outStamp.hashed         = false;
+
+    return outStamp.exists;
+
+}
+
+///----------------------------------------------------------------------------
+/// hashPart - Hash the contents of a part.
+/// @param name of the part
+/// @param (out) the hash of the part's contents
+/// @return true if the part was hashed, false if it could not be read.
+///----------------------------------------------------------------------------
+
+bool GameMapCache::hashPart(const std::string& partName, uint64_t& outHash) const {
+
+    StoragePart sourcePart;
+
+    if(!storage.openPart(partName, sourcePart)) {
+        return false;
+    }
+
+    outHash = hashBytes(sourcePart.getData(), sourcePart.getSize());
+    return true;
+
+}
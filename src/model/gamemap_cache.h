@@ -0,0 +1,93 @@
+#ifndef __GAMEMAP_CACHE_H__
+#define __GAMEMAP_CACHE_H__
+
+#include <string>
+#include <vector>
+#include "../compat/stdint_compat.h"
+
+class GameMap;
+class WorldStorage;
+
+//-----------------------------------------------------------------------------
+// GameMapCacheConstants
+//-----------------------------------------------------------------------------
+
+namespace GameMapCacheConstants {
+
+    // Added to the end of the SG0 file's name, so "WORLD.SG0.cache"
+    const std::string FileExtension = ".cache";
+
+    // Bump this whenever the layout of the cache changes. Caches with any
+    // other version are ignored and rewritten.
+    const uint32_t Version          = 2;
+
+    // Files changed this close to when the cache was written may have
+    // changed again without their modified time changing, so their
+    // contents are always checked. 2 seconds covers FAT file systems.
+    const int64_t RacyWindow        = 2000000000LL;
+}
+
+///----------------------------------------------------------------------------
+/// GameMapCache - Keeps a binary copy of a fully parsed world in the same
+/// storage as its SG0 file, so that reopening a world that has not changed is a single read
+/// instead of parsing the SG0, STY and every TXX file. The cache records the
+/// size, modified time and a hash of each source file. If the size or time
+/// of any of them differ, or the cache is missing, damaged or from another
+/// version, the world is parsed from the text files instead. Call update
+/// once the world is loaded to rewrite the cache. As it adds a file to the
+/// world's storage, callers should only use it if the user asked for it.
+///----------------------------------------------------------------------------
+
+class GameMapCache {
+
+    public:
+
+        GameMapCache(WorldStorage& inStorage, const std::string& inFileName);
+
+        bool load(GameMap& gameMap);
+        bool readMap(GameMap& gameMap);
+        bool update(const GameMap& gameMap);
+
+        bool isUpdatePending() const { return updatePending; }
+
+        std::string getCachePath() const;
+
+    private:
+
+        // What a source file looked like when the cache was written.
+        struct SourceStamp {
+            bool        exists;
+            uint64_t    size;
+            int64_t     modifiedTime;   // Nanoseconds since 1970
+            uint64_t    contentHash;
+            bool        hashed;         // If contentHash is known.
+        };
+
+        GameMapCache(const GameMapCache&);
+        GameMapCache& operator=(const GameMapCache&);
+
+        bool writeMap(const GameMap& gameMap, const std::vector<SourceStamp>& stamps);
+        void getSourceNames(std::vector<std::string>& outNames, const int& numRows) const;
+        bool isSourceUnchanged(const std::string& sourceName, const SourceStamp& cachedStamp,
+                               const int64_t& cacheModifiedTime, SourceStamp& outStamp,
+                               bool& outWasHashed) const;
+
+        bool getSourceStamp(const std::string& partName, SourceStamp& outStamp) const;
+        bool hashPart(const std::string& partName, uint64_t& outHash) const;
+
+        WorldStorage&   storage;
+        std::string     fileName;
+        std::string     baseName;
+        std::string     cacheName;
+
+        // Current stamps of the source files, as of the last readMap.
+        std::vector<SourceStamp>    sourceStamps;
+        bool                        stampsOutdated;
+
+        // What update should write, as of the last load.
+        std::vector<SourceStamp>    pendingStamps;
+        bool                        updatePending;
+
+};
+
+#endif // __GAMEMAP_CACHE_H__
@@ -0,0 +1,50 @@
+#ifndef __GAMEMAP_SCAN_H__
+#define __GAMEMAP_SCAN_H__
+
+#include <vector>
+#include "connection_point.h"
+#include "../compat/stdint_compat.h"
+
+///----------------------------------------------------------------------------
+/// GameMapScan - The layout of a world, as read by GameMap::scanMap: its
+/// size, the sprite and flags of every tile, and the jumps and switches
+/// between them. Nothing else in the world is read. Reusing one scan for many
+/// worlds reuses its memory too.
+///----------------------------------------------------------------------------
+
+class GameMapScan {
+
+    public:
+
+        GameMapScan() : numCols(0), numRows(0) {}
+
+        const int& getWidth() const { return numCols; }
+        const int& getHeight() const { return numRows; }
+
+        // Sprites and flags are as written in the world file, one per tile
+        // in row order. TileFlags::MoreInfo is not checked against the row
+        // descriptions, as those are never read.
+
+        const std::vector<uint8_t>& getSprites() const { return sprites; }
+        const std::vector<uint8_t>& getFlags() const { return flags; }
+        const uint8_t& getSprite(const int& row, const int& col) const { return sprites[row * numCols + col]; }
+        const uint8_t& getFlags(const int& row, const int& col) const { return flags[row * numCols + col]; }
+
+        const std::vector<ConnectionPoint>& getJumpPoints() const { return jumpPoints; }
+        const std::vector<ConnectionPoint>& getSwitchConnections() const { return switchConnections; }
+
+    private:
+
+        // Filled in directly by the map.
+        friend class GameMap;
+
+        int                             numCols;
+        int                             numRows;
+        std::vector<uint8_t>            sprites;
+        std::vector<uint8_t>            flags;
+        std::vector<ConnectionPoint>    jumpPoints;
+        std::vector<ConnectionPoint>    switchConnections;
+
+};
+
+#endif // __GAMEMAP_SCAN_H__
@@ -2,116 +2,123 @@
 #include "../util/frost.h"
 #include "../editor_constants.h"
 #include "../compat/std_extras_compat.h"
+#include "worldfile_reader.h"
+#include <cstring>
 
-void GameObject::Builder::readObject(std::ifstream& mapFile) {
-    
-    std::string line;
-    Frost::getLineWindows(mapFile, line);
-    ID(std::stoi(line));
+///----------------------------------------------------------------------------
+/// readObject - Reads an object from a buffer. Only the descriptions are
+/// allocated, everything else is parsed in place.
+/// @param reader positioned at the start of the object
+/// @throws runtime_error if the object could not be read.
+///----------------------------------------------------------------------------
+
+void GameObject::Builder::readObject(WorldFileReader& reader) {
+
+    ID(reader.readInteger());
 
     for(int i = 0; i < GameObjectDescriptions::NumDescriptions; ++i) {
-        Frost::getVBString(mapFile, line);
-        description(line, i);
+        reader.readQuotedLine(base.description[i]);
     }
 
-    Frost::getLineWindows(mapFile, line);
-    doorColumn(std::stoi(line));
+    doorColumn(reader.readInteger());
+    doorRow(reader.readInteger());
+    flags1(reader.readInteger());
+    flags2(reader.readInteger());
+    monetaryWorth(reader.readInteger());
+    uses(reader.readInteger());
 
-    Frost::getLineWindows(mapFile, line);
-    doorRow(std::stoi(line));
+    // Location is either "X,Y", "ID, Creature" or "Me".
 
-    Frost::getLineWindows(mapFile, line);
-    flags1(std::stoi(line));
+    const char* locStart;
+    size_t locLength;
+    reader.readQuotedLine(locStart, locLength);
 
-    Frost::getLineWindows(mapFile, line);
-    flags2(std::stoi(line));
+    const char* comma = static_cast<const char*>(memchr(locStart, ',', locLength));
 
-    Frost::getLineWindows(mapFile, line);
-    monetaryWorth(std::stoi(line));
+    if(comma != NULL) {
 
-    Frost::getLineWindows(mapFile, line);
-    uses(std::stoi(line));
+        const size_t firstLength = static_cast<size_t>(comma - locStart);
+        const char* secondStart = comma + 1;
+        const size_t secondLength = locLength - firstLength - 1;
+        const size_t creatureLength = GameObjectConstants::OnCharacterString.length();
 
-    Frost::getVBString(mapFile, line);
-
-    std::vector<std::string> tokens = Frost::split(line, ',');
+        if(secondLength == 0 || memchr(secondStart, ',', secondLength) != NULL) {
+            throw std::runtime_error("Too many tokens for location type" + reader.positionString() + ".");
+        }
 
-    if(tokens.size() == 2) {
-        if(Frost::endsWith(tokens[1], GameObjectConstants::OnCharacterString)) {
-            location(std::stoi(tokens[0]));
+        if(secondLength >= creatureLength &&
+           !memcmp(secondStart + secondLength - creatureLength, GameObjectConstants::OnCharacterString.c_str(), creatureLength)) {
+            location(reader.parseInteger(locStart, firstLength));
         }
         else {
-            location(std::stoi(tokens[0]), std::stoi(tokens[1]));
+            location(reader.parseInteger(locStart, firstLength), reader.parseInteger(secondStart, secondLength));
         }
+
     }
-    else if(tokens.size() == 1) {
-        if(Frost::startsWith(tokens[0], GameObjectConstants::OnPlayerString)) {
-            location(); 
+    else {
+
+        const size_t playerLength = GameObjectConstants::OnPlayerString.length();
+
+        if(locLength >= playerLength && !memcmp(locStart, GameObjectConstants::OnPlayerString.c_str(), playerLength)) {
+            location();
         }
         else {
-            throw std::invalid_argument("Tried to read invalid location type");
+            throw std::runtime_error("Tried to read invalid location type" + reader.positionString() + ".");
         }
-    }
-    else {
-        throw std::invalid_argument("Too many tokens for location type");
-    }
 
-    for(int i = 0; i < AttributeTypes::NumTypes; i++) {
-        Frost::getLineWindows(mapFile, line);
-        attributeBase(std::stoi(line), i);
+    }
 
-        Frost::getLineWindows(mapFile, line);
-        attributeRandom(std::stoi(line), i);
+    for(unsigned int i = 0; i < AttributeTypes::NumTypes; i++) {
+        attributeBase(reader.readInteger(), i);
+        attributeRandom(reader.readInteger(), i);
     }
 
-    Frost::getLineWindows(mapFile, line);
-    makesSight(std::stoi(line));
+    makesSight(reader.readInteger());
+    makesHearing(reader.readInteger());
 
-    Frost::getLineWindows(mapFile, line);
-    makesHearing(std::stoi(line));
+    reader.readLine(base.description[GameObjectDescriptions::Icon]);
+    reader.readLine(base.description[GameObjectDescriptions::Sound]);
 
-    Frost::getLineWindows(mapFile, line);
-    description(line, 4);
+    usedWithID(reader.readInteger());
 
-    Frost::getLineWindows(mapFile, line);
-    description(line, 5);
+}
 
-    Frost::getLineWindows(mapFile, line);
-    usedWithID(std::stoi(line));
+void GameObject::writeObject(std::string& mapBuffer) const {
 
-}
+    // Descriptions are written without being kept decoded, so saving a
+    // world opened with lazy text does not decode all of it.
 
-void GameObject::writeObject(std::ofstream& mapFile) const {
+    std::string scratch;
 
-    Frost::writeVBInteger(mapFile, base.ID);
+    Frost::writeVBInteger(mapBuffer, base.ID);
 
     for (int i = 0; i < GameObjectDescriptions::NumDescriptions; ++i) {
-        Frost::writeVBString(mapFile, base.description[i]);
+        Frost::writeVBString(mapBuffer, base.description[i].getText(scratch));
     }
 
-    Frost::writeVBInteger(mapFile, base.doorColumn);
-    Frost::writeVBInteger(mapFile, base.doorRow);
-    Frost::writeVBInteger(mapFile, base.flags1);
-    Frost::writeVBInteger(mapFile, base.flags2);
-    Frost::writeVBInteger(mapFile, base.monetaryWorth);
-    Frost::writeVBInteger(mapFile, base.uses);
+    Frost::writeVBInteger(mapBuffer, base.doorColumn);
+    Frost::writeVBInteger(mapBuffer, base.doorRow);
+    Frost::writeVBInteger(mapBuffer, base.flags1);
+    Frost::writeVBInteger(mapBuffer, base.flags2);
+    Frost::writeVBInteger(mapBuffer, base.monetaryWorth);
+    Frost::writeVBInteger(mapBuffer, base.uses);
 
-    Frost::writeVBString(mapFile, base.location);
+    Frost::writeVBString(mapBuffer, base.location);
 
     for (int k = 0; k < AttributeTypes::NumTypes; ++k) {
-        Frost::writeVBInteger(mapFile, base.attributeBase[k]);
-        Frost::writeVBInteger(mapFile, base.attributeRandom[k]);
+        Frost::writeVBInteger(mapBuffer, base.attributeBase[k]);
+        Frost::writeVBInteger(mapBuffer, base.attributeRandom[k]);
     }
 
-    Frost::writeVBInteger(mapFile, base.makesSight);
-    Frost::writeVBInteger(mapFile, base.makesHearing);
+    Frost::writeVBInteger(mapBuffer, base.makesSight);
+    Frost::writeVBInteger(mapBuffer, base.makesHearing);
 
-    Frost::writeVBLine(mapFile,
-                       base.description[GameObjectDescriptions::Icon]);
+    Frost::writeVBLine(mapBuffer,
+                       base.description[GameObjectDescriptions::Icon].getText(scratch));
 
-    Frost::writeVBLine(mapFile,
-                       base.description[GameObjectDescriptions::Sound]);
+    Frost::writeVBLine(mapBuffer,
+                       base.description[GameObjectDescriptions::Sound].getText(scratch));
 
-    Frost::writeVBInteger(mapFile, base.usedWithID);
+    Frost::writeVBInteger(mapBuffer, base.usedWithID);
 
 }
\ No newline at end of file
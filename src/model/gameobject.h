@@ -9,8 +9,11 @@
 #include "../util/frost.h"
 #include "../compat/stdint_compat.h"
 #include "../compat/std_extras_compat.h"
+#include "lazystring.h"
 #include "../adventuregamer_constants.h"
 
+class WorldFileReader;
+
 //-----------------------------------------------------------------------------
 // GameObjectConstants - Exactly what it says
 //-----------------------------------------------------------------------------
@@ -112,7 +115,7 @@ class GameObject {
         struct Base {
             int             attributeBase[AttributeTypes::NumTypes];
             int             attributeRandom[AttributeTypes::NumTypes];
-            std::string     description[GameObjectDescriptions::NumAllDescriptions];
+            LazyString      description[GameObjectDescriptions::NumAllDescriptions];
             int             doorColumn;
             int             doorRow;
             uint8_t         flags1;
@@ -340,7 +343,7 @@ class GameObject {
                     return *this;
                 }
 
-                void readObject(std::ifstream& mapFile);
+                void readObject(WorldFileReader& reader);
 
                 GameObject build() {
                     // TOOD: Any additional error checking that must occur, we may also
@@ -400,7 +403,7 @@ class GameObject {
 
     public:
 
-        const std::string& getName() const { return base.description[0];}
+        const std::string& getName() const { return base.description[0].get(); }
         const int& getCreatureID() const { return base.creatureID; }
         const int& getID() const { return base.ID; }
         const int& getUsedWithID() const { return base.usedWithID; }
@@ -424,12 +427,15 @@ class GameObject {
             return base.attributeRandom[which];
         }
 
-        const std::string& getDescription(const unsigned int which) const { return base.description[which]; }
+        const std::string& getDescription(const unsigned int which) const { return base.description[which].get(); }
 
-        void writeObject(std::ofstream& mapFile) const;
+        void writeObject(std::string& mapBuffer) const;
 
     private:
 
+        // Written and read directly by the world cache.
+        friend class GameMapCache;
+
         GameObject(Builder& builder) {
 
             for(int i = 0; i < AttributeTypes::NumTypes; ++i) {
@@ -1,39 +1,33 @@
 #include "gametile.h"
 #include "../compat/std_extras_compat.h"
 #include "../util/frost.h"
+#include "worldfile_reader.h"
 
 //=============================================================================
 // GameTile::Builder
 //=============================================================================
 
 ///----------------------------------------------------------------------------
-/// readTile - Reads a single tile from the map file, and it will also give
-/// the tile a long description if it's specified.
-/// @param mapFile an ifstream of the map file to be read from
-/// @param string containing the long description of the tile.
+/// readTile - Reads a tile's sprite, flags and name from a world file that
+/// is in memory. Only the tile's name is allocated, and not even that if the
+/// reader has a text buffer.
+/// @param reader positioned at the start of the tile
+/// @param the long description of the tile, which may not be decoded yet.
+/// @throws runtime_error if the tile could not be read.
 ///----------------------------------------------------------------------------
 
-void GameTile::Builder::readTile(std::ifstream& mapFile, const std::string& tileDescription) {
-    
+void GameTile::Builder::readTile(WorldFileReader& reader, const LazyString& tileDescription) {
+
     if(!tileDescription.empty()) {
         description(tileDescription);
     }
 
-    //try {
-
-        std::string line;
-        std::getline(mapFile, line);
-        sprite(std::stoi(line));
+    sprite(reader.readInteger());
+    flags(reader.readInteger());
 
-        std::getline(mapFile, line);
-        flags(std::stoi(line));
-
-        if(base.sprite != 0) {
-            Frost::getLineWindows(mapFile, line);
-            name(line);
-        }
-
-    //}
+    if(base.sprite != 0) {
+        reader.readLine(base.name);
+    }
 
 }
 
@@ -61,7 +55,7 @@ const GameTile::DrawInfo GameTile::getDrawInfo() const {
 ///----------------------------------------------------------------------------
 
 const std::string& GameTile::getDescription() const {
-    return base.description;
+    return base.description.get();
 }
 
 ///----------------------------------------------------------------------------
@@ -79,7 +73,19 @@ const uint8_t& GameTile::getFlags() const {
 ///----------------------------------------------------------------------------
 
 const std::string& GameTile::getName() const {
-    return base.name;
+    return base.name.get();
+}
+
+///----------------------------------------------------------------------------
+/// getStoredNameLength - Gets the length of the tile's name without decoding
+/// it, for working out how much space writing it will take.
+/// @return the length of the name as it is stored, which may be a little
+/// longer than the decoded name if it has not been decoded yet.
+///----------------------------------------------------------------------------
+
+const size_t GameTile::getStoredNameLength() const {
+    LazyString::Encoding encoding;
+    return base.name.getRawText(encoding).length;
 }
 
 ///----------------------------------------------------------------------------
@@ -288,6 +294,16 @@ const bool GameTile::isVerticalStraightaway() const {
     return base.drawInfo.spriteIndex == RoadTypes::StraightawayVertical ? true : false;
 }
 
+///----------------------------------------------------------------------------
+/// hasDescription - Checks if the tile has a long description, without
+/// decoding it.
+/// @return true if it does, false if it does not.
+///----------------------------------------------------------------------------
+
+const bool GameTile::hasDescription() const {
+    return !base.description.empty();
+}
+
 ///----------------------------------------------------------------------------
 /// hasAnyFeature - Checks if a tile has any features applied to it.
 /// @return true if it does, false if it does not.
@@ -359,14 +375,26 @@ const bool GameTile::hasSwitch() const {
 
 ///----------------------------------------------------------------------------
 /// write - writes the tile to the output file given
-/// @param mapFile an ofstream of the map file to be written to
+/// @param mapBuffer buffer the map file is being built in
 ///----------------------------------------------------------------------------
 
-const void GameTile::write(std::ofstream& mapFile) const {
+const void GameTile::write(std::string& mapBuffer) const {
 
-    Frost::writeVBInteger(mapFile, base.sprite);
-    Frost::writeVBInteger(mapFile, base.flags);
+    Frost::writeVBInteger(mapBuffer, base.sprite);
+    Frost::writeVBInteger(mapBuffer, base.flags);
     if (base.sprite != 0) {
-        Frost::writeVBLine(mapFile, base.name);
+        std::string scratch;
+        Frost::writeVBLine(mapBuffer, base.name.getText(scratch));
     }
+}
+
+///----------------------------------------------------------------------------
+/// writeDescription - writes the tile's long description to the row file
+/// given. Text that has not been decoded yet is not kept decoded.
+/// @param rowBuffer buffer the row's description file is being built in
+/// @param scratch string the description may be decoded into
+///----------------------------------------------------------------------------
+
+const void GameTile::writeDescription(std::string& rowBuffer, std::string& scratch) const {
+    Frost::writeVBString(rowBuffer, base.description.getText(scratch));
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <stdexcept>
 #include <fstream>
 #include "../compat/stdint_compat.h"
+#include "lazystring.h"
+
+class WorldFileReader;
 
 //-----------------------------------------------------------------------------
 // RoadTypes - What each of the 16 values means
@@ -113,8 +116,8 @@ class GameTile {
             public:
                 uint8_t         sprite; // The value is Index + Modifier, this is the raw value saved to file.
                 uint8_t         flags;
-                std::string     name;
-                std::string     description;
+                LazyString      name;
+                LazyString      description;
 
                 // Cached Information
                 DrawInfo        drawInfo;
@@ -222,11 +225,22 @@ class GameTile {
                     return *this;
                 }
 
+                Builder& description(const LazyString& description) {
+                    base.description = description;
+                    if(!description.empty()) {
+                        base.flags |= TileFlags::MoreInfo;
+                    }
+                    else if(base.flags & TileFlags::MoreInfo) {
+                        base.flags &= ~TileFlags::MoreInfo;
+                    }
+                    return *this;
+                }
+
                 static const uint8_t calculateSprite(const uint8_t& index, const uint8_t& modifer) {
                     return index + (modifer << 4);
                 }
 
-                void readTile(std::ifstream& mapFile, const std::string& tileDescription);
+                void readTile(WorldFileReader& reader, const LazyString& tileDescription);
 
                 bool isModiferValid() const {
 
@@ -320,12 +334,14 @@ class GameTile {
         const uint8_t&          getSpriteModifier() const;
         const uint8_t&          getFlags() const;
         const std::string&      getName() const;  
+        const size_t            getStoredNameLength() const;
         const DrawInfo          getDrawInfo() const;
 
         // Information Functions
         
         const bool hasConnectionFeature() const;
         const bool hasAnyFeature() const;
+        const bool hasDescription() const;
         const bool hasJumpPad() const;
         const bool hasGate() const;
         const bool hasOnSwitch() const;
@@ -349,10 +365,14 @@ class GameTile {
 
         // IO Functions
 
-        const void write(std::ofstream& mapFile) const;
+        const void write(std::string& mapBuffer) const;
+        const void writeDescription(std::string& rowBuffer, std::string& scratch) const;
 
     private:
 
+        // Written and read directly by the world cache.
+        friend class GameMapCache;
+
         GameTile(Builder& builder) {
             base.name                    = builder.base.name;
             base.flags                   = builder.base.flags;
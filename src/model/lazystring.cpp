@@ -0,0 +1,215 @@
+#include "lazystring.h"
+#include <utility>
+#include "worldfile_reader.h"
+#include "../util/sharedbuffer.h"
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+LazyString::LazyString(const LazyString& other) : value(other.value), buffer(other.buffer),
+                                                  offset(other.offset), length(other.length),
+                                                  encoding(other.encoding) {
+    if(buffer) {
+        buffer->addRef();
+    }
+}
+
+#if __cplusplus >= 201103L
+
+LazyString::LazyString(LazyString&& other) : value(std::move(other.value)), buffer(other.buffer),
+                                             offset(other.offset), length(other.length),
+                                             encoding(other.encoding) {
+    other.buffer = NULL;
+}
+
+#endif // __cplusplus
+
+LazyString::~LazyString() {
+    releaseBuffer();
+}
+
+//=============================================================================
+// Operators
+//=============================================================================
+
+LazyString& LazyString::operator=(const LazyString& other) {
+
+    if(this != &other) {
+
+        if(other.buffer) {
+            other.buffer->addRef();
+        }
+
+        releaseBuffer();
+
+        value       = other.value;
+        buffer      = other.buffer;
+        offset      = other.offset;
+        length      = other.length;
+        encoding    = other.encoding;
+    }
+
+    return *this;
+}
+
+#if __cplusplus >= 201103L
+
+LazyString& LazyString::operator=(LazyString&& other) {
+
+    if(this != &other) {
+
+        releaseBuffer();
+
+        value       = std::move(other.value);
+        buffer      = other.buffer;
+        offset      = other.offset;
+        length      = other.length;
+        encoding    = other.encoding;
+
+        other.buffer = NULL;
+    }
+
+    return *this;
+}
+
+#endif // __cplusplus
+
+LazyString& LazyString::operator=(const std::string& newValue) {
+    releaseBuffer();
+    value = newValue;
+    return *this;
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// setReference - Points the string at text in a buffer, which is not
+/// decoded until the string is read.
+/// @param buffer holding the text. A reference to it is added.
+/// @param offset of the first character of the text
+/// @param number of characters of text
+/// @param how the text is encoded
+///----------------------------------------------------------------------------
+
+void LazyString::setReference(SharedBuffer* inBuffer, const size_t& inOffset, const size_t& inLength,
+                              const Encoding& inEncoding) {
+
+    inBuffer->addRef();
+    releaseBuffer();
+
+    value.clear();
+    buffer      = inBuffer;
+    offset      = inOffset;
+    length      = inLength;
+    encoding    = inEncoding;
+
+}
+
+///----------------------------------------------------------------------------
+/// edit - Drops any text that has not been decoded yet, and gives back the
+/// string so it can be filled in directly.
+/// @return the string, which is empty if it was not decoded.
+///----------------------------------------------------------------------------
+
+std::string& LazyString::edit() {
+    releaseBuffer();
+    return value;
+}
+
+///----------------------------------------------------------------------------
+/// empty - Checks if the string is empty without decoding it.
+///----------------------------------------------------------------------------
+
+bool LazyString::empty() const {
+
+    if(buffer == NULL) {
+        return value.empty();
+    }
+
+    // A VB string always ends with its closing quote, which is removed.
+
+    return encoding == VBString ? length <= 1 : length == 0;
+
+}
+
+///----------------------------------------------------------------------------
+/// get - Gets the text, decoding it first if it hasn't been yet.
+/// @return the decoded text.
+///----------------------------------------------------------------------------
+
+const std::string& LazyString::get() const {
+
+    if(buffer != NULL) {
+        decodeInto(value);
+        releaseBuffer();
+    }
+
+    return value;
+}
+
+///----------------------------------------------------------------------------
+/// getText - Gets the text without keeping it decoded, for when it is only
+/// going to be looked at once, such as when it is written out.
+/// @param (out) string the text may be decoded into
+/// @return the text, which is only valid until this or the scratch string
+/// is changed.
+///----------------------------------------------------------------------------
+
+Frost::StringToken LazyString::getText(std::string& scratch) const {
+
+    if(buffer == NULL) {
+        return Frost::StringToken(value);
+    }
+
+    if(encoding == Plain) {
+        return Frost::StringToken(buffer->getData() + offset, length);
+    }
+
+    decodeInto(scratch);
+    return Frost::StringToken(scratch);
+}
+
+///----------------------------------------------------------------------------
+/// getRawText - Gets the text as it is stored, without decoding it, so it can
+/// be copied somewhere else and decoded later.
+/// @param (out) how the text returned is written
+/// @return the text, which is only valid until this is changed.
+///----------------------------------------------------------------------------
+
+Frost::StringToken LazyString::getRawText(Encoding& outEncoding) const {
+
+    if(buffer == NULL) {
+        outEncoding = Plain;
+        return Frost::StringToken(value);
+    }
+
+    outEncoding = encoding;
+    return Frost::StringToken(buffer->getData() + offset, length);
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+void LazyString::decodeInto(std::string& outString) const {
+
+    const char* text = buffer->getData() + offset;
+
+    if(encoding == VBString) {
+        WorldFileReader::decodeVBString(text, length, outString);
+    }
+    else {
+        outString.assign(text, length);
+    }
+
+}
+
+void LazyString::releaseBuffer() const {
+    if(buffer) {
+        buffer->release();
+        buffer = NULL;
+    }
+}
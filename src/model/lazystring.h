@@ -0,0 +1,70 @@
+#ifndef __LAZYSTRING_H__
+#define __LAZYSTRING_H__
+
+#include <string>
+#include "../util/frost.h"
+
+class SharedBuffer;
+
+///----------------------------------------------------------------------------
+/// LazyString - Text from a world file that is only decoded the first time
+/// it is asked for. Until then it just remembers where the text is in a
+/// SharedBuffer, and copies of it share that buffer. Once decoded, it acts
+/// like an ordinary string. Decoding changes the string, so a LazyString
+/// must not be read from more than one thread at a time.
+///----------------------------------------------------------------------------
+
+class LazyString {
+
+    public:
+
+        // How the text is written in the buffer.
+
+        enum Encoding {
+            Plain,      // Exactly as it should be read.
+            VBString    // Escaped quotes, ending with the closing quote.
+        };
+
+        LazyString() : buffer(NULL), offset(0), length(0), encoding(Plain) {}
+        LazyString(const std::string& inValue) : value(inValue), buffer(NULL), offset(0), length(0),
+                                                 encoding(Plain) {}
+        LazyString(const LazyString& other);
+        ~LazyString();
+
+        LazyString& operator=(const LazyString& other);
+        LazyString& operator=(const std::string& newValue);
+
+#if __cplusplus >= 201103L
+        // Without these, objects holding a LazyString would copy their text
+        // whenever a vector of them grows.
+        LazyString(LazyString&& other);
+        LazyString& operator=(LazyString&& other);
+#endif // __cplusplus
+
+        void setReference(SharedBuffer* inBuffer, const size_t& inOffset, const size_t& inLength,
+                          const Encoding& inEncoding);
+        std::string& edit();
+
+        bool isDecoded() const { return buffer == NULL; }
+        bool empty() const;
+        const std::string& get() const;
+        const char* c_str() const { return get().c_str(); }
+        Frost::StringToken getText(std::string& scratch) const;
+        Frost::StringToken getRawText(Encoding& outEncoding) const;
+
+        operator const std::string&() const { return get(); }
+
+    private:
+
+        void decodeInto(std::string& outString) const;
+        void releaseBuffer() const;
+
+        mutable std::string     value;
+        mutable SharedBuffer*   buffer;     // NULL once the text is decoded.
+        size_t                  offset;
+        size_t                  length;
+        Encoding                encoding;
+
+};
+
+#endif // __LAZYSTRING_H__
@@ -0,0 +1,285 @@
+#include "rowdescription_loader.h"
+#include <stdexcept>
+#include "worldfile_reader.h"
+#include "../util/sharedbuffer.h"
+#include "../util/workerpool.h"
+#include "../util/worldstorage.h"
+
+//=============================================================================
+// RowDescriptionJob - Reads a single row description file.
+//=============================================================================
+
+class RowDescriptionJob : public WorkerJob {
+
+    public:
+
+        RowDescriptionJob(const WorldStorage& inStorage, const std::string& inRowFileName, const int& inNumCols,
+                          const bool& inLazyText) :
+                          storage(inStorage), rowFileName(inRowFileName), numCols(inNumCols),
+                          lazyText(inLazyText), errorLine(0), failed(false) {}
+
+        virtual void run();
+
+        const std::vector<LazyString>& getDescriptions() const { return descriptions; }
+        const std::string& getErrorMessage() const { return errorMessage; }
+        const size_t& getErrorLine() const { return errorLine; }
+        const std::string& getRowFileName() const { return rowFileName; }
+        const bool& getFailed() const { return failed; }
+
+    private:
+
+        void readDescriptions();
+        void readDescriptions(WorldFileReader& reader);
+
+        const WorldStorage&         storage;
+        std::string                 rowFileName;
+        int                         numCols;
+        bool                        lazyText;
+        std::vector<LazyString>     descriptions;
+        std::string                 errorMessage;
+        size_t                      errorLine;
+        bool                        failed;
+
+};
+
+///----------------------------------------------------------------------------
+/// run - Read the row file. Errors are kept in the job so that they can be
+/// reported in row order once every row has finished.
+///----------------------------------------------------------------------------
+
+void RowDescriptionJob::run() {
+
+    try {
+        readDescriptions();
+    }
+    catch (const std::runtime_error& e) {
+        errorMessage = e.what();
+        failed = true;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readDescriptions - Reads the descriptions from the row file, if it exists,
+/// into a vector indexed by column. Columns without a description are left
+/// as an empty string. With lazy text, the file is copied into a buffer the
+/// descriptions share, so it can be closed straight away.
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void RowDescriptionJob::readDescriptions() {
+
+    std::string errorMsg = "Error reading row descriptions: ";
+
+    descriptions.resize(numCols);
+
+    StoragePart rowFile;
+
+    if(!storage.openPart(rowFileName, rowFile)) {
+
+        if(rowFile.wasNotFound()) {
+            return; // No descriptions for this row.
+        }
+
+        errorMsg.append("could not open " + storage.getPartPath(rowFileName) + " for reading.");
+        throw std::runtime_error(errorMsg);
+    }
+
+    SharedBuffer* textBuffer = lazyText ? SharedBuffer::create(rowFile.getData(), rowFile.getSize()) : NULL;
+
+    WorldFileReader reader(textBuffer ? textBuffer->getData() : rowFile.getData(), rowFile.getSize());
+    reader.setTextBuffer(textBuffer);
+
+    try {
+        readDescriptions(reader);
+    }
+    catch (const std::runtime_error& e) {
+
+        if(textBuffer) {
+            textBuffer->release();
+        }
+
+        errorLine = reader.getLineNumber();
+        errorMsg.append(storage.getPartPath(rowFileName) + ": " + e.what());
+        throw std::runtime_error(errorMsg);
+    }
+
+    // The descriptions hold their own references to it.
+
+    if(textBuffer) {
+        textBuffer->release();
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// readDescriptions - Reads each description in the file.
+/// @param reader at the start of the file
+/// @throws runtime_error if there is a problem reading the file.
+///----------------------------------------------------------------------------
+
+void RowDescriptionJob::readDescriptions(WorldFileReader& reader) {
+
+    const int numDescriptions = reader.readInteger();
+
+    for(int i = 0; i < numDescriptions; i++) {
+
+        const char* lineStart;
+        size_t lineLength;
+
+        if(!reader.nextLine(lineStart, lineLength) || lineLength == 0) {
+            break; // Nothing left.
+        }
+
+        const int colID = reader.parseInteger(lineStart, lineLength);
+
+        if(colID < 0 || colID >= numCols) {
+            throw std::runtime_error("The column indicated is outside the boundaries of the map" +
+                                     reader.positionString() + ".");
+        }
+
+        reader.readVBString(descriptions[colID]);
+    }
+
+}
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+RowDescriptionLoader::RowDescriptionLoader(const WorldStorage& inStorage, const std::string& inBaseName,
+                                           const int& inNumRows, const int& inNumCols, const bool& inLazyText) :
+                                           storage(&inStorage), baseName(inBaseName), numRows(inNumRows),
+                                           numCols(inNumCols), lazyText(inLazyText) {
+}
+
+RowDescriptionLoader::~RowDescriptionLoader() {
+
+    for(size_t i = 0; i < rowJobs.size(); ++i) {
+        delete rowJobs[i];
+        rowJobs[i] = NULL;
+    }
+
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// load - Reads the row file of every row in the world. Rows that do not have
+/// a file are treated as having no descriptions.
+/// @throws runtime_error if any of the row files could not be read. If more
+/// than one failed, the error for the lowest row is the one thrown.
+///----------------------------------------------------------------------------
+
+void RowDescriptionLoader::load() {
+
+    readRows();
+
+    for(size_t i = 0; i < rowJobs.size(); ++i) {
+        if(rowJobs[i]->getFailed()) {
+            throw std::runtime_error(rowJobs[i]->getErrorMessage());
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// load - Same as above, but instead of throwing, every row file that could
+/// not be read is added to the diagnostics, in row order. A row that failed
+/// keeps the descriptions read before the problem.
+/// @param (out) vector to add the problems to
+///----------------------------------------------------------------------------
+
+void RowDescriptionLoader::load(std::vector<WorldDiagnostic>& outDiagnostics) {
+
+    readRows();
+
+    for(size_t i = 0; i < rowJobs.size(); ++i) {
+
+        if(rowJobs[i]->getFailed()) {
+            outDiagnostics.push_back(WorldDiagnostic(rowJobs[i]->getRowFileName(), rowJobs[i]->getErrorLine(),
+                                                     rowJobs[i]->getErrorMessage()));
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// prepareRows - Sets up every row to be read, without reading any of them.
+/// This only needs to be called before loadRow, as load does it itself.
+///----------------------------------------------------------------------------
+
+void RowDescriptionLoader::prepareRows() {
+
+    if(!rowJobs.empty()) {
+        return;
+    }
+
+    rowJobs.reserve(numRows);
+
+    std::string rowFileName = baseName + ".T00";
+    const size_t rowDigitPos = rowFileName.length() - 2;
+
+    for(int row = 0; row < numRows; ++row) {
+
+        rowFileName[rowDigitPos] = static_cast<char>('0' + (row / 10));
+        rowFileName[rowDigitPos + 1] = static_cast<char>('0' + (row % 10));
+
+        rowJobs.push_back(new RowDescriptionJob(*storage, rowFileName, numCols, lazyText));
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// loadRow - Reads the row file of one row on the calling thread, for callers
+/// that spread the rows across their own jobs. Different rows can be loaded
+/// on different threads at once. prepareRows must be called first.
+/// @param the row to read
+/// @return true if the row was read, false if its file could not be. Use
+/// load to find out why.
+///----------------------------------------------------------------------------
+
+bool RowDescriptionLoader::loadRow(const int& row) {
+    rowJobs[row]->run();
+    return !rowJobs[row]->getFailed();
+}
+
+///----------------------------------------------------------------------------
+/// getRow - Get the descriptions of each tile in a row. load, or loadRow for
+/// the row, must be called first.
+/// @param the row to get the descriptions of
+/// @return a vector with a description for each column, empty if the tile
+/// has none.
+///----------------------------------------------------------------------------
+
+const std::vector<LazyString>& RowDescriptionLoader::getRow(const int& row) const {
+    return rowJobs[row]->getDescriptions();
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// readRows - Runs a job for every row, spread across a worker pool.
+///----------------------------------------------------------------------------
+
+void RowDescriptionLoader::readRows() {
+
+    prepareRows();
+
+    std::vector<WorkerJob*> jobs(rowJobs.begin(), rowJobs.end());
+
+    unsigned int numThreads = (numRows + RowDescriptionLoaderConstants::MinRowsPerThread - 1) /
+                              RowDescriptionLoaderConstants::MinRowsPerThread;
+
+    if(numThreads > RowDescriptionLoaderConstants::MaxThreads) {
+        numThreads = RowDescriptionLoaderConstants::MaxThreads;
+    }
+
+    WorkerPool workerPool(numThreads ? numThreads : 1);
+    workerPool.runJobs(jobs);
+
+}
@@ -0,0 +1,59 @@
+#ifndef __ROWDESCRIPTION_LOADER_H__
+#define __ROWDESCRIPTION_LOADER_H__
+
+#include <string>
+#include <vector>
+#include "world_diagnostic.h"
+#include "lazystring.h"
+
+class RowDescriptionJob;
+class WorldStorage;
+
+namespace RowDescriptionLoaderConstants {
+    // Opening the row files is mostly waiting on the disk, so it's worth
+    // using a few threads even on one core. Each thread gets at least a few
+    // rows so small worlds are not slowed down by starting threads.
+    const unsigned int MaxThreads       = 8;
+    const unsigned int MinRowsPerThread = 8;
+}
+
+///----------------------------------------------------------------------------
+/// RowDescriptionLoader - Reads every row description (TXX) file of a world at
+/// once, spreading the rows across a worker pool. The descriptions can then
+/// be looked up by row and column while the tiles are being read. With lazy
+/// text, the descriptions are only found, and decoded when first read. The
+/// row files are opened from the storage the world is in, which must not
+/// change until they have all been read.
+///----------------------------------------------------------------------------
+
+class RowDescriptionLoader {
+
+    public:
+
+        RowDescriptionLoader(const WorldStorage& inStorage, const std::string& inBaseName, const int& inNumRows,
+                             const int& inNumCols, const bool& inLazyText = false);
+        ~RowDescriptionLoader();
+
+        void load();
+        void load(std::vector<WorldDiagnostic>& outDiagnostics);
+        void prepareRows();
+        bool loadRow(const int& row);
+        const std::vector<LazyString>& getRow(const int& row) const;
+
+    private:
+
+        RowDescriptionLoader(const RowDescriptionLoader&) {};
+        void operator=(const RowDescriptionLoader&) {};
+
+        void readRows();
+
+        const WorldStorage*                 storage;
+        std::string                         baseName;
+        int                                 numRows;
+        int                                 numCols;
+        bool                                lazyText;
+        std::vector<RowDescriptionJob*>     rowJobs;
+
+};
+
+#endif // __ROWDESCRIPTION_LOADER_H__
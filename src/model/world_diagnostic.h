@@ -0,0 +1,75 @@
+#ifndef __WORLD_DIAGNOSTIC_H__
+#define __WORLD_DIAGNOSTIC_H__
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+///----------------------------------------------------------------------------
+/// WorldDiagnostic - A problem found while reading a world in diagnostic
+/// mode, and where it was found.
+///----------------------------------------------------------------------------
+
+struct WorldDiagnostic {
+
+    WorldDiagnostic(const std::string& inFileName, const size_t& inLineNumber, const std::string& inMessage) :
+                    fileName(inFileName), lineNumber(inLineNumber), message(inMessage) {}
+
+    std::string     fileName;       // Name of the file, without its path.
+    size_t          lineNumber;     // 0 if the problem is not on a line.
+    std::string     message;
+
+};
+
+///----------------------------------------------------------------------------
+/// DiagnosticLog - Where the readers send the problems they can recover from.
+/// When a log has nowhere to record them, they are thrown instead, which is
+/// how a world is normally read.
+///----------------------------------------------------------------------------
+
+class DiagnosticLog {
+
+    public:
+
+        DiagnosticLog(std::vector<WorldDiagnostic>* inDiagnostics, const std::string& inFileName) :
+                      diagnostics(inDiagnostics), fileName(inFileName) {}
+
+        bool isRecording() const { return diagnostics != NULL; }
+        std::vector<WorldDiagnostic>* getDiagnostics() const { return diagnostics; }
+
+        ///--------------------------------------------------------------------
+        /// record - Adds a problem to the log. Only call this if the log is
+        /// recording.
+        ///--------------------------------------------------------------------
+
+        void record(const size_t& lineNumber, const std::string& message) const {
+            diagnostics->push_back(WorldDiagnostic(fileName, lineNumber, message));
+        }
+
+        ///--------------------------------------------------------------------
+        /// report - Records a problem the reader can skip past, or throws it
+        /// if the log is not recording.
+        /// @param line the problem is on
+        /// @param what the reader was doing, which is only added to recorded
+        /// problems, as the reader adds it to anything thrown.
+        /// @param the problem
+        /// @throws runtime_error with the problem if the log is not recording
+        ///--------------------------------------------------------------------
+
+        void report(const size_t& lineNumber, const std::string& context, const std::string& message) const {
+
+            if(diagnostics == NULL) {
+                throw std::runtime_error(message);
+            }
+
+            record(lineNumber, context + message);
+        }
+
+    private:
+
+        std::vector<WorldDiagnostic>*   diagnostics;
+        std::string                     fileName;
+
+};
+
+#endif // __WORLD_DIAGNOSTIC_H__
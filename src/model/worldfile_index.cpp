@@ -0,0 +1,85 @@
+#include "worldfile_index.h"
+#include <cstring>
+#include "gameinfo.h"
+#include "../compat/std_extras_compat.h"
+#include "../util/linescanner.h"
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// scan - Finds every row and section heading after the map dimensions.
+/// @param pointer to the start of the file
+/// @param size of the file in bytes
+/// @param offset of the first line after the dimensions
+/// @param number of the last line before that offset
+/// @param number of rows in the map
+/// @return true if every heading was found in order, false if any were not.
+///----------------------------------------------------------------------------
+
+bool WorldFileIndex::scan(const char* data, const size_t& inSize, const size_t& startOffset,
+                          const size_t& startLine, const int& numRows) {
+
+    size = inSize;
+    rows.assign(numRows > 0 ? numRows : 0, Entry());
+
+    // Every heading, in the order they have to appear, and where to put
+    // each one when it is found.
+
+    std::vector<std::string> headings;
+    std::vector<Entry*> entries;
+    headings.reserve(rows.size() + 5);
+    entries.reserve(rows.size() + 5);
+
+    for(size_t row = 0; row < rows.size(); ++row) {
+        headings.push_back(AdventureGamerHeadings::Row + std::to_string(static_cast<int>(row)));
+        entries.push_back(&rows[row]);
+    }
+
+    headings.push_back(AdventureGamerHeadings::Jumps);
+    entries.push_back(&jumps);
+    headings.push_back(AdventureGamerHeadings::Switches);
+    entries.push_back(&switches);
+    headings.push_back(AdventureGamerHeadings::Attributes);
+    entries.push_back(&attributes);
+    headings.push_back(AdventureGamerHeadings::Objects);
+    entries.push_back(&objects);
+    headings.push_back(AdventureGamerHeadings::Characters);
+    entries.push_back(&characters);
+
+    size_t nextHeading = 0;
+    size_t offset = startOffset;
+    size_t lineNumber = startLine;
+
+    while(offset < size && nextHeading < headings.size()) {
+
+        const char* lineStart = data + offset;
+        const char* lineEnd = LineScanner::findNewLine(lineStart, size - offset);
+        size_t lineLength = lineEnd ? static_cast<size_t>(lineEnd - lineStart) : size - offset;
+
+        lineNumber++;
+
+        // Only headings start with a brace, so most lines stop here.
+
+        if(lineLength != 0 && lineStart[0] == '{') {
+
+            const std::string& heading = headings[nextHeading];
+
+            while(lineLength != 0 && lineStart[lineLength - 1] == '\r') {
+                lineLength--;
+            }
+
+            if(lineLength == heading.length() && !memcmp(lineStart, heading.c_str(), lineLength)) {
+                entries[nextHeading]->offset = offset;
+                entries[nextHeading]->lineNumber = lineNumber;
+                nextHeading++;
+            }
+        }
+
+        offset = lineEnd ? static_cast<size_t>(lineEnd - data) + 1 : size;
+    }
+
+    return nextHeading == headings.size();
+
+}
@@ -0,0 +1,53 @@
+#ifndef __WORLDFILE_INDEX_H__
+#define __WORLDFILE_INDEX_H__
+
+#include <string>
+#include <vector>
+
+///----------------------------------------------------------------------------
+/// WorldFileIndex - Finds where each row and section of an SG0 file starts
+/// without decoding any of it, so the parts can be handed to different
+/// threads. The headings are only looked for in the order they are written,
+/// so a line that happens to look like a heading elsewhere is not mistaken
+/// for one, but readers of the parts should still check that they ended
+/// where the next part begins.
+///----------------------------------------------------------------------------
+
+class WorldFileIndex {
+
+    public:
+
+        // Where a heading is. The line number is that of the heading itself.
+
+        struct Entry {
+            Entry() : offset(0), lineNumber(0) {}
+            size_t offset;
+            size_t lineNumber;
+        };
+
+        WorldFileIndex() : size(0) {}
+
+        bool scan(const char* data, const size_t& inSize, const size_t& startOffset, const size_t& startLine,
+                  const int& numRows);
+
+        const size_t& getSize() const { return size; }
+        const Entry& getRow(const int& row) const { return rows[row]; }
+        const Entry& getJumps() const { return jumps; }
+        const Entry& getSwitches() const { return switches; }
+        const Entry& getAttributes() const { return attributes; }
+        const Entry& getObjects() const { return objects; }
+        const Entry& getCharacters() const { return characters; }
+
+    private:
+
+        size_t              size;
+        std::vector<Entry>  rows;
+        Entry               jumps;
+        Entry               switches;
+        Entry               attributes;
+        Entry               objects;
+        Entry               characters;
+
+};
+
+#endif // __WORLDFILE_INDEX_H__
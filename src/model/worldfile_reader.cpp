@@ -0,0 +1,528 @@
+#include "worldfile_reader.h"
+#include <stdexcept>
+#include <cstring>
+#include "../compat/std_extras_compat.h"
+#include "../util/frost.h"
+#include "../util/linescanner.h"
+#include "../util/sharedbuffer.h"
+
+//=============================================================================
+// Constructors
+//=============================================================================
+
+WorldFileReader::WorldFileReader(const char* inData, const size_t& inSize) : data(inData), size(inSize),
+                                                                             offset(0), lineNumber(0),
+                                                                             textBuffer(NULL) {
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// nextLine - Get the next line in the buffer, without its line feed. Any
+/// carriage returns are left on the line.
+/// @param (out) pointer to the first character of the line
+/// @param (out) length of the line
+/// @param (out) true if the line ended with a line feed, false if the buffer
+/// ended first.
+/// @return false if there are no lines left, true otherwise.
+///----------------------------------------------------------------------------
+
+bool WorldFileReader::nextLine(const char*& outStart, size_t& outLength, bool& hadNewLine) {
+
+    if(offset >= size) {
+        outStart    = data + size;
+        outLength   = 0;
+        hadNewLine  = false;
+        return false;
+    }
+
+    const char* lineStart = data + offset;
+    const char* lineEnd = LineScanner::findNewLine(lineStart, size - offset);
+
+    lineNumber++;
+    outStart = lineStart;
+
+    if(lineEnd == NULL) {
+        outLength   = size - offset;
+        hadNewLine  = false;
+        offset      = size;
+    }
+    else {
+        outLength   = static_cast<size_t>(lineEnd - lineStart);
+        hadNewLine  = true;
+        offset     += outLength + 1;
+    }
+
+    return true;
+}
+
+bool WorldFileReader::nextLine(const char*& outStart, size_t& outLength) {
+    bool hadNewLine;
+    return nextLine(outStart, outLength, hadNewLine);
+}
+
+///----------------------------------------------------------------------------
+/// peekLine - Gets the next line without moving past it. Carriage returns are
+/// left on the line.
+/// @param (out) pointer to the first character of the line
+/// @param (out) length of the line
+/// @return false if there are no lines left, true otherwise.
+///----------------------------------------------------------------------------
+
+bool WorldFileReader::peekLine(const char*& outStart, size_t& outLength) const {
+
+    if(offset >= size) {
+        outStart    = data + size;
+        outLength   = 0;
+        return false;
+    }
+
+    outStart = data + offset;
+
+    const char* lineEnd = LineScanner::findNewLine(outStart, size - offset);
+    outLength = lineEnd ? static_cast<size_t>(lineEnd - outStart) : size - offset;
+
+    return true;
+}
+
+///----------------------------------------------------------------------------
+/// seek - Moves the reader to the start of a line, so part of a file can be
+/// read without reading everything before it.
+/// @param offset of the first character of the line
+/// @param number of the line before it, so positions are still reported
+/// from the start of the file.
+///----------------------------------------------------------------------------
+
+void WorldFileReader::seek(const size_t& newOffset, const size_t& newLineNumber) {
+    offset      = newOffset < size ? newOffset : size;
+    lineNumber  = newLineNumber;
+}
+
+///----------------------------------------------------------------------------
+/// setEnd - Stops the reader at an earlier point in the buffer, so it only
+/// reads part of it.
+/// @param offset the reader should treat as the end of the buffer
+///----------------------------------------------------------------------------
+
+void WorldFileReader::setEnd(const size_t& newSize) {
+    size = newSize;
+}
+
+///----------------------------------------------------------------------------
+/// compareLine - Reads the next line and checks if it matches the string
+/// given. Trailing carriage returns are ignored.
+/// @param the string the line should be
+/// @return true if it matched, false if it did not.
+///----------------------------------------------------------------------------
+
+bool WorldFileReader::compareLine(const std::string& expected) {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    nextLine(lineStart, lineLength);
+
+    while(lineLength != 0 && lineStart[lineLength - 1] == '\r') {
+        lineLength--;
+    }
+
+    return lineLength == expected.length() && !memcmp(lineStart, expected.c_str(), lineLength);
+
+}
+
+///----------------------------------------------------------------------------
+/// readInteger - Reads the next line as an integer.
+/// @return the integer read
+/// @throws runtime_error saying where the number is if the line is not a
+/// number, it is out of range, or the file ended.
+///----------------------------------------------------------------------------
+
+int WorldFileReader::readInteger() {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    if(!nextLine(lineStart, lineLength)) {
+        setError(Frost::ParseErrors::EndOfFile, size, lineNumber + 1);
+        throw std::runtime_error(lastError.toString());
+    }
+
+    return parseInteger(lineStart, lineLength);
+
+}
+
+///----------------------------------------------------------------------------
+/// tryReadInteger - Reads the next line as an integer without throwing. If
+/// it fails, getLastError says why and where.
+/// @param (out) the integer read, if there was one
+/// @return a Frost::ParseErrors code, NoError if an integer was read.
+///----------------------------------------------------------------------------
+
+int WorldFileReader::tryReadInteger(int& outValue) {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    if(!nextLine(lineStart, lineLength)) {
+        return setError(Frost::ParseErrors::EndOfFile, size, lineNumber + 1);
+    }
+
+    return tryParseInteger(lineStart, lineLength, outValue);
+
+}
+
+///----------------------------------------------------------------------------
+/// parseInteger - Converts part of a line to an integer. Just like std::stoi,
+/// leading whitespace is skipped and anything after the number is ignored.
+/// @param pointer to the first character of the text to convert
+/// @param number of characters in the text
+/// @return the integer read
+/// @throws runtime_error if the text is not a number, or it is out of range.
+///----------------------------------------------------------------------------
+
+int WorldFileReader::parseInteger(const char* lineStart, const size_t& lineLength) {
+
+    int value = 0;
+
+    if(tryParseInteger(lineStart, lineLength, value) != Frost::ParseErrors::NoError) {
+        throw std::runtime_error(lastError.toString(Frost::rtrimToken(Frost::StringToken(lineStart, lineLength),
+                                                                      "\r")));
+    }
+
+    return value;
+
+}
+
+///----------------------------------------------------------------------------
+/// tryParseInteger - Same as parseInteger, but without throwing. If it
+/// fails, getLastError says why, and which byte of the file the problem is.
+/// @param pointer to the first character of the text to convert, which must
+/// be in the reader's buffer.
+/// @param number of characters in the text
+/// @param (out) the integer read, if there was one
+/// @return a Frost::ParseErrors code, NoError if an integer was read.
+///----------------------------------------------------------------------------
+
+int WorldFileReader::tryParseInteger(const char* lineStart, const size_t& lineLength, int& outValue) {
+
+    size_t errorPos = 0;
+    const int errorCode = Frost::parseInteger(lineStart, lineLength, outValue, errorPos);
+
+    if(errorCode != Frost::ParseErrors::NoError) {
+        return setError(errorCode, static_cast<size_t>(lineStart - data) + errorPos, lineNumber);
+    }
+
+    return errorCode;
+
+}
+
+///----------------------------------------------------------------------------
+/// readLine - Reads the next line into a string, the same way
+/// Frost::getLineWindows does.
+/// @param (out) string to store the line in
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readLine(std::string& outLine) {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    nextLine(lineStart, lineLength);
+
+    while(lineLength != 0 && lineStart[lineLength - 1] == '\r') {
+        lineLength--;
+    }
+
+    outLine.assign(lineStart, lineLength);
+
+}
+
+///----------------------------------------------------------------------------
+/// readLine - Same as above, but if there is a text buffer, the line is only
+/// decoded when the string is first read.
+/// @param (out) string to store the line in
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readLine(LazyString& outLine) {
+
+    if(textBuffer == NULL) {
+        readLine(outLine.edit());
+        return;
+    }
+
+    const char* lineStart;
+    size_t lineLength;
+
+    nextLine(lineStart, lineLength);
+
+    while(lineLength != 0 && lineStart[lineLength - 1] == '\r') {
+        lineLength--;
+    }
+
+    outLine.setReference(textBuffer, static_cast<size_t>(lineStart - data), lineLength, LazyString::Plain);
+
+}
+
+///----------------------------------------------------------------------------
+/// readQuotedLine - Reads the next line into a string and strips the quotes
+/// from both ends, the same way Frost::getVBString does.
+/// @param (out) string to store the line in
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readQuotedLine(std::string& outLine) {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    readQuotedLine(lineStart, lineLength);
+    outLine.assign(lineStart, lineLength);
+
+}
+
+///----------------------------------------------------------------------------
+/// readQuotedLine - Same as above, but if there is a text buffer, the line
+/// is only decoded when the string is first read.
+/// @param (out) string to store the line in
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readQuotedLine(LazyString& outLine) {
+
+    if(textBuffer == NULL) {
+        readQuotedLine(outLine.edit());
+        return;
+    }
+
+    const char* lineStart;
+    size_t lineLength;
+
+    readQuotedLine(lineStart, lineLength);
+    outLine.setReference(textBuffer, static_cast<size_t>(lineStart - data), lineLength, LazyString::Plain);
+
+}
+
+///----------------------------------------------------------------------------
+/// readQuotedLine - Same as above, but gives back where the text is in the
+/// buffer instead of copying it.
+/// @param (out) pointer to the first character of the text
+/// @param (out) length of the text
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readQuotedLine(const char*& outStart, size_t& outLength) {
+
+    const char* lineStart;
+    size_t lineLength;
+
+    nextLine(lineStart, lineLength);
+
+    while(lineLength != 0 && lineStart[lineLength - 1] == '\r') {
+        lineLength--;
+    }
+
+    while(lineLength != 0 && lineStart[lineLength - 1] == '\"') {
+        lineLength--;
+    }
+
+    while(lineLength != 0 && lineStart[0] == '\"') {
+        lineStart++;
+        lineLength--;
+    }
+
+    outStart = lineStart;
+    outLength = lineLength;
+
+}
+
+///----------------------------------------------------------------------------
+/// readVBString - Reads a string that was written with Visual Basic's "Write"
+/// command. It may span multiple lines, and double quotes are escaped with a
+/// second double quote. It ends on the line with a quote that is not part of
+/// a pair, which should be the last character on it.
+/// @param (out) string to store the unescaped string in
+/// @throws runtime_error if a valid string could not be read
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readVBString(std::string& outString) {
+
+    const char* textStart;
+    size_t textLength;
+
+    readVBString(textStart, textLength);
+    decodeVBString(textStart, textLength, outString);
+
+}
+
+///----------------------------------------------------------------------------
+/// readVBString - Same as above, but if there is a text buffer, the string
+/// is only unescaped when it is first read.
+/// @param (out) string to store the string in
+/// @throws runtime_error if a valid string could not be read
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readVBString(LazyString& outString) {
+
+    if(textBuffer == NULL) {
+        readVBString(outString.edit());
+        return;
+    }
+
+    const char* textStart;
+    size_t textLength;
+
+    readVBString(textStart, textLength);
+    outString.setReference(textBuffer, static_cast<size_t>(textStart - data), textLength, LazyString::VBString);
+
+}
+
+///----------------------------------------------------------------------------
+/// readVBString - Finds where a Visual Basic string is in the buffer without
+/// unescaping it. The text is everything after the opening quote, up to the
+/// end of the line the string ends on, not counting its carriage return.
+/// decodeVBString turns it into the string itself.
+/// @param (out) pointer to the first character of the text
+/// @param (out) length of the text
+/// @throws runtime_error if a valid string could not be read
+///----------------------------------------------------------------------------
+
+void WorldFileReader::readVBString(const char*& outStart, size_t& outLength) {
+
+    const char* lineStart;
+    size_t lineLength;
+    bool hadNewLine;
+
+    if(!nextLine(lineStart, lineLength, hadNewLine)) {
+        throw std::runtime_error("Failed to read string" + positionString() + ".");
+    }
+
+    if(lineLength == 0 || lineStart[0] != '\"') {
+        throw std::runtime_error("Value read was not a valid Visual Basic String" + positionString() + ".");
+    }
+
+    // Skip the opening quote.
+    lineStart++;
+    lineLength--;
+
+    outStart = lineStart;
+
+    while(true) {
+
+        if(!hadNewLine) {
+            throw std::runtime_error("Reached end of file without finding the end of the string" +
+                                     positionString() + ".");
+        }
+
+        // The character just before the line feed is the carriage return,
+        // which is not part of the text we search for the end quote in.
+
+        size_t textLength = lineLength;
+
+        if(textLength != 0 && lineStart[textLength - 1] == '\r') {
+            textLength--;
+        }
+
+        // Pairs of quotes are escaped quotes, and if a run of them has one
+        // left over, this is the line the string ends on.
+
+        size_t i = 0;
+
+        while(i < textLength) {
+
+            const char* nextQuote = static_cast<const char*>(memchr(lineStart + i, '\"', textLength - i));
+
+            if(nextQuote == NULL) {
+                break;
+            }
+
+            i = static_cast<size_t>(nextQuote - lineStart);
+
+            size_t runLength = 0;
+
+            while(i < textLength && lineStart[i] == '\"') {
+                ++runLength;
+                ++i;
+            }
+
+            if(runLength & 1) {
+                outLength = static_cast<size_t>(lineStart + textLength - outStart);
+                return;
+            }
+
+        }
+
+        if(!nextLine(lineStart, lineLength, hadNewLine)) {
+            throw std::runtime_error("Reached end of file without finding the end of the string" +
+                                     positionString() + ".");
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// decodeVBString - Unescapes the text of a Visual Basic string found by
+/// readVBString. Line breaks inside the string are kept as they are, and
+/// the closing quote is removed.
+/// @param pointer to the first character of the text
+/// @param length of the text
+/// @param (out) string to store the unescaped string in
+///----------------------------------------------------------------------------
+
+void WorldFileReader::decodeVBString(const char* text, const size_t& length, std::string& outString) {
+
+    // Unescaping only makes the text shorter, so it never has to grow.
+
+    outString.clear();
+    outString.reserve(length);
+
+    size_t i = 0;
+
+    while(i < length) {
+
+        // Copy everything up to the next quote in one go.
+
+        const char* nextQuote = static_cast<const char*>(memchr(text + i, '\"', length - i));
+        const size_t chunkEnd = nextQuote ? static_cast<size_t>(nextQuote - text) : length;
+
+        outString.append(text + i, chunkEnd - i);
+        i = chunkEnd;
+
+        size_t runLength = 0;
+
+        while(i < length && text[i] == '\"') {
+            ++runLength;
+            ++i;
+        }
+
+        outString.append((runLength + 1) / 2, '\"');
+
+    }
+
+    // Remove the last character, which is the closing quote.
+
+    if(!outString.empty()) {
+        outString.erase(outString.size() - 1);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// positionString - Gets a human readable description of where the reader
+/// is in the file.
+/// @return a string in the form of " (line X, byte Y)"
+///----------------------------------------------------------------------------
+
+std::string WorldFileReader::positionString() const {
+    return Frost::positionString(lineNumber, offset);
+}
+
+///----------------------------------------------------------------------------
+/// setError - Records why and where reading failed.
+/// @return the error code given, so it can be returned straight away.
+///----------------------------------------------------------------------------
+
+int WorldFileReader::setError(const int& errorCode, const size_t& errorOffset, const size_t& errorLine) {
+    lastError.code          = errorCode;
+    lastError.offset        = errorOffset;
+    lastError.lineNumber    = errorLine;
+    return errorCode;
+}
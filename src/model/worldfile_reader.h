@@ -0,0 +1,74 @@
+#ifndef __WORLDFILE_READER_H__
+#define __WORLDFILE_READER_H__
+
+#include <string>
+#include "../compat/stdint_compat.h"
+#include "../util/frost.h"
+#include "lazystring.h"
+
+class SharedBuffer;
+
+///----------------------------------------------------------------------------
+/// WorldFileReader - Tokenizes the text of an SG0 or TXX file in place. The
+/// reader never owns or copies the buffer it is given, so it must stay valid
+/// for as long as the reader is used. Only strings that are handed back to
+/// the caller are allocated. If the buffer is a SharedBuffer given to
+/// setTextBuffer, text read into a LazyString is not decoded at all.
+///----------------------------------------------------------------------------
+
+class WorldFileReader {
+
+    public:
+
+        WorldFileReader(const char* inData, const size_t& inSize);
+
+        bool atEnd() const { return offset >= size; }
+        const char* getData() const { return data; }
+        const size_t& getSize() const { return size; }
+        const size_t& getOffset() const { return offset; }
+        const size_t& getLineNumber() const { return lineNumber; }
+
+        bool nextLine(const char*& outStart, size_t& outLength);
+        bool nextLine(const char*& outStart, size_t& outLength, bool& hadNewLine);
+        bool peekLine(const char*& outStart, size_t& outLength) const;
+        void seek(const size_t& newOffset, const size_t& newLineNumber);
+        void setEnd(const size_t& newSize);
+
+        SharedBuffer* getTextBuffer() const { return textBuffer; }
+        void setTextBuffer(SharedBuffer* inTextBuffer) { textBuffer = inTextBuffer; }
+
+        bool compareLine(const std::string& expected);
+        int readInteger();
+        int parseInteger(const char* lineStart, const size_t& lineLength);
+        int tryReadInteger(int& outValue);
+        int tryParseInteger(const char* lineStart, const size_t& lineLength, int& outValue);
+        const Frost::ParseError& getLastError() const { return lastError; }
+        void readLine(std::string& outLine);
+        void readLine(LazyString& outLine);
+        void readQuotedLine(std::string& outLine);
+        void readQuotedLine(LazyString& outLine);
+        void readQuotedLine(const char*& outStart, size_t& outLength);
+        void readVBString(std::string& outString);
+        void readVBString(LazyString& outString);
+        void readVBString(const char*& outStart, size_t& outLength);
+
+        static void decodeVBString(const char* text, const size_t& length, std::string& outString);
+
+        std::string positionString() const;
+
+    private:
+
+        WorldFileReader() {};
+
+        int setError(const int& errorCode, const size_t& errorOffset, const size_t& errorLine);
+
+        const char*         data;
+        size_t              size;
+        size_t              offset;
+        size_t              lineNumber; // Line number of the last line read.
+        Frost::ParseError   lastError;
+        SharedBuffer*       textBuffer; // Not owned. NULL to decode text as it is read.
+
+};
+
+#endif // __WORLDFILE_READER_H__
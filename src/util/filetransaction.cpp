@@ -0,0 +1,603 @@
+#include "filetransaction.h"
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN32
+
+//=============================================================================
+// Helper Functions
+//=============================================================================
+
+#ifdef _WIN32
+#ifndef __WIN9X_COMPAT__
+
+///----------------------------------------------------------------------------
+/// toWidePath - Convert a UTF-8 path to UTF-16 for the wide Win32 functions.
+/// @param UTF-8 string of the path
+/// @return the path as a wide string, empty if it could not be converted.
+///----------------------------------------------------------------------------
+
+static std::wstring toWidePath(const std::string& filePath) {
+
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, NULL, 0);
+
+    if(wideLength == 0) {
+        return std::wstring();
+    }
+
+    std::vector<wchar_t> widePath(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], wideLength);
+    return std::wstring(&widePath[0]);
+
+}
+
+#endif // __WIN9X_COMPAT__
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// replaceFile - Rename a file over another, replacing it if it exists.
+/// @param UTF-8 string of the path of the file to move
+/// @param UTF-8 string of the path to move it to
+/// @return true if it was moved, false if it was not.
+///----------------------------------------------------------------------------
+
+static bool replaceFile(const std::string& fromPath, const std::string& toPath) {
+
+#ifdef _WIN32
+#ifdef __WIN9X_COMPAT__
+    // 9x does not have MoveFileEx, so the old file has to go first.
+    DeleteFileA(toPath.c_str());
+    return MoveFileA(fromPath.c_str(), toPath.c_str()) != 0;
+#else
+    return MoveFileExW(toWidePath(fromPath).c_str(), toWidePath(toPath).c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#endif // __WIN9X_COMPAT__
+#else
+    return rename(fromPath.c_str(), toPath.c_str()) == 0;
+#endif // _WIN32
+
+}
+
+///----------------------------------------------------------------------------
+/// deleteFile - Delete a file.
+/// @param UTF-8 string of the path of the file
+/// @return true if it was deleted, false if it was not.
+///----------------------------------------------------------------------------
+
+static bool deleteFile(const std::string& filePath) {
+
+#ifdef _WIN32
+#ifdef __WIN9X_COMPAT__
+    return DeleteFileA(filePath.c_str()) != 0;
+#else
+    return DeleteFileW(toWidePath(filePath).c_str()) != 0;
+#endif // __WIN9X_COMPAT__
+#else
+    return unlink(filePath.c_str()) == 0;
+#endif // _WIN32
+
+}
+
+#ifndef _WIN32
+
+///----------------------------------------------------------------------------
+/// copyFile - Copy a file, with its permissions, and flush the copy to disk.
+/// Used for backups when the file system cannot hard link.
+/// @param path of the file to copy
+/// @param path of the copy, which is replaced if it exists
+/// @return true if it was copied, false if it was not, in which case no
+/// partial copy is left behind.
+///----------------------------------------------------------------------------
+
+static bool copyFile(const std::string& fromPath, const std::string& toPath) {
+
+    const int fromFD = open(fromPath.c_str(), O_RDONLY);
+
+    if(fromFD == -1) {
+        return false;
+    }
+
+    struct stat fileInfo;
+    int toFD = -1;
+
+    if(fstat(fromFD, &fileInfo) == 0) {
+        toFD = open(toPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, fileInfo.st_mode & 07777);
+    }
+
+    bool copied = (toFD != -1);
+    char buffer[65536];
+
+    while(copied) {
+
+        const ssize_t bytesRead = read(fromFD, buffer, sizeof(buffer));
+
+        if(bytesRead == 0) {
+            break;
+        }
+
+        if(bytesRead < 0) {
+            copied = (errno == EINTR);
+            continue;
+        }
+
+        const char* data = buffer;
+        size_t bytesLeft = static_cast<size_t>(bytesRead);
+
+        while(copied && bytesLeft != 0) {
+
+            const ssize_t bytesWritten = write(toFD, data, bytesLeft);
+
+            if(bytesWritten < 0) {
+                copied = (errno == EINTR);
+                continue;
+            }
+
+            data += bytesWritten;
+            bytesLeft -= static_cast<size_t>(bytesWritten);
+        }
+    }
+
+    close(fromFD);
+
+    if(toFD != -1) {
+
+        copied = (fsync(toFD) == 0) && copied;
+        copied = (close(toFD) == 0) && copied;
+
+        if(!copied) {
+            unlink(toPath.c_str());
+        }
+    }
+
+    return copied;
+
+}
+
+#endif // _WIN32
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+FileTransaction::FileTransaction() : committed(false) {
+}
+
+FileTransaction::~FileTransaction() {
+
+    if(!committed) {
+        rollback();
+    }
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+        delete stagedFiles[i];
+        stagedFiles[i] = NULL;
+    }
+
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// addFile - Add a file to be written when the transaction is committed.
+/// @param UTF-8 string of the full path of the file to replace
+/// @return a reference to the buffer to put the file's contents in. It stays
+/// valid for as long as the transaction does.
+///----------------------------------------------------------------------------
+
+std::string& FileTransaction::addFile(const std::string& filePath) {
+
+    StagedFile* stagedFile = new StagedFile;
+    stagedFile->filePath        = filePath;
+    stagedFile->tempFilePath    = filePath + FileTransactionConstants::TempExtension;
+    stagedFile->backupFilePath  = filePath + FileTransactionConstants::BackupExtension;
+    stagedFile->tempCreated     = false;
+    stagedFile->backupCreated   = false;
+    stagedFile->hadOriginal     = false;
+    stagedFile->replaced        = false;
+
+    stagedFiles.push_back(stagedFile);
+    return stagedFile->contents;
+
+}
+
+///----------------------------------------------------------------------------
+/// commit - Write every file that was added. The data is flushed to disk
+/// for all of the files at once before any of them are renamed, and the
+/// directory is synced once at the end. See the class for what happens if
+/// it fails part way through.
+/// @throws runtime_error if the files could not be written. Unless it says
+/// that files could not be restored, none of the original files were
+/// changed.
+///----------------------------------------------------------------------------
+
+void FileTransaction::commit() {
+
+    if(committed) {
+        return;
+    }
+
+    try {
+        writeTempFiles();
+        backupOriginals();
+        renameTempFiles();
+    }
+    catch (const std::runtime_error&) {
+        rollback();
+        throw;
+    }
+
+    committed = true;
+
+    // The files are already in place at this point. Syncing the directory
+    // makes sure the renames themselves survive a power failure, and only
+    // then are the backups no longer needed.
+    syncDirectories();
+    removeBackups();
+
+}
+
+///----------------------------------------------------------------------------
+/// rollback - Remove any temporary files and backups that were created.
+/// Files that were already renamed into place are not affected; commit puts
+/// them back itself if it fails.
+///----------------------------------------------------------------------------
+
+void FileTransaction::rollback() {
+    removeTempFiles();
+    removeBackups();
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// writeTempFiles - Write the contents of each file to its temporary file,
+/// then flush them all to disk. Flushing after everything is written lets
+/// the disk write them out together instead of waiting on each one.
+/// @throws runtime_error if any file could not be written.
+///----------------------------------------------------------------------------
+
+void FileTransaction::writeTempFiles() {
+
+    const size_t numFiles = stagedFiles.size();
+
+#ifdef _WIN32
+
+    std::vector<HANDLE> fileHandles(numFiles, INVALID_HANDLE_VALUE);
+    std::string errorMsg;
+
+    for(size_t i = 0; i < numFiles && errorMsg.empty(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+#ifdef __WIN9X_COMPAT__
+        fileHandles[i] = CreateFileA(stagedFile.tempFilePath.c_str(), GENERIC_WRITE, 0, NULL,
+                                     CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+        fileHandles[i] = CreateFileW(toWidePath(stagedFile.tempFilePath).c_str(), GENERIC_WRITE, 0, NULL,
+                                     CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+#endif // __WIN9X_COMPAT__
+
+        if(fileHandles[i] == INVALID_HANDLE_VALUE) {
+            errorMsg = "Could not create " + stagedFile.tempFilePath + ".";
+            break;
+        }
+
+        stagedFile.tempCreated = true;
+
+        DWORD bytesWritten = 0;
+        const DWORD contentSize = static_cast<DWORD>(stagedFile.contents.size());
+
+        if(contentSize != 0 && (!WriteFile(fileHandles[i], stagedFile.contents.data(), contentSize, &bytesWritten, NULL) ||
+                                bytesWritten != contentSize)) {
+            errorMsg = "Could not write " + stagedFile.tempFilePath + ".";
+        }
+    }
+
+    for(size_t i = 0; i < numFiles; ++i) {
+
+        if(fileHandles[i] == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+
+        if(errorMsg.empty() && !FlushFileBuffers(fileHandles[i])) {
+            errorMsg = "Could not flush " + stagedFiles[i]->tempFilePath + " to disk.";
+        }
+
+        CloseHandle(fileHandles[i]);
+    }
+
+#else
+
+    std::vector<int> fileDescriptors(numFiles, -1);
+    std::string errorMsg;
+
+    for(size_t i = 0; i < numFiles && errorMsg.empty(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+        fileDescriptors[i] = open(stagedFile.tempFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+        if(fileDescriptors[i] == -1) {
+            errorMsg = "Could not create " + stagedFile.tempFilePath + ": " + strerror(errno);
+            break;
+        }
+
+        stagedFile.tempCreated = true;
+
+        // Give the new file the same permissions as the one it replaces,
+        // rather than whatever the umask allows.
+
+        struct stat originalInfo;
+
+        if(stat(stagedFile.filePath.c_str(), &originalInfo) == 0 &&
+           fchmod(fileDescriptors[i], originalInfo.st_mode & 07777) != 0) {
+            errorMsg = "Could not set the permissions of " + stagedFile.tempFilePath + ": " + strerror(errno);
+            break;
+        }
+
+        const char* data = stagedFile.contents.data();
+        size_t bytesLeft = stagedFile.contents.size();
+
+        while(bytesLeft != 0) {
+
+            const ssize_t bytesWritten = write(fileDescriptors[i], data, bytesLeft);
+
+            if(bytesWritten < 0) {
+
+                if(errno == EINTR) {
+                    continue;
+                }
+
+                errorMsg = "Could not write " + stagedFile.tempFilePath + ": " + strerror(errno);
+                break;
+            }
+
+            data += bytesWritten;
+            bytesLeft -= static_cast<size_t>(bytesWritten);
+        }
+    }
+
+    for(size_t i = 0; i < numFiles; ++i) {
+
+        if(fileDescriptors[i] == -1) {
+            continue;
+        }
+
+        if(errorMsg.empty() && fsync(fileDescriptors[i]) != 0) {
+            errorMsg = "Could not flush " + stagedFiles[i]->tempFilePath + " to disk: " + strerror(errno);
+        }
+
+        if(close(fileDescriptors[i]) != 0 && errorMsg.empty()) {
+            errorMsg = "Could not write " + stagedFiles[i]->tempFilePath + ": " + strerror(errno);
+        }
+    }
+
+#endif // _WIN32
+
+    if(!errorMsg.empty()) {
+        throw std::runtime_error(errorMsg);
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// backupOriginals - Back up each file that is about to be replaced, so it
+/// can be put back if the transaction fails part way through replacing them.
+/// A hard link is used where possible, as it costs nothing to make.
+/// @throws runtime_error if a file could not be backed up.
+///----------------------------------------------------------------------------
+
+void FileTransaction::backupOriginals() {
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+#ifdef _WIN32
+
+#ifdef __WIN9X_COMPAT__
+        const bool backedUp = CopyFileA(stagedFile.filePath.c_str(), stagedFile.backupFilePath.c_str(), FALSE) != 0;
+#else
+        const bool backedUp = CopyFileW(toWidePath(stagedFile.filePath).c_str(),
+                                        toWidePath(stagedFile.backupFilePath).c_str(), FALSE) != 0;
+#endif // __WIN9X_COMPAT__
+
+        const DWORD lastError = backedUp ? ERROR_SUCCESS : GetLastError();
+        const bool notFound = (lastError == ERROR_FILE_NOT_FOUND || lastError == ERROR_PATH_NOT_FOUND);
+
+#else
+
+        unlink(stagedFile.backupFilePath.c_str());
+
+        bool backedUp = link(stagedFile.filePath.c_str(), stagedFile.backupFilePath.c_str()) == 0;
+        const bool notFound = !backedUp && errno == ENOENT;
+
+        if(!backedUp && !notFound) {
+            backedUp = copyFile(stagedFile.filePath, stagedFile.backupFilePath);
+        }
+
+#endif // _WIN32
+
+        if(notFound) {
+            continue;
+        }
+
+        if(!backedUp) {
+            throw std::runtime_error("Could not back up " + stagedFile.filePath + ".");
+        }
+
+        stagedFile.hadOriginal = true;
+        stagedFile.backupCreated = true;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// renameTempFiles - Move each temporary file over the file it replaces. If
+/// one cannot be moved, the files already replaced are restored.
+/// @throws runtime_error if a file could not be renamed.
+///----------------------------------------------------------------------------
+
+void FileTransaction::renameTempFiles() {
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+        if(!replaceFile(stagedFile.tempFilePath, stagedFile.filePath)) {
+
+            std::string errorMsg = "Could not replace " + stagedFile.filePath + ".";
+            const std::string notRestored = restoreOriginals();
+
+            if(!notRestored.empty()) {
+                errorMsg.append(" These files could not be restored, and are partly saved:" + notRestored);
+            }
+
+            throw std::runtime_error(errorMsg);
+        }
+
+        stagedFile.tempCreated = false;
+        stagedFile.replaced = true;
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// restoreOriginals - Put back each file that was replaced. Files that did
+/// not exist before are removed. Backups that could not be put back are kept
+/// so nothing is lost.
+/// @return the paths of any files that could not be restored, each after a
+/// space, or an empty string if they all were.
+///----------------------------------------------------------------------------
+
+std::string FileTransaction::restoreOriginals() {
+
+    std::string notRestored;
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+        if(!stagedFile.replaced) {
+            continue;
+        }
+
+        bool restored;
+
+        if(stagedFile.hadOriginal) {
+            restored = replaceFile(stagedFile.backupFilePath, stagedFile.filePath);
+            stagedFile.backupCreated = false; // Moved back, or kept for the user.
+        }
+        else {
+            restored = deleteFile(stagedFile.filePath);
+        }
+
+        if(restored) {
+            stagedFile.replaced = false;
+        }
+        else {
+            notRestored.append(" " + stagedFile.filePath);
+        }
+    }
+
+    return notRestored;
+
+}
+
+///----------------------------------------------------------------------------
+/// syncDirectories - Flush the directory entries of the renamed files to
+/// disk. Each directory is only synced once, and a world's files all share
+/// one. On Windows there is no directory to sync, and each rename was
+/// written through by MOVEFILE_WRITE_THROUGH instead, one flush per file.
+///----------------------------------------------------------------------------
+
+void FileTransaction::syncDirectories() {
+
+#ifndef _WIN32
+
+    std::vector<std::string> directories;
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        const std::string& filePath = stagedFiles[i]->filePath;
+        const size_t separatorPos = filePath.find_last_of('/');
+        const std::string directory = (separatorPos == std::string::npos) ? "." : filePath.substr(0, separatorPos + 1);
+
+        bool alreadySynced = false;
+
+        for(size_t k = 0; k < directories.size(); ++k) {
+            if(directories[k] == directory) {
+                alreadySynced = true;
+                break;
+            }
+        }
+
+        if(alreadySynced) {
+            continue;
+        }
+
+        directories.push_back(directory);
+
+        const int directoryFD = open(directory.c_str(), O_RDONLY);
+
+        if(directoryFD != -1) {
+            fsync(directoryFD);
+            close(directoryFD);
+        }
+    }
+
+#endif // _WIN32
+
+}
+
+///----------------------------------------------------------------------------
+/// removeTempFiles - Delete any temporary files that are still around.
+///----------------------------------------------------------------------------
+
+void FileTransaction::removeTempFiles() {
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+        if(stagedFile.tempCreated) {
+            deleteFile(stagedFile.tempFilePath);
+            stagedFile.tempCreated = false;
+        }
+    }
+
+}
+
+///----------------------------------------------------------------------------
+/// removeBackups - Delete any backups that are still around.
+///----------------------------------------------------------------------------
+
+void FileTransaction::removeBackups() {
+
+    for(size_t i = 0; i < stagedFiles.size(); ++i) {
+
+        StagedFile& stagedFile = *stagedFiles[i];
+
+        if(stagedFile.backupCreated) {
+            deleteFile(stagedFile.backupFilePath);
+            stagedFile.backupCreated = false;
+        }
+    }
+
+}
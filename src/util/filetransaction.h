@@ -0,0 +1,78 @@
+#ifndef __FILETRANSACTION_H__
+#define __FILETRANSACTION_H__
+
+#include <string>
+#include <vector>
+
+namespace FileTransactionConstants {
+    const std::string TempExtension     = ".tmp";
+    const std::string BackupExtension   = ".bak";
+}
+
+///----------------------------------------------------------------------------
+/// FileTransaction - Writes a group of files so that, unless the program
+/// stops part way through, either all of them are replaced or none are.
+///
+/// Each file is written to a temporary file next to it, with the same
+/// permissions as the file it replaces, and every temporary file is flushed
+/// to disk. Each original is then backed up to a .bak file (a hard link
+/// where the file system allows it, otherwise a copy), and only then are the
+/// temporary files renamed over the originals, one at a time.
+///
+/// If anything fails before the renames, the temporary files and backups are
+/// removed and the originals are left untouched. If a rename fails, the
+/// files already replaced are put back from their backups, and files that
+/// did not exist before are removed. If even that fails, the error says
+/// which files are left partly saved, and their backups are kept. If the
+/// program or machine stops during the renames, some files may be replaced
+/// and others not, with the backups of the originals left next to them.
+///
+/// On Windows, each rename is written through to disk, which is one flush
+/// per file rather than one directory sync for all of them. On 9x, which
+/// cannot rename over a file, each original is deleted just before its
+/// temporary file is renamed, so for a moment only its backup exists.
+///----------------------------------------------------------------------------
+
+class FileTransaction {
+
+    public:
+
+        FileTransaction();
+        ~FileTransaction();
+
+        std::string& addFile(const std::string& filePath);
+        void commit();
+        void rollback();
+
+        size_t getNumFiles() const { return stagedFiles.size(); }
+
+    private:
+
+        struct StagedFile {
+            std::string     filePath;
+            std::string     tempFilePath;
+            std::string     backupFilePath;
+            std::string     contents;
+            bool            tempCreated;
+            bool            backupCreated;
+            bool            hadOriginal;    // If there was a file to replace.
+            bool            replaced;       // If the temporary file is in place.
+        };
+
+        FileTransaction(const FileTransaction&) {};
+        void operator=(const FileTransaction&) {};
+
+        void writeTempFiles();
+        void backupOriginals();
+        void renameTempFiles();
+        std::string restoreOriginals();
+        void syncDirectories();
+        void removeTempFiles();
+        void removeBackups();
+
+        std::vector<StagedFile*>    stagedFiles;
+        bool                        committed;
+
+};
+
+#endif // __FILETRANSACTION_H__
@@ -1,14 +1,20 @@
 #include "frost.h"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <vector>
+#include <stdexcept>
+#include "../compat/std_extras_compat.h"
+
+#ifdef _WIN32
+
 #include <io.h>
 
-#ifdef __linux__
+#else
 
 #include <unistd.h>
 
-#endif // __linux__
+#endif // _WIN32
 
 namespace Frost {
 
@@ -49,6 +55,34 @@ namespace Frost {
 
     }
 
+    ///------------------------------------------------------------------------
+    /// endsWith - Same as above, but checks a token.
+    ///------------------------------------------------------------------------
+
+    bool endsWith(const StringToken& str, const std::string& val) {
+
+        if(val.length() > str.length) {
+            return false;
+        }
+
+        return !memcmp(str.data + (str.length - val.length()), val.data(), val.length());
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// startsWith - Same as above, but checks a token.
+    ///------------------------------------------------------------------------
+
+    bool startsWith(const StringToken& str, const std::string& val) {
+
+        if(val.length() > str.length) {
+            return false;
+        }
+
+        return !memcmp(str.data, val.data(), val.length());
+
+    }
+
     ///------------------------------------------------------------------------
     /// split - Split the string into a collection of strings where it finds
     /// the given delimiter.
@@ -61,52 +95,247 @@ namespace Frost {
     std::vector<std::string> split(const std::string& str, const char& delimiter,
                                    const size_t& limit) {
 
-        size_t startPos         = 0;
-        size_t tokensParsed     = 0;
         std::vector<std::string> out;
-        std::string token;
-
-        if(limit == 0) {
-            return out;  // Nothing to do here.
-        }
 
         if(limit != -1) {
             out.reserve(limit);
         }
 
-        while(true) {
+        StringToken remaining(str);
+        StringToken token;
 
-            if(tokensParsed == limit) {
-                // Limit hit.
-                return out;
-            }
+        while(out.size() != limit && nextToken(remaining, delimiter, token)) {
+            out.push_back(token.toString());
+        }
+
+        return out;
+    }
+
+    ///------------------------------------------------------------------------
+    /// nextToken - Take the next token off the front of a string, up to the
+    /// delimiter. Like split, an empty token after the last delimiter is not
+    /// returned.
+    /// @param (in/out) what is left of the string, which has the token and
+    /// its delimiter removed from it.
+    /// @param value to split on
+    /// @param (out) the token found
+    /// @return true if a token was found, false if there was nothing left.
+    ///------------------------------------------------------------------------
+
+    bool nextToken(StringToken& remaining, const char& delimiter, StringToken& outToken) {
+
+        if(remaining.length == 0) {
+            return false;
+        }
+
+        const char* delimiterPos = static_cast<const char*>(memchr(remaining.data, delimiter, remaining.length));
+
+        if(delimiterPos == NULL) {
+            outToken = remaining;
+            remaining = StringToken(remaining.data + remaining.length, 0);
+            return true;
+        }
+
+        const size_t tokenLength = static_cast<size_t>(delimiterPos - remaining.data);
+        outToken = StringToken(remaining.data, tokenLength);
+        remaining = StringToken(delimiterPos + 1, remaining.length - tokenLength - 1);
+        return true;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// splitTokens - Split the string the same way split does, into an array
+    /// the caller provides.
+    /// @param string to split
+    /// @param value to split on
+    /// @param (out) array to store up to maxTokens tokens in
+    /// @param size of the array
+    /// @return how many tokens the string has, which can be more than were
+    /// stored.
+    ///------------------------------------------------------------------------
+
+    size_t splitTokens(const StringToken& str, const char& delimiter, StringToken* outTokens,
+                       const size_t& maxTokens) {
 
-            // Find next delimiter
-            const size_t pos = str.find(delimiter, startPos);
+        StringToken remaining = str;
+        StringToken token;
+        size_t numTokens = 0;
 
-            if(pos != std::string::npos) {
-                
-                // Extract the token, add it to the vector, and indicate that
-                // we parsed a token.
-                token = str.substr(startPos, pos - startPos);
-                out.push_back(token);
-                startPos = pos + 1;
-                tokensParsed++;
+        while(nextToken(remaining, delimiter, token)) {
 
+            if(numTokens < maxTokens) {
+                outTokens[numTokens] = token;
             }
-            else {
-                break; // No more delimiters found
+
+            numTokens++;
+        }
+
+        return numTokens;
+    }
+
+    ///------------------------------------------------------------------------
+    /// ltrimToken - Remove any of the characters in the needle from the start
+    /// of a token.
+    /// @param token to trim
+    /// @param characters to remove
+    /// @return the part of the token that is left
+    ///------------------------------------------------------------------------
+
+    StringToken ltrimToken(const StringToken& str, const char* needle) {
+
+        size_t startPos = 0;
+
+        while(startPos < str.length && str.data[startPos] != '\0' && strchr(needle, str.data[startPos])) {
+            ++startPos;
+        }
+
+        return StringToken(str.data + startPos, str.length - startPos);
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// rtrimToken - Remove any of the characters in the needle from the end of
+    /// a token.
+    /// @param token to trim
+    /// @param characters to remove
+    /// @return the part of the token that is left
+    ///------------------------------------------------------------------------
+
+    StringToken rtrimToken(const StringToken& str, const char* needle) {
+
+        size_t length = str.length;
+
+        while(length > 0 && str.data[length - 1] != '\0' && strchr(needle, str.data[length - 1])) {
+            --length;
+        }
+
+        return StringToken(str.data, length);
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// parseInteger - Convert text to an integer the same way std::stoi does,
+    /// but without throwing. Leading whitespace is skipped, and anything after
+    /// the digits is ignored.
+    /// @param pointer to the text to convert
+    /// @param number of characters in the text
+    /// @param (out) the integer, if it could be converted
+    /// @param (out) position in the text of the character that could not be
+    /// converted, if it could not be.
+    /// @return a ParseErrors code, NoError if the integer was converted.
+    ///------------------------------------------------------------------------
+
+    int parseInteger(const char* data, const size_t& length, int& outValue, size_t& outErrorPos) {
+
+        size_t pos = 0;
+
+        while(pos < length && isspace(static_cast<unsigned char>(data[pos]))) {
+            ++pos;
+        }
+
+        bool isNegative = false;
+
+        if(pos < length && (data[pos] == '-' || data[pos] == '+')) {
+            isNegative = data[pos] == '-';
+            ++pos;
+        }
+
+        if(pos == length || data[pos] < '0' || data[pos] > '9') {
+            outErrorPos = pos;
+            return ParseErrors::NotANumber;
+        }
+
+        // One past INT_MAX is allowed so INT_MIN can be read.
+        const uint32_t maxMagnitude = isNegative ? 2147483648U : 2147483647U;
+        uint32_t magnitude = 0;
+
+        for(; pos < length && data[pos] >= '0' && data[pos] <= '9'; ++pos) {
+
+            const uint32_t digit = static_cast<uint32_t>(data[pos] - '0');
+
+            if(magnitude > (maxMagnitude - digit) / 10) {
+                outErrorPos = pos;
+                return ParseErrors::OutOfRange;
             }
+
+            magnitude = (magnitude * 10) + digit;
         }
 
-        // Copy the rest of the string as a token, that is, if there is
-        // anything to copy.
-        if(startPos < str.length()) {
-            token = str.substr(startPos, std::string::npos);
-            out.push_back(token);
+        outValue = isNegative ? static_cast<int>(0 - magnitude) : static_cast<int>(magnitude);
+        return ParseErrors::NoError;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// toInteger - Convert a token to an integer, the same way std::stoi does.
+    /// @param token to convert
+    /// @return the integer
+    /// @throws invalid_argument if there are no digits to convert
+    /// @throws out_of_range if the number does not fit in an int
+    ///------------------------------------------------------------------------
+
+    int toInteger(const StringToken& str) {
+
+        int value = 0;
+        size_t errorPos;
+
+        switch(parseInteger(str.data, str.length, value, errorPos)) {
+            case ParseErrors::NotANumber:   throw std::invalid_argument("toInteger");
+            case ParseErrors::OutOfRange:   throw std::out_of_range("toInteger");
+            default:                        break;
         }
 
-        return out;
+        return value;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// positionString - Gets a human readable description of a place in a
+    /// file, for error messages.
+    /// @return a string in the form of " (line X, byte Y)"
+    ///------------------------------------------------------------------------
+
+    std::string positionString(const size_t& lineNumber, const size_t& offset) {
+        return " (line " + std::to_string(static_cast<int>(lineNumber)) + ", byte " +
+               std::to_string(static_cast<int>(offset)) + ")";
+    }
+
+    ///------------------------------------------------------------------------
+    /// toString - Describes the error for an error message.
+    /// @param the text that was being read, which is included in the message
+    /// if it was not a number.
+    /// @return a string such as: Expected a number, but got "x" (line 2,
+    /// byte 9)
+    ///------------------------------------------------------------------------
+
+    std::string ParseError::toString(const StringToken& value) const {
+
+        std::string message;
+
+        switch(code) {
+
+            case ParseErrors::NotANumber:
+                message = "Expected a number";
+                if(value.data != NULL) {
+                    message += ", but got \"" + value.toString() + "\"";
+                }
+                break;
+
+            case ParseErrors::OutOfRange:
+                message = "Number out of range";
+                break;
+
+            case ParseErrors::EndOfFile:
+                message = "Unexpected end of file";
+                break;
+
+            default:
+                message = "No error";
+                break;
+        }
+
+        return message + positionString(lineNumber, offset);
+
     }
 
     ///------------------------------------------------------------------------
@@ -143,21 +372,7 @@ namespace Frost {
     ///------------------------------------------------------------------------
 
     std::string ltrim(const std::string& str, const std::string& needle) {
-        
-        if(str.length() == 0 || needle.length() == 0) {
-            return str;
-        }
-        
-        const size_t firstPos = str.find_first_not_of(needle);
-
-        if(firstPos == std::string::npos) {
-            // String contains only the characters in the needle, so it's
-            // effectively empty.
-            return "";
-        }
-
-        return str.substr(firstPos, str.length() - firstPos);
-
+        return ltrimToken(StringToken(str), needle.c_str()).toString();
     }
 
     ///------------------------------------------------------------------------
@@ -168,138 +383,188 @@ namespace Frost {
     ///------------------------------------------------------------------------
 
     std::string rtrim(const std::string& str, const std::string& needle) {
-        
-        if(str.length() == 0 || needle.length() == 0) {
-            return str;
+        return rtrimToken(StringToken(str), needle.c_str()).toString();
+    }
+
+    ///------------------------------------------------------------------------
+    /// getLineWindows - Reads a line, removing the CR from the end of it. The
+    /// string is trimmed in place, so no new string is made.
+    /// @param stream to read from
+    /// @param (out) string to read the line into
+    ///------------------------------------------------------------------------
+
+    void getLineWindows(std::istream& is, std::string& str) {
+        std::getline(is, str);
+        str.resize(rtrimToken(StringToken(str), "\r").length);
+    }
+
+    ///------------------------------------------------------------------------
+    /// getVBString - Reads a line, and removes the quotes around it. Quotes
+    /// inside the line are not unescaped. See readVBString for that.
+    /// @param stream to read from
+    /// @param (out) string to read the line into
+    ///------------------------------------------------------------------------
+
+    void getVBString(std::istream& is, std::string& str) {
+
+        getLineWindows(is, str);
+
+        const StringToken trimmed = trimToken(StringToken(str), "\"");
+        const size_t startPos = static_cast<size_t>(trimmed.data - str.data());
+
+        str.resize(startPos + trimmed.length);
+        str.erase(0, startPos);
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// decodeVBLine - Unescapes one line of a VB String in a single forward
+    /// pass. Pairs of quotes become one quote, and a run of an odd number of
+    /// quotes right before the CR LF is the end of the string. Anything else,
+    /// such as a lone quote in the middle of a line, is left to
+    /// decodeVBLineExact.
+    /// @param line to decode, without its LF
+    /// @param position in the line to start decoding at
+    /// @param (out) string to append the decoded text to
+    /// @param (out) set to true if the line ends the string
+    /// @return false if the line could not be decoded this way. Nothing is
+    /// appended in that case.
+    ///------------------------------------------------------------------------
+
+    static bool decodeVBLine(const std::string& line, const size_t& startPos, std::string& outStr,
+                             bool& foundEndString) {
+
+        if (line.empty() || line[line.size() - 1] != '\r' || line.size() <= startPos) {
+            return false;
         }
-        
-        const size_t lastPos = str.find_last_not_of(needle);
 
-        if(lastPos == std::string::npos) {
-            // String contains only the characters in the needle, so it's
-            // effectively empty.
-            return "";
+        const size_t restoreSize = outStr.size();
+        const char* const lineData = line.data();
+        const size_t endPos = line.size() - 1;   // Position of the CR
+        size_t pos = startPos;
+
+        foundEndString = false;
+
+        while (pos < endPos) {
+
+            const char* quote = static_cast<const char*>(memchr(lineData + pos, '\"', endPos - pos));
+
+            if (quote == NULL) {
+                outStr.append(lineData + pos, endPos - pos);
+                break;
+            }
+
+            const size_t quotePos = quote - lineData;
+            outStr.append(lineData + pos, quotePos - pos);
+
+            size_t runEnd = quotePos;
+            while (runEnd < endPos && line[runEnd] == '\"') {
+                ++runEnd;
+            }
+
+            const size_t runLength = runEnd - quotePos;
+
+            if (runLength % 2 != 0) {
+
+                // Only the last quote on the line can end the string.
+
+                if (runEnd != endPos) {
+                    outStr.resize(restoreSize);
+                    return false;
+                }
+
+                outStr.append(runLength / 2, '\"');
+                foundEndString = true;
+                return true;
+            }
+
+            outStr.append(runLength / 2, '\"');
+            pos = runEnd;
+
         }
 
-        return str.substr(0, lastPos+1);
+        outStr.append("\r\n", 2);
+        return true;
 
     }
 
     ///------------------------------------------------------------------------
-    /// readVBString - Reads a VB String.
-    /// @param Reference to an input stream
-    /// @param string to be read into
-    /// @throws IOException Error if a string could not be read
+    /// decodeVBLineExact - Unescapes one line of a VB String the way the
+    /// editor always has, including for lines that were not written by VB.
+    /// The line is searched backwards for the end quote, pairing quotes up as
+    /// it goes, and the second quote of each pair removes the character after
+    /// it. Lines without a CR keep their last character out of the search, and
+    /// the end of the string always drops the last 3 characters.
+    /// @param line to decode, without its LF
+    /// @param position in the line to start decoding at
+    /// @param (out) string to append the decoded text to
+    /// @param (out) set to true if the line ends the string
     ///------------------------------------------------------------------------
 
-    std::string Frost::readVBString(std::istream& is) {
+    static void decodeVBLineExact(const std::string& line, const size_t& startPos, std::string& outStr,
+                                  bool& foundEndString) {
 
-        // Visual Basic Escapes Double Quotes, with a second Double Quote.
-        // So as such, we need to locate the true end quote: <"><CR><LF>
-        
-        std::string outStr;
-        std::string curLine;
-        bool firstLine = true;
+        // Decode as if the LF were still on the end of the line.
 
+        const size_t numChars = line.size() - startPos + 1;
+        std::vector<bool> removeChar(numChars, false);
 
-        do {
+        foundEndString = false;
 
-            // So the first thing to do is get the next line.
+        if (numChars > 2) {
 
-            std::getline(is, curLine);
+            bool foundEndQuote = false;
 
-            if (!is.fail()) {
+            for (size_t i = numChars - 2; i != 0; --i) {
 
-                if (!is.eof()) {
-                    // We need to ensure that the new line is present in the string read.
-                    curLine.push_back('\n');
-                }
-                else {
-                    throw std::runtime_error("Reached end of file without finding the end of the string.");
-                }
+                if (line[startPos + i - 1] == '\"') {
 
-                // If this is the first line read, we need to do some checks
-                if (firstLine) {
-                    
-                    // For instance, it must start with a double quote
-                    if (curLine[0] != '\"') {
-                        throw std::runtime_error("Value read was not a valid Visual Basic String.");
-                    }
-                    else if (curLine.size() == 4) {
-                        // And we know if it's exactly 4 characters long that
-                        // this is an empty string, and that double quotes here
-                        // is not an escape.
-                        if (!curLine.compare("\"\"\r\n")) {
-                            return ""; // Empty String
-                        }
+                    if (foundEndQuote) {
+                        removeChar[i] = true;
                     }
-                    
-                    // Valid string, so remove the starting quote.
-                    curLine = curLine.substr(1, std::string::npos);
-                    //curLine = outStr;
-                    firstLine = false;
 
+                    foundEndQuote = !foundEndQuote;
                 }
-                else {
-                    //outStr += curLine;
+                else if (foundEndQuote && !foundEndString) {
+                    foundEndString = true;
+                    foundEndQuote = false;
                 }
+            }
 
-                
-                bool foundEndString = false;
-
-                // Now we need to begin our search for the end quote,
-                // we will search each new line for a quote that has no
-                // second quote directly left of it.
-
-                if (curLine.size() > 2) {
-                    bool foundEndQuote = false;
-                    const size_t numChars = curLine.size() - 2;
-                    for (int i = numChars; i != 0; --i) {
-                        
-                        // If we find a quote once, it is possibly the end
-                        // but if we find another one space to the left,
-                        // the we can assume that it's a escaped double quote
-                        if (curLine[i-1] == '"') {
-                            
-                            if (foundEndQuote) {
-                                // Double quote found, so remove the double
-                                curLine.erase(i, 1);
-                            }
-
-                            foundEndQuote = !foundEndQuote;
-                        }
-                        else if (foundEndQuote == true && foundEndString == false) {
-                            // We found the ending quote, so we know this is the
-                            // last line in the string, but we'll continue on
-                            // to capture all the other ""'s on this line.
-                            foundEndString = true;
-                            foundEndQuote = false;
-                        }
-                    }
+            if (foundEndQuote) {
+                foundEndString = true;
+            }
 
-                    if (foundEndQuote) {
-                        foundEndString = true;
-                    }
+        }
 
-                }
+        for (size_t i = 0; i + 1 < numChars; ++i) {
+            if (!removeChar[i]) {
+                outStr.push_back(line[startPos + i]);
+            }
+        }
 
-                // Since we found the end of the string, we can chop off the
-                // last three characters.
+        outStr.push_back('\n');
 
-                outStr += curLine;
+        if (foundEndString) {
+            outStr.resize(outStr.size() - 3);
+        }
 
-                if (foundEndString) {
-                    
-                    outStr = outStr.substr(0, outStr.size() - 3);
-                    break;
-                }
+    }
 
-            }
-            else {
-                throw std::runtime_error("Failed to read from input stream.");
-            }
+    ///------------------------------------------------------------------------
+    /// readVBString - Reads a VB String. Visual Basic escapes double quotes
+    /// with a second double quote, so the string ends at the first quote with
+    /// no partner that is followed by a CR LF. Strings can span many lines.
+    /// @param Reference to an input stream
+    /// @return the string read, without its quotes or escapes.
+    /// @throws runtime_error if a string could not be read
+    ///------------------------------------------------------------------------
 
-        } while (!is.eof() && !is.fail());
+    std::string readVBString(std::istream& is) {
+
+        LineReader lineReader(is);
+        std::string outStr;
+        lineReader.readVBString(outStr);
 
         return outStr;
     }
@@ -341,22 +606,331 @@ namespace Frost {
     ///------------------------------------------------------------------------
 
     void writeVBString(std::ostream& os, const std::string& str) {
-        
+
         os.write("\"", 1);
-        std::string outStr = str;
 
-        // Escape double quotes
-        for (size_t i = 0; i < outStr.size(); ++i) {
-            if(outStr[i] == '\"') {
-                outStr.insert(i, 1, '\"');
-                ++i;
-            }
+        const char* const strData = str.data();
+        size_t chunkStart = 0;
+        size_t quotePos = str.find('\"');
+
+        // Write up to and including each quote, then add the second quote
+        // that escapes it, so nothing is copied or shifted.
+
+        while (quotePos != std::string::npos) {
+            os.write(strData + chunkStart, (quotePos + 1) - chunkStart);
+            os.write("\"", 1);
+            chunkStart = quotePos + 1;
+            quotePos = str.find('\"', chunkStart);
         }
 
-        os.write(&outStr[0], outStr.length());
+        os.write(strData + chunkStart, str.length() - chunkStart);
         os.write("\"\r\n", 3);
     }
 
+    ///------------------------------------------------------------------------
+    /// writeVBInteger - Same as above, but appends the integer to a buffer.
+    /// The number is formatted by hand, as going through a stream is many
+    /// times slower and can be changed by the locale.
+    /// @param buffer to append to
+    /// @param integer to write
+    ///------------------------------------------------------------------------
+
+    void writeVBInteger(std::string& buffer, const int32_t& intVal) {
+
+        // Enough for " -2147483648 \r\n", filled in from the end.
+        char digits[16];
+        char* current = digits + sizeof(digits);
+
+        *(--current) = '\n';
+        *(--current) = '\r';
+        *(--current) = ' ';
+
+        // Work with the magnitude as unsigned so INT32_MIN does not overflow.
+        uint32_t magnitude = intVal < 0 ? 0 - static_cast<uint32_t>(intVal) : static_cast<uint32_t>(intVal);
+
+        do {
+            *(--current) = static_cast<char>('0' + (magnitude % 10));
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        *(--current) = intVal < 0 ? '-' : ' ';
+
+        buffer.append(current, (digits + sizeof(digits)) - current);
+    }
+
+    ///------------------------------------------------------------------------
+    /// writeVBLine - Same as above, but appends the line to a buffer.
+    /// @param buffer to append to
+    /// @param single line string to write
+    ///------------------------------------------------------------------------
+
+    void writeVBLine(std::string& buffer, const std::string& line) {
+        writeVBLine(buffer, StringToken(line));
+    }
+
+    ///------------------------------------------------------------------------
+    /// writeVBLine - Same as above, but takes a token, so text that has not
+    /// been copied into a string can be written.
+    /// @param buffer to append to
+    /// @param single line to write
+    ///------------------------------------------------------------------------
+
+    void writeVBLine(std::string& buffer, const StringToken& line) {
+        buffer.append(line.data, line.length);
+        buffer.append("\r\n", 2);
+    }
+
+    ///------------------------------------------------------------------------
+    /// writeVBString - Same as above, but appends the string to a buffer.
+    /// @param buffer to append to
+    /// @param String to write.
+    ///------------------------------------------------------------------------
+
+    void writeVBString(std::string& buffer, const std::string& str) {
+        writeVBString(buffer, StringToken(str));
+    }
+
+    ///------------------------------------------------------------------------
+    /// writeVBString - Same as above, but takes a token.
+    /// @param buffer to append to
+    /// @param String to write.
+    ///------------------------------------------------------------------------
+
+    void writeVBString(std::string& buffer, const StringToken& str) {
+
+        buffer.push_back('\"');
+
+        const char* chunkStart = str.data;
+        const char* const strEnd = str.data + str.length;
+        const char* quotePos = static_cast<const char*>(memchr(chunkStart, '\"', str.length));
+
+        // Copy up to and including each quote, then add the second quote
+        // that escapes it.
+
+        while (quotePos != NULL) {
+            buffer.append(chunkStart, (quotePos + 1) - chunkStart);
+            buffer.push_back('\"');
+            chunkStart = quotePos + 1;
+            quotePos = static_cast<const char*>(memchr(chunkStart, '\"', strEnd - chunkStart));
+        }
+
+        buffer.append(chunkStart, strEnd - chunkStart);
+        buffer.append("\"\r\n", 3);
+    }
+
+    //=========================================================================
+    // LineReader
+    //=========================================================================
+
+    ///------------------------------------------------------------------------
+    /// getLineWindows - Reads a line, removing the CR from the end of it.
+    /// @return the line, which is only valid until the next read.
+    ///------------------------------------------------------------------------
+
+    const std::string& LineReader::getLineWindows() {
+        readRawLine();
+        line.resize(rtrimToken(StringToken(line), "\r").length);
+        return line;
+    }
+
+    ///------------------------------------------------------------------------
+    /// getVBString - Reads a line, and removes the quotes around it. Quotes
+    /// inside the line are not unescaped. See readVBString for that.
+    /// @return the line, which is only valid until the next read.
+    ///------------------------------------------------------------------------
+
+    const std::string& LineReader::getVBString() {
+
+        getLineWindows();
+
+        const StringToken trimmed = trimToken(StringToken(line), "\"");
+        const size_t startPos = static_cast<size_t>(trimmed.data - line.data());
+
+        line.resize(startPos + trimmed.length);
+        line.erase(0, startPos);
+        textOffset += startPos;
+
+        return line;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// readVBString - Reads a VB String, which may span many lines. See
+    /// Frost::readVBString.
+    /// @param (out) string to store the string read in
+    /// @throws runtime_error if a string could not be read
+    ///------------------------------------------------------------------------
+
+    void LineReader::readVBString(std::string& outStr) {
+
+        outStr.clear();
+        bool firstLine = true;
+
+        do {
+
+            if (!readRawLine()) {
+                throw std::runtime_error("Failed to read from input stream" +
+                                         Frost::positionString(lineNumber + 1, nextOffset) + ".");
+            }
+
+            // The line must have ended with a LF, or the string never ends.
+
+            if (is.eof()) {
+                throw std::runtime_error("Reached end of file without finding the end of the string" +
+                                         positionString() + ".");
+            }
+
+            size_t startPos = 0;
+
+            if (firstLine) {
+
+                if (line.empty() || line[0] != '\"') {
+                    throw std::runtime_error("Value read was not a valid Visual Basic String" +
+                                             positionString() + ".");
+                }
+
+                // "" on its own is an empty string, not an escaped quote.
+
+                if (line.size() == 3 && !line.compare("\"\"\r")) {
+                    return;
+                }
+
+                // Most strings fit on one line, so this is usually exact.
+                outStr.reserve(line.size());
+
+                startPos = 1;
+                firstLine = false;
+
+            }
+
+            bool foundEndString = false;
+
+            if (!decodeVBLine(line, startPos, outStr, foundEndString)) {
+                decodeVBLineExact(line, startPos, outStr, foundEndString);
+            }
+
+            if (foundEndString) {
+                break;
+            }
+
+        } while (!is.eof() && !is.fail());
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// tryReadInteger - Reads the next line as an integer without throwing.
+    /// If it fails, getLastError says why and where.
+    /// @param (out) the integer read, if there was one
+    /// @return a ParseErrors code, NoError if an integer was read.
+    ///------------------------------------------------------------------------
+
+    int LineReader::tryReadInteger(int& outValue) {
+
+        if(!readRawLine()) {
+            lastError.code          = ParseErrors::EndOfFile;
+            lastError.offset        = nextOffset;
+            lastError.lineNumber    = lineNumber + 1;
+            return lastError.code;
+        }
+
+        size_t errorPos = 0;
+        const int errorCode = Frost::parseInteger(line.data(), line.size(), outValue, errorPos);
+
+        if(errorCode != ParseErrors::NoError) {
+            lastError.code          = errorCode;
+            lastError.offset        = lineOffset + errorPos;
+            lastError.lineNumber    = lineNumber;
+        }
+
+        return errorCode;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// readInteger - Reads the next line as an integer.
+    /// @return the integer read
+    /// @throws runtime_error saying where the line is if it is not a number,
+    /// is out of range, or the stream ended.
+    ///------------------------------------------------------------------------
+
+    int LineReader::readInteger() {
+
+        int value = 0;
+
+        if(tryReadInteger(value) != ParseErrors::NoError) {
+            throw std::runtime_error(lastError.toString(rtrimToken(StringToken(line), "\r")));
+        }
+
+        return value;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// tryParseInteger - Converts part of the last line read to an integer
+    /// without throwing. If it fails, getLastError says why and where.
+    /// @param token to convert, which must point into the last line read
+    /// @param (out) the integer, if there was one
+    /// @return a ParseErrors code, NoError if an integer was read.
+    ///------------------------------------------------------------------------
+
+    int LineReader::tryParseInteger(const StringToken& token, int& outValue) {
+
+        size_t errorPos = 0;
+        const int errorCode = Frost::parseInteger(token.data, token.length, outValue, errorPos);
+
+        if(errorCode != ParseErrors::NoError) {
+            lastError.code          = errorCode;
+            lastError.offset        = textOffset + static_cast<size_t>(token.data - line.data()) + errorPos;
+            lastError.lineNumber    = lineNumber;
+        }
+
+        return errorCode;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// parseInteger - Converts part of the last line read to an integer.
+    /// @param token to convert, which must point into the last line read
+    /// @return the integer
+    /// @throws runtime_error saying where the token is if it is not a number
+    /// or it is out of range.
+    ///------------------------------------------------------------------------
+
+    int LineReader::parseInteger(const StringToken& token) {
+
+        int value = 0;
+
+        if(tryParseInteger(token, value) != ParseErrors::NoError) {
+            throw std::runtime_error(lastError.toString(token));
+        }
+
+        return value;
+
+    }
+
+    ///------------------------------------------------------------------------
+    /// readRawLine - Reads the next line, CR and all, keeping count of where
+    /// it is in the stream.
+    /// @return false if there was nothing left to read, true otherwise.
+    ///------------------------------------------------------------------------
+
+    bool LineReader::readRawLine() {
+
+        lineOffset = nextOffset;
+        textOffset = nextOffset;
+        std::getline(is, line);
+
+        if(is.fail()) {
+            return false;
+        }
+
+        lineNumber++;
+        nextOffset += line.size() + (is.eof() ? 0 : 1);
+
+        return true;
+
+    }
+
     ///------------------------------------------------------------------------
     /// DoesFileExist - Checks if a file exists
     /// @return true if the file exists, false if it does not
@@ -372,12 +946,12 @@ namespace Frost {
         return _waccess_s(fullPath.c_str(), 0) ? false : true;
     }
     
-#elif __linux__
+#else
 
-    bool doesFileExist(const std::string& filePath) {
+    bool doesFileExist(const std::string& fullPath) {
         return !access(fullPath.c_str(), F_OK);
     }
     
-#endif  // __WIN32__
+#endif  // _WIN32
 
 }
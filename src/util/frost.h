@@ -8,8 +8,58 @@
 
 namespace Frost {
 
+    ///------------------------------------------------------------------------
+    /// StringToken - A piece of a string that is not copied. It is only valid
+    /// for as long as the string it points into is not changed or destroyed.
+    ///------------------------------------------------------------------------
+
+    struct StringToken {
+
+        StringToken() : data(NULL), length(0) {}
+        StringToken(const char* inData, const size_t& inLength) : data(inData), length(inLength) {}
+        explicit StringToken(const std::string& str) : data(str.data()), length(str.length()) {}
+
+        bool empty() const { return length == 0; }
+        std::string toString() const { return std::string(data, length); }
+
+        const char*     data;
+        size_t          length;
+
+    };
+
+    namespace ParseErrors {
+        enum pe {
+            NoError     = 0,
+            NotANumber  = 1,
+            OutOfRange  = 2,
+            EndOfFile   = 3
+        };
+    }
+
+    ///------------------------------------------------------------------------
+    /// ParseError - Why and where reading a value failed. The offset is the
+    /// byte in the file of the character that could not be read, and lines
+    /// are numbered from 1.
+    ///------------------------------------------------------------------------
+
+    struct ParseError {
+
+        ParseError() : code(ParseErrors::NoError), offset(0), lineNumber(0) {}
+
+        std::string toString(const StringToken& value = StringToken()) const;
+
+        int             code;
+        size_t          offset;
+        size_t          lineNumber;
+
+    };
+
+    std::string positionString(const size_t& lineNumber, const size_t& offset);
+
     bool endsWith(const std::string& str, const std::string& val);
     bool startsWith(const std::string& str, const std::string& val);
+    bool endsWith(const StringToken& str, const std::string& val);
+    bool startsWith(const StringToken& str, const std::string& val);
     std::vector<std::string> split(const std::string& str, const char& delimiter, const size_t& limit = -1);
     inline std::string toLower(const std::string& str);
     inline std::string toUpper(const std::string& str);
@@ -17,8 +67,20 @@ namespace Frost {
     std::string rtrim(const std::string& str, const std::string& needle = " ");
     inline std::string trim(const std::string& str, const std::string& needle = " ") { return ltrim(rtrim(str, needle), needle); }
     inline bool isCharANSI(const wchar_t& ch) { if(ch < 32 || ch > 255) { return false; } return true; }
-    inline void getLineWindows(std::istream& is, std::string& str) { std::getline(is, str); str = rtrim(str, "\r"); }
-    inline void getVBString(std::istream& is, std::string& str) { getLineWindows(is, str); str = trim(str, "\""); }
+
+    // Allocation free versions of the above. Trimming removes any of the
+    // characters in the needle.
+
+    bool nextToken(StringToken& remaining, const char& delimiter, StringToken& outToken);
+    size_t splitTokens(const StringToken& str, const char& delimiter, StringToken* outTokens, const size_t& maxTokens);
+    StringToken ltrimToken(const StringToken& str, const char* needle = " ");
+    StringToken rtrimToken(const StringToken& str, const char* needle = " ");
+    inline StringToken trimToken(const StringToken& str, const char* needle = " ") { return ltrimToken(rtrimToken(str, needle), needle); }
+    int parseInteger(const char* data, const size_t& length, int& outValue, size_t& outErrorPos);
+    int toInteger(const StringToken& str);
+
+    void getLineWindows(std::istream& is, std::string& str);
+    void getVBString(std::istream& is, std::string& str);
 
     //readVBString
     //readVBLine
@@ -30,6 +92,59 @@ namespace Frost {
     void writeVBLine(std::ostream& os, const std::string& line);
     void writeVBString(std::ostream& os, const std::string& str);
 
+    void writeVBInteger(std::string& buffer, const int32_t& intVal);
+    void writeVBLine(std::string& buffer, const std::string& line);
+    void writeVBString(std::string& buffer, const std::string& str);
+    void writeVBLine(std::string& buffer, const StringToken& line);
+    void writeVBString(std::string& buffer, const StringToken& str);
+
+    ///------------------------------------------------------------------------
+    /// LineReader - Reads a stream a line at a time into a buffer that is
+    /// reused, so once the buffer has grown to fit the longest line, reading
+    /// does not allocate. Each line is only valid until the next one is read.
+    /// The reader counts lines and bytes as it goes, so errors can say where
+    /// they happened.
+    ///------------------------------------------------------------------------
+
+    class LineReader {
+
+        public:
+
+            explicit LineReader(std::istream& inStream) : is(inStream), lineNumber(0), lineOffset(0),
+                                                          textOffset(0), nextOffset(0) {}
+
+            const std::string& getLineWindows();
+            const std::string& getVBString();
+            void readVBString(std::string& outStr);
+
+            int tryReadInteger(int& outValue);
+            int readInteger();
+            int tryParseInteger(const StringToken& token, int& outValue);
+            int parseInteger(const StringToken& token);
+
+            const ParseError& getLastError() const { return lastError; }
+            const size_t& getLineNumber() const { return lineNumber; }
+            std::string positionString() const { return Frost::positionString(lineNumber, lineOffset); }
+
+            std::istream& getStream() { return is; }
+
+        private:
+
+            LineReader(const LineReader& other) : is(other.is) {};
+            void operator=(const LineReader&) {};
+
+            bool readRawLine();
+
+            std::istream&   is;
+            std::string     line;
+            size_t          lineNumber;     // Line number of the last line read.
+            size_t          lineOffset;     // Byte the last line read starts at.
+            size_t          textOffset;     // Byte the first character left in the line is at.
+            size_t          nextOffset;
+            ParseError      lastError;
+
+    };
+
     bool doesFileExist(const std::string& fullPath);
 #ifdef _WIN32
     bool doesFileExist(const std::wstring& fullPath);
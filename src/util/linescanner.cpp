@@ -0,0 +1,407 @@
+#include "linescanner.h"
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define LINESCANNER_X86
+#endif
+
+#ifdef LINESCANNER_X86
+
+    #include <emmintrin.h>
+
+    // AVX2 intrinsics need VS2012 or newer. GCC and Clang have them as long
+    // as the function using them is marked as targeting AVX2.
+
+    #if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1700)
+        #define LINESCANNER_AVX2
+        #include <immintrin.h>
+    #endif
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif // _MSC_VER
+
+    // GCC and Clang only allow the intrinsics in functions that target the
+    // instruction set, which lets the rest of the program run on any CPU.
+
+    #ifdef __GNUC__
+        #define TARGET_SSE2 __attribute__((target("sse2")))
+        #define TARGET_AVX2 __attribute__((target("avx2")))
+    #else
+        #define TARGET_SSE2
+        #define TARGET_AVX2
+    #endif // __GNUC__
+
+#endif // LINESCANNER_X86
+
+typedef const char* (*FindFunction)(const char*, const size_t&);
+
+//=============================================================================
+// Scalar
+//=============================================================================
+
+static const char* findNewLineScalar(const char* data, const size_t& length) {
+
+    const char* end = data + length;
+
+    for(const char* current = data; current != end; ++current) {
+        if(*current == '\n') {
+            return current;
+        }
+    }
+
+    return NULL;
+}
+
+static const char* findVBTerminatorScalar(const char* data, const size_t& length) {
+
+    if(length < 3) {
+        return NULL;
+    }
+
+    const char* last = data + length - 2;
+
+    for(const char* current = data; current != last; ++current) {
+        if(current[0] == '\"' && current[1] == '\r' && current[2] == '\n') {
+            return current;
+        }
+    }
+
+    return NULL;
+}
+
+#ifdef LINESCANNER_X86
+
+///----------------------------------------------------------------------------
+/// lowestSetBit - Gets the index of the lowest bit set in a mask, which must
+/// not be 0.
+///----------------------------------------------------------------------------
+
+static inline unsigned int lowestSetBit(const unsigned int& mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif // _MSC_VER
+}
+
+//=============================================================================
+// SSE2
+//=============================================================================
+
+TARGET_SSE2 static const char* findNewLineSSE2(const char* data, const size_t& length) {
+
+    const char* current = data;
+    const char* end = data + length;
+    const __m128i newLine = _mm_set1_epi8('\n');
+
+    while(end - current >= 16) {
+
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+        const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newLine)));
+
+        if(mask != 0) {
+            return current + lowestSetBit(mask);
+        }
+
+        current += 16;
+    }
+
+    return findNewLineScalar(current, static_cast<size_t>(end - current));
+}
+
+///----------------------------------------------------------------------------
+/// findVBTerminatorSSE2 - The three characters are compared at offsets 0, 1
+/// and 2, so a match is only where all three masks have the same bit set.
+/// The loop stops 2 bytes early so the last two loads stay in the buffer.
+///----------------------------------------------------------------------------
+
+TARGET_SSE2 static const char* findVBTerminatorSSE2(const char* data, const size_t& length) {
+
+    const char* current = data;
+    const char* end = data + length;
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i newLine = _mm_set1_epi8('\n');
+
+    while(end - current >= 18) {
+
+        const __m128i quotes = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current)), quote);
+        const __m128i returns = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current + 1)),
+                                               carriageReturn);
+        const __m128i newLines = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current + 2)),
+                                                newLine);
+
+        const unsigned int mask = static_cast<unsigned int>(
+                                  _mm_movemask_epi8(_mm_and_si128(quotes, _mm_and_si128(returns, newLines))));
+
+        if(mask != 0) {
+            return current + lowestSetBit(mask);
+        }
+
+        current += 16;
+    }
+
+    return findVBTerminatorScalar(current, static_cast<size_t>(end - current));
+}
+
+#endif // LINESCANNER_X86
+
+#ifdef LINESCANNER_AVX2
+
+//=============================================================================
+// AVX2
+//=============================================================================
+
+TARGET_AVX2 static const char* findNewLineAVX2(const char* data, const size_t& length) {
+
+    const char* current = data;
+    const char* end = data + length;
+    const __m256i newLine = _mm256_set1_epi8('\n');
+
+    while(end - current >= 32) {
+
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current));
+        const unsigned int mask = static_cast<unsigned int>(
+                                  _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newLine)));
+
+        if(mask != 0) {
+            return current + lowestSetBit(mask);
+        }
+
+        current += 32;
+    }
+
+    return findNewLineSSE2(current, static_cast<size_t>(end - current));
+}
+
+TARGET_AVX2 static const char* findVBTerminatorAVX2(const char* data, const size_t& length) {
+
+    const char* current = data;
+    const char* end = data + length;
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+    const __m256i newLine = _mm256_set1_epi8('\n');
+
+    while(end - current >= 34) {
+
+        const __m256i quotes = _mm256_cmpeq_epi8(
+                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current)), quote);
+        const __m256i returns = _mm256_cmpeq_epi8(
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + 1)), carriageReturn);
+        const __m256i newLines = _mm256_cmpeq_epi8(
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + 2)), newLine);
+
+        const unsigned int mask = static_cast<unsigned int>(
+                                  _mm256_movemask_epi8(_mm256_and_si256(quotes, _mm256_and_si256(returns, newLines))));
+
+        if(mask != 0) {
+            return current + lowestSetBit(mask);
+        }
+
+        current += 32;
+    }
+
+    return findVBTerminatorSSE2(current, static_cast<size_t>(end - current));
+}
+
+#endif // LINESCANNER_AVX2
+
+//=============================================================================
+// Dispatch
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// detectImplementation - Asks the CPU which instruction sets it has. AVX2
+/// also needs the OS to save the upper halves of the registers, which is
+/// what XGETBV reports.
+/// @return the fastest implementation this CPU and build can use.
+///----------------------------------------------------------------------------
+
+static LineScanner::Implementation detectImplementation() {
+
+#if defined(LINESCANNER_X86) && defined(__GNUC__)
+
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx2")) {
+        return LineScanner::AVX2;
+    }
+
+    if(__builtin_cpu_supports("sse2")) {
+        return LineScanner::SSE2;
+    }
+
+#elif defined(LINESCANNER_X86) && defined(_MSC_VER)
+
+    int info[4];
+
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    if(maxLeaf < 1) {
+        return LineScanner::Scalar;
+    }
+
+    __cpuid(info, 1);
+
+    const bool hasSSE2      = (info[3] & (1 << 26)) != 0;
+    const bool hasOSXSave   = (info[2] & (1 << 27)) != 0;
+    const bool hasAVX       = (info[2] & (1 << 28)) != 0;
+
+#ifdef LINESCANNER_AVX2
+    if(maxLeaf >= 7 && hasOSXSave && hasAVX && (_xgetbv(0) & 6) == 6) {
+
+        __cpuidex(info, 7, 0);
+
+        if(info[1] & (1 << 5)) {
+            return LineScanner::AVX2;
+        }
+    }
+#else
+    (void)hasOSXSave;
+    (void)hasAVX;
+#endif // LINESCANNER_AVX2
+
+    if(hasSSE2) {
+        return LineScanner::SSE2;
+    }
+
+#endif
+
+    return LineScanner::Scalar;
+}
+
+static FindFunction getNewLineFinder(const LineScanner::Implementation& implementation) {
+
+    switch(implementation) {
+#ifdef LINESCANNER_AVX2
+        case LineScanner::AVX2: return findNewLineAVX2;
+#endif // LINESCANNER_AVX2
+#ifdef LINESCANNER_X86
+        case LineScanner::SSE2: return findNewLineSSE2;
+#endif // LINESCANNER_X86
+        default:                return findNewLineScalar;
+    }
+
+}
+
+static FindFunction getVBTerminatorFinder(const LineScanner::Implementation& implementation) {
+
+    switch(implementation) {
+#ifdef LINESCANNER_AVX2
+        case LineScanner::AVX2: return findVBTerminatorAVX2;
+#endif // LINESCANNER_AVX2
+#ifdef LINESCANNER_X86
+        case LineScanner::SSE2: return findVBTerminatorSSE2;
+#endif // LINESCANNER_X86
+        default:                return findVBTerminatorScalar;
+    }
+
+}
+
+// Chosen before main runs, so the row files being read on several threads
+// never race to pick one.
+
+static const LineScanner::Implementation bestImplementation = detectImplementation();
+static LineScanner::Implementation currentImplementation    = bestImplementation;
+static FindFunction newLineFinder                           = getNewLineFinder(bestImplementation);
+static FindFunction vbTerminatorFinder                      = getVBTerminatorFinder(bestImplementation);
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+namespace LineScanner {
+
+    ///------------------------------------------------------------------------
+    /// findNewLine - Finds the first line feed in a buffer, like memchr.
+    /// @param pointer to the first character to search
+    /// @param number of characters to search
+    /// @return a pointer to the line feed, or NULL if there isn't one.
+    ///------------------------------------------------------------------------
+
+    const char* findNewLine(const char* data, const size_t& length) {
+        return newLineFinder(data, length);
+    }
+
+    ///------------------------------------------------------------------------
+    /// findVBTerminator - Finds the first quote followed by a CR LF, which is
+    /// where a Visual Basic string written on its own line can end. The quote
+    /// may still be escaped if it is part of a longer run of quotes.
+    /// @param pointer to the first character to search
+    /// @param number of characters to search
+    /// @return a pointer to the quote, or NULL if there isn't one.
+    ///------------------------------------------------------------------------
+
+    const char* findVBTerminator(const char* data, const size_t& length) {
+        return vbTerminatorFinder(data, length);
+    }
+
+    ///------------------------------------------------------------------------
+    /// getImplementation - Gets the version of the scanner in use.
+    ///------------------------------------------------------------------------
+
+    Implementation getImplementation() {
+        return currentImplementation;
+    }
+
+    ///------------------------------------------------------------------------
+    /// isSupported - Checks if this CPU and build can use an implementation.
+    /// The scalar one is always supported.
+    ///------------------------------------------------------------------------
+
+    bool isSupported(const Implementation& implementation) {
+
+        if(implementation == Scalar) {
+            return true;
+        }
+
+#ifndef LINESCANNER_AVX2
+        if(implementation == AVX2) {
+            return false;
+        }
+#endif // LINESCANNER_AVX2
+
+        return implementation <= bestImplementation;
+    }
+
+    ///------------------------------------------------------------------------
+    /// setImplementation - Forces the scanner to use a particular version,
+    /// so they can be compared against each other. This is not thread safe,
+    /// and must not be called while anything is being read.
+    /// @param implementation to use
+    /// @return true if it was set, false if it is not supported.
+    ///------------------------------------------------------------------------
+
+    bool setImplementation(const Implementation& implementation) {
+
+        if(!isSupported(implementation)) {
+            return false;
+        }
+
+        currentImplementation   = implementation;
+        newLineFinder           = getNewLineFinder(implementation);
+        vbTerminatorFinder      = getVBTerminatorFinder(implementation);
+
+        return true;
+    }
+
+    ///------------------------------------------------------------------------
+    /// getImplementationName - Gets a short name for an implementation, for
+    /// reports and benchmarks.
+    ///------------------------------------------------------------------------
+
+    const char* getImplementationName(const Implementation& implementation) {
+
+        switch(implementation) {
+            case AVX2:  return "avx2";
+            case SSE2:  return "sse2";
+            default:    return "scalar";
+        }
+
+    }
+
+}
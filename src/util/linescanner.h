@@ -0,0 +1,31 @@
+#ifndef __LINESCANNER_H__
+#define __LINESCANNER_H__
+
+#include <string>
+
+///----------------------------------------------------------------------------
+/// LineScanner - Finds line endings in a buffer 16 or 32 bytes at a time
+/// using SSE2 or AVX2, picking the best version the CPU supports the first
+/// time the program starts. A plain scalar version is used on CPUs and
+/// compilers that have neither.
+///----------------------------------------------------------------------------
+
+namespace LineScanner {
+
+    enum Implementation {
+        Scalar  = 0,
+        SSE2    = 1,
+        AVX2    = 2
+    };
+
+    const char* findNewLine(const char* data, const size_t& length);
+    const char* findVBTerminator(const char* data, const size_t& length);
+
+    Implementation getImplementation();
+    bool isSupported(const Implementation& implementation);
+    bool setImplementation(const Implementation& implementation);
+    const char* getImplementationName(const Implementation& implementation);
+
+}
+
+#endif // __LINESCANNER_H__
@@ -0,0 +1,246 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN32
+
+// Used for empty files, as they cannot be mapped.
+static const char emptyFileData[1] = { 0 };
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+MappedFile::MappedFile() : data(NULL), size(0), opened(false), mapped(false),
+                           fileNotFound(false) {
+#ifdef _WIN32
+    fileHandle      = INVALID_HANDLE_VALUE;
+    mappingHandle   = NULL;
+#endif // _WIN32
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// open - Maps or reads the file given into memory. Any file already open is
+/// closed first.
+/// @param UTF-8 string of the full path to the file.
+/// @return true if the file was mapped, false if it could not be. If it was
+/// because the file does not exist, wasFileNotFound will return true.
+///----------------------------------------------------------------------------
+
+bool MappedFile::open(const std::string& filePath) {
+
+    close();
+    fileNotFound = false;
+
+#ifdef _WIN32
+
+#ifdef __WIN9X_COMPAT__
+    HANDLE newFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, NULL, 0);
+
+    if(wideLength == 0) {
+        return false;
+    }
+
+    std::vector<wchar_t> widePath(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], wideLength);
+
+    HANDLE newFile = CreateFileW(&widePath[0], GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#endif // __WIN9X_COMPAT__
+
+    if(newFile == INVALID_HANDLE_VALUE) {
+        const DWORD lastError = GetLastError();
+        fileNotFound = (lastError == ERROR_FILE_NOT_FOUND || lastError == ERROR_PATH_NOT_FOUND);
+        return false;
+    }
+
+    // World files are tiny compared to 4GB, so the high part is ignored.
+    const DWORD fileSize = GetFileSize(newFile, NULL);
+
+    if(fileSize == INVALID_FILE_SIZE) {
+        CloseHandle(newFile);
+        return false;
+    }
+
+    fileHandle = newFile;
+
+    if(fileSize == 0) {
+        data    = emptyFileData;
+        size    = 0;
+        opened  = true;
+        return true;
+    }
+
+    if(fileSize < MappedFileConstants::MinMapSize) {
+
+        readBuffer.resize(fileSize);
+
+        DWORD bytesRead = 0;
+
+        if(!ReadFile(newFile, &readBuffer[0], fileSize, &bytesRead, NULL) || bytesRead != fileSize) {
+            close();
+            return false;
+        }
+
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+
+        data    = &readBuffer[0];
+        size    = fileSize;
+        opened  = true;
+        return true;
+    }
+
+    HANDLE newMapping = CreateFileMapping(newFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if(newMapping == NULL) {
+        close();
+        return false;
+    }
+
+    mappingHandle = newMapping;
+
+    const void* view = MapViewOfFile(newMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if(view == NULL) {
+        close();
+        return false;
+    }
+
+    data    = static_cast<const char*>(view);
+    size    = fileSize;
+    mapped  = true;
+
+#else
+
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+
+    if(fd == -1) {
+        fileNotFound = (errno == ENOENT || errno == ENOTDIR);
+        return false;
+    }
+
+    struct stat fileInfo;
+
+    if(fstat(fd, &fileInfo) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    if(fileInfo.st_size == 0) {
+        ::close(fd);
+        data    = emptyFileData;
+        size    = 0;
+        opened  = true;
+        return true;
+    }
+
+    const size_t fileSize = static_cast<size_t>(fileInfo.st_size);
+
+    if(fileSize < MappedFileConstants::MinMapSize) {
+
+        readBuffer.resize(fileSize);
+
+        size_t totalRead = 0;
+
+        while(totalRead < fileSize) {
+
+            const ssize_t bytesRead = ::read(fd, &readBuffer[totalRead], fileSize - totalRead);
+
+            if(bytesRead <= 0) {
+                ::close(fd);
+                readBuffer.clear();
+                return false;
+            }
+
+            totalRead += static_cast<size_t>(bytesRead);
+        }
+
+        ::close(fd);
+
+        data    = &readBuffer[0];
+        size    = fileSize;
+        opened  = true;
+        return true;
+    }
+
+    void* view = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if(view == MAP_FAILED) {
+        return false;
+    }
+
+    data    = static_cast<const char*>(view);
+    size    = fileSize;
+    mapped  = true;
+
+#endif // _WIN32
+
+    opened = true;
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// close - Unmaps or frees the file's contents, if a file is open.
+///----------------------------------------------------------------------------
+
+void MappedFile::close() {
+
+#ifdef _WIN32
+
+    if(mapped) {
+        UnmapViewOfFile(data);
+    }
+
+    if(mappingHandle != NULL) {
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+    }
+
+    if(fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    if(mapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+
+#endif // _WIN32
+
+    // The buffer is kept so the next small file can reuse it.
+    readBuffer.clear();
+
+    data    = NULL;
+    size    = 0;
+    opened  = false;
+    mapped  = false;
+
+}
@@ -0,0 +1,55 @@
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <string>
+#include <vector>
+
+namespace MappedFileConstants {
+    // Mapping a file costs more than reading it until the file is fairly
+    // large, so anything smaller than this is read into a buffer instead.
+    const size_t MinMapSize = 1024 * 1024;
+}
+
+///----------------------------------------------------------------------------
+/// MappedFile - Gives read only access to the whole contents of a file. Large
+/// files are mapped into memory, and small ones are read in one go. The data
+/// stays valid until the file is closed or the object is destroyed. Paths are
+/// UTF-8 on every platform.
+///----------------------------------------------------------------------------
+
+class MappedFile {
+
+    public:
+
+        MappedFile();
+        ~MappedFile();
+
+        bool open(const std::string& filePath);
+        void close();
+
+        const char* getData() const { return data; }
+        const size_t& getSize() const { return size; }
+        bool isOpen() const { return opened; }
+        bool isMapped() const { return mapped; }
+        bool wasFileNotFound() const { return fileNotFound; }
+
+    private:
+
+        MappedFile(const MappedFile&) {};
+        void operator=(const MappedFile&) {};
+
+        const char*         data;
+        size_t              size;
+        bool                opened;
+        bool                mapped;
+        bool                fileNotFound; // Why the last open failed.
+        std::vector<char>   readBuffer;
+
+#ifdef _WIN32
+        void*               fileHandle;
+        void*               mappingHandle;
+#endif // _WIN32
+
+};
+
+#endif // __MAPPEDFILE_H__
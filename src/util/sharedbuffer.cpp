@@ -0,0 +1,54 @@
+#include "sharedbuffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif // _WIN32
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// create - Copies some bytes into a new buffer, which starts with one
+/// reference held by the caller.
+/// @param pointer to the bytes to copy
+/// @param number of bytes to copy
+/// @return the new buffer, which must be released when it is no longer needed.
+///----------------------------------------------------------------------------
+
+SharedBuffer* SharedBuffer::create(const char* inData, const size_t& inSize) {
+    SharedBuffer* buffer = new SharedBuffer();
+    buffer->contents.assign(inData, inSize);
+    return buffer;
+}
+
+///----------------------------------------------------------------------------
+/// addRef - Adds a reference to the buffer.
+///----------------------------------------------------------------------------
+
+void SharedBuffer::addRef() {
+#ifdef _WIN32
+    InterlockedIncrement(&refCount);
+#else
+    __sync_add_and_fetch(&refCount, 1);
+#endif // _WIN32
+}
+
+///----------------------------------------------------------------------------
+/// release - Drops a reference to the buffer, and deletes it when the last
+/// one is gone.
+///----------------------------------------------------------------------------
+
+void SharedBuffer::release() {
+
+#ifdef _WIN32
+    const long remaining = InterlockedDecrement(&refCount);
+#else
+    const long remaining = __sync_sub_and_fetch(&refCount, 1);
+#endif // _WIN32
+
+    if(remaining == 0) {
+        delete this;
+    }
+
+}
@@ -0,0 +1,36 @@
+#ifndef __SHAREDBUFFER_H__
+#define __SHAREDBUFFER_H__
+
+#include <string>
+
+///----------------------------------------------------------------------------
+/// SharedBuffer - A reference counted copy of some bytes, usually the
+/// contents of a file, that stays alive for as long as anything still points
+/// into it. References can be added and released from any thread.
+///----------------------------------------------------------------------------
+
+class SharedBuffer {
+
+    public:
+
+        static SharedBuffer* create(const char* inData, const size_t& inSize);
+
+        void addRef();
+        void release();
+
+        const char* getData() const { return contents.data(); }
+        size_t getSize() const { return contents.size(); }
+
+    private:
+
+        SharedBuffer() : refCount(1) {}
+        ~SharedBuffer() {}
+        SharedBuffer(const SharedBuffer&) {};
+        void operator=(const SharedBuffer&) {};
+
+        volatile long   refCount;
+        std::string     contents;
+
+};
+
+#endif // __SHAREDBUFFER_H__
@@ -0,0 +1,245 @@
+#include "workerpool.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+#endif // _WIN32
+
+//=============================================================================
+// Constructors / Destructor
+//=============================================================================
+
+WorkerPool::WorkerPool(const unsigned int& inNumThreads) : numThreads(inNumThreads),
+                                                           currentJobs(NULL), nextJob(0),
+                                                           jobFailed(false), mutexHandle(NULL) {
+
+    if(numThreads == 0) {
+        numThreads = getHardwareThreadCount();
+    }
+
+#ifdef _WIN32
+    CRITICAL_SECTION* criticalSection = new CRITICAL_SECTION;
+    InitializeCriticalSection(criticalSection);
+    mutexHandle = criticalSection;
+#else
+    pthread_mutex_t* mutex = new pthread_mutex_t;
+    pthread_mutex_init(mutex, NULL);
+    mutexHandle = mutex;
+#endif // _WIN32
+
+}
+
+WorkerPool::~WorkerPool() {
+
+#ifdef _WIN32
+    CRITICAL_SECTION* criticalSection = static_cast<CRITICAL_SECTION*>(mutexHandle);
+    DeleteCriticalSection(criticalSection);
+    delete criticalSection;
+#else
+    pthread_mutex_t* mutex = static_cast<pthread_mutex_t*>(mutexHandle);
+    pthread_mutex_destroy(mutex);
+    delete mutex;
+#endif // _WIN32
+
+    mutexHandle = NULL;
+}
+
+//=============================================================================
+// Public Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// getHardwareThreadCount - Get the number of logical processors available.
+/// @return the number of logical processors, or 1 if it could not be found.
+///----------------------------------------------------------------------------
+
+unsigned int WorkerPool::getHardwareThreadCount() {
+
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    const long numProcessors = static_cast<long>(systemInfo.dwNumberOfProcessors);
+#else
+    const long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif // _WIN32
+
+    return numProcessors > 0 ? static_cast<unsigned int>(numProcessors) : 1;
+
+}
+
+///----------------------------------------------------------------------------
+/// runJobs - Runs every job given, and returns once all of them have
+/// finished.
+/// @param vector of jobs to run. The pool does not take ownership of them.
+/// @throws runtime_error if any job threw an exception, or a thread could
+/// not be started.
+///----------------------------------------------------------------------------
+
+void WorkerPool::runJobs(const std::vector<WorkerJob*>& jobs) {
+
+    if(jobs.empty()) {
+        return;
+    }
+
+    currentJobs     = &jobs;
+    nextJob         = 0;
+    jobFailed       = false;
+    failureMessage  = "";
+
+    // No point starting more threads than there are jobs, and the calling
+    // thread is going to do its share too.
+
+    size_t numExtraThreads = numThreads - 1;
+
+    if(numExtraThreads > jobs.size() - 1) {
+        numExtraThreads = jobs.size() - 1;
+    }
+
+#ifdef _WIN32
+    std::vector<HANDLE> threads;
+#else
+    std::vector<pthread_t> threads;
+#endif // _WIN32
+
+    threads.reserve(numExtraThreads);
+
+    for(size_t i = 0; i < numExtraThreads; ++i) {
+
+#ifdef _WIN32
+        const uintptr_t handle = _beginthreadex(NULL, 0, threadEntry, this, 0, NULL);
+
+        if(handle == 0) {
+            break; // Whatever threads did start will pick up the slack.
+        }
+
+        threads.push_back(reinterpret_cast<HANDLE>(handle));
+#else
+        pthread_t thread;
+
+        if(pthread_create(&thread, NULL, threadEntry, this) != 0) {
+            break;
+        }
+
+        threads.push_back(thread);
+#endif // _WIN32
+
+    }
+
+    workerLoop(this);
+
+    for(size_t i = 0; i < threads.size(); ++i) {
+
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif // _WIN32
+
+    }
+
+    currentJobs = NULL;
+
+    if(jobFailed) {
+        throw std::runtime_error(failureMessage);
+    }
+
+}
+
+//=============================================================================
+// Private Functions
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// threadEntry - Entry point for each thread the pool starts.
+/// @param pointer to the worker pool that started the thread.
+///----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+unsigned int __stdcall WorkerPool::threadEntry(void* param) {
+    workerLoop(static_cast<WorkerPool*>(param));
+    return 0;
+}
+
+#else
+
+void* WorkerPool::threadEntry(void* param) {
+    workerLoop(static_cast<WorkerPool*>(param));
+    return NULL;
+}
+
+#endif // _WIN32
+
+///----------------------------------------------------------------------------
+/// workerLoop - Keep taking jobs until there are none left. If a job fails,
+/// the remaining jobs are skipped.
+/// @param pointer to the worker pool to take jobs from.
+///----------------------------------------------------------------------------
+
+void WorkerPool::workerLoop(WorkerPool* pool) {
+
+    while(true) {
+
+        WorkerJob* job = NULL;
+
+        pool->lock();
+
+        if(!pool->jobFailed && pool->nextJob < pool->currentJobs->size()) {
+            job = (*pool->currentJobs)[pool->nextJob];
+            pool->nextJob++;
+        }
+
+        pool->unlock();
+
+        if(job == NULL) {
+            return;
+        }
+
+        try {
+            job->run();
+        }
+        catch(const std::exception& e) {
+            pool->lock();
+            if(!pool->jobFailed) {
+                pool->jobFailed = true;
+                pool->failureMessage = e.what();
+            }
+            pool->unlock();
+        }
+        catch(...) {
+            pool->lock();
+            if(!pool->jobFailed) {
+                pool->jobFailed = true;
+                pool->failureMessage = "Unknown error in worker thread.";
+            }
+            pool->unlock();
+        }
+
+    }
+
+}
+
+void WorkerPool::lock() {
+#ifdef _WIN32
+    EnterCriticalSection(static_cast<CRITICAL_SECTION*>(mutexHandle));
+#else
+    pthread_mutex_lock(static_cast<pthread_mutex_t*>(mutexHandle));
+#endif // _WIN32
+}
+
+void WorkerPool::unlock() {
+#ifdef _WIN32
+    LeaveCriticalSection(static_cast<CRITICAL_SECTION*>(mutexHandle));
+#else
+    pthread_mutex_unlock(static_cast<pthread_mutex_t*>(mutexHandle));
+#endif // _WIN32
+}
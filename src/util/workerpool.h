@@ -0,0 +1,64 @@
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <string>
+#include <vector>
+
+///----------------------------------------------------------------------------
+/// WorkerJob - A unit of work that can be handed to a WorkerPool. Jobs should
+/// not share any mutable state with each other unless they guard it.
+///----------------------------------------------------------------------------
+
+class WorkerJob {
+
+    public:
+        virtual ~WorkerJob() {}
+        virtual void run() = 0;
+
+};
+
+///----------------------------------------------------------------------------
+/// WorkerPool - Runs a batch of jobs across a number of threads. The calling
+/// thread also takes jobs, so a pool of 1 thread runs everything in place.
+///----------------------------------------------------------------------------
+
+class WorkerPool {
+
+    public:
+
+        explicit WorkerPool(const unsigned int& inNumThreads = 0);
+        ~WorkerPool();
+
+        const unsigned int& getNumThreads() const { return numThreads; }
+
+        void runJobs(const std::vector<WorkerJob*>& jobs);
+
+        static unsigned int getHardwareThreadCount();
+
+    private:
+
+        WorkerPool(const WorkerPool&) {};
+        void operator=(const WorkerPool&) {};
+
+        static void workerLoop(WorkerPool* pool);
+
+        #ifdef _WIN32
+            static unsigned int __stdcall threadEntry(void* param);
+        #else
+            static void* threadEntry(void* param);
+        #endif // _WIN32
+
+        void lock();
+        void unlock();
+
+        unsigned int                    numThreads;
+        const std::vector<WorkerJob*>*  currentJobs;
+        size_t                          nextJob;
+        bool                            jobFailed;
+        std::string                     failureMessage;
+
+        void*                           mutexHandle;
+
+};
+
+#endif // __WORKERPOOL_H__
@@ -0,0 +1,369 @@
+#include "worldstorage.h"
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+#include "filetransaction.h"
+#include "../compat/std_extras_compat.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <sys/stat.h>
+
+#endif // _WIN32
+
+// Used for empty parts, so their data is never NULL.
+static const char emptyPartData[1] = { 0 };
+
+// Gives each in-memory storage its own location. Storages can be created on
+// any thread, so it is only ever changed atomically.
+static volatile long lastMemoryStorageID = 0;
+
+//=============================================================================
+// StoragePart
+//=============================================================================
+
+StoragePart::StoragePart() : data(NULL), size(0), opened(false), notFound(false) {
+}
+
+///----------------------------------------------------------------------------
+/// openFile - Opens a file as the part's contents. Any part already open is
+/// closed first.
+/// @param UTF-8 string of the full path to the file.
+/// @return true if the file was opened, false if not.
+///----------------------------------------------------------------------------
+
+bool StoragePart::openFile(const std::string& filePath) {
+
+    close();
+
+    if(!mappedFile.open(filePath)) {
+        notFound = mappedFile.wasFileNotFound();
+        return false;
+    }
+
+    data    = mappedFile.getData();
+    size    = mappedFile.getSize();
+    opened  = true;
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// openMemory - Uses memory owned by someone else as the part's contents.
+/// Any part already open is closed first.
+/// @param pointer to the contents
+/// @param size of the contents in bytes
+///----------------------------------------------------------------------------
+
+void StoragePart::openMemory(const char* inData, const size_t& inSize) {
+
+    close();
+
+    data    = inSize ? inData : emptyPartData;
+    size    = inSize;
+    opened  = true;
+
+}
+
+///----------------------------------------------------------------------------
+/// setNotFound - Closes the part, noting that it was because it does not
+/// exist.
+///----------------------------------------------------------------------------
+
+void StoragePart::setNotFound() {
+    close();
+    notFound = true;
+}
+
+///----------------------------------------------------------------------------
+/// close - Releases the part's contents, if it is open.
+///----------------------------------------------------------------------------
+
+void StoragePart::close() {
+
+    mappedFile.close();
+
+    data        = NULL;
+    size        = 0;
+    opened      = false;
+    notFound    = false;
+
+}
+
+//=============================================================================
+// FileWorldStorage
+//=============================================================================
+
+///----------------------------------------------------------------------------
+/// Constructor
+/// @param path to the directory the world is in, which should end with a
+/// path separator. It can be empty for the current directory.
+///----------------------------------------------------------------------------
+
+FileWorldStorage::FileWorldStorage(const std::string& inDirectory) : directory(inDirectory), transaction(NULL) {
+}
+
+FileWorldStorage::~FileWorldStorage() {
+    discardParts();
+}
+
+bool FileWorldStorage::openPart(const std::string& partName, StoragePart& outPart) const {
+    return outPart.openFile(directory + partName);
+}
+
+///----------------------------------------------------------------------------
+/// getPartStamp - See WorldStorage. The time is the file's last write time.
+///----------------------------------------------------------------------------
+
+bool FileWorldStorage::getPartStamp(const std::string& partName, PartStamp& outStamp) const {
+
+    const std::string filePath = directory + partName;
+
+    outStamp.size           = 0;
+    outStamp.modifiedTime   = 0;
+
+#ifdef _WIN32
+
+    WIN32_FILE_ATTRIBUTE_DATA fileInfo;
+
+#ifdef __WIN9X_COMPAT__
+    if(!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &fileInfo)) {
+        return false;
+    }
+#else
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, NULL, 0);
+
+    if(wideLength == 0) {
+        return false;
+    }
+
+    std::vector<wchar_t> widePath(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], wideLength);
+
+    if(!GetFileAttributesExW(&widePath[0], GetFileExInfoStandard, &fileInfo)) {
+        return false;
+    }
+#endif // __WIN9X_COMPAT__
+
+    // FILETIME counts 100 nanosecond intervals since 1601.
+
+    const int64_t fileTime = (static_cast<int64_t>(fileInfo.ftLastWriteTime.dwHighDateTime) << 32) |
+                             fileInfo.ftLastWriteTime.dwLowDateTime;
+
+    outStamp.size           = (static_cast<uint64_t>(fileInfo.nFileSizeHigh) << 32) | fileInfo.nFileSizeLow;
+    outStamp.modifiedTime   = (fileTime - 116444736000000000LL) * 100;
+
+#else
+
+    struct stat fileInfo;
+
+    if(stat(filePath.c_str(), &fileInfo) != 0) {
+        return false;
+    }
+
+    outStamp.size = static_cast<uint64_t>(fileInfo.st_size);
+
+#if defined(__APPLE__)
+    outStamp.modifiedTime = static_cast<int64_t>(fileInfo.st_mtimespec.tv_sec) * 1000000000LL +
+                            fileInfo.st_mtimespec.tv_nsec;
+#else
+    outStamp.modifiedTime = static_cast<int64_t>(fileInfo.st_mtim.tv_sec) * 1000000000LL +
+                            fileInfo.st_mtim.tv_nsec;
+#endif // __APPLE__
+
+#endif // _WIN32
+
+    return true;
+
+}
+
+///----------------------------------------------------------------------------
+/// addPart - See WorldStorage. The parts are written through one
+/// FileTransaction, so if the commit fails, the files it replaced are put
+/// back. See FileTransaction for what is, and is not, guaranteed.
+///----------------------------------------------------------------------------
+
+std::string& FileWorldStorage::addPart(const std::string& partName) {
+
+    if(!transaction) {
+        transaction = new FileTransaction();
+    }
+
+    return transaction->addFile(directory + partName);
+
+}
+
+void FileWorldStorage::commitParts() {
+
+    if(!transaction) {
+        return;
+    }
+
+    try {
+        transaction->commit();
+    }
+    catch (const std::runtime_error&) {
+        discardParts();
+        throw;
+    }
+
+    discardParts();
+
+}
+
+///----------------------------------------------------------------------------
+/// discardParts - See WorldStorage. Deleting an uncommitted transaction
+/// removes any temporary files it created.
+///----------------------------------------------------------------------------
+
+void FileWorldStorage::discardParts() {
+    delete transaction;
+    transaction = NULL;
+}
+
+std::string FileWorldStorage::getPartPath(const std::string& partName) const {
+    return directory + partName;
+}
+
+//=============================================================================
+// MemoryWorldStorage
+//=============================================================================
+
+MemoryWorldStorage::MemoryWorldStorage() {
+
+#ifdef _WIN32
+    const long storageID = InterlockedIncrement(&lastMemoryStorageID);
+#else
+    const long storageID = __sync_add_and_fetch(&lastMemoryStorageID, 1);
+#endif // _WIN32
+
+    location = "memory:" + std::to_string(storageID) + "/";
+
+}
+
+bool MemoryWorldStorage::openPart(const std::string& partName, StoragePart& outPart) const {
+
+    const std::string* contents = findPart(partName);
+
+    if(!contents) {
+        outPart.setNotFound();
+        return false;
+    }
+
+    outPart.openMemory(contents->data(), contents->size());
+    return true;
+
+}
+
+bool MemoryWorldStorage::getPartStamp(const std::string& partName, PartStamp& outStamp) const {
+
+    const std::string* contents = findPart(partName);
+
+    if(!contents) {
+        outStamp.size           = 0;
+        outStamp.modifiedTime   = 0;
+        return false;
+    }
+
+    outStamp.size           = contents->size();
+    outStamp.modifiedTime   = partTimes.find(partName)->second;
+    return true;
+
+}
+
+std::string& MemoryWorldStorage::addPart(const std::string& partName) {
+
+    std::string& contents = stagedParts[partName];
+    contents.clear();
+    return contents;
+
+}
+
+///----------------------------------------------------------------------------
+/// commitParts - See WorldStorage. The staged buffers are swapped into place
+/// rather than copied, and this can never fail.
+///----------------------------------------------------------------------------
+
+void MemoryWorldStorage::commitParts() {
+
+    const int64_t now = currentTime();
+
+    for(std::map<std::string, std::string>::iterator it = stagedParts.begin(); it != stagedParts.end(); ++it) {
+        parts[it->first].swap(it->second);
+        partTimes[it->first] = now;
+    }
+
+    stagedParts.clear();
+
+}
+
+void MemoryWorldStorage::discardParts() {
+    stagedParts.clear();
+}
+
+std::string MemoryWorldStorage::getPartPath(const std::string& partName) const {
+    return location + partName;
+}
+
+///----------------------------------------------------------------------------
+/// setPart - Adds or replaces a part straight away, without staging it.
+/// @param name of the part
+/// @param contents of the part
+///----------------------------------------------------------------------------
+
+void MemoryWorldStorage::setPart(const std::string& partName, const std::string& contents) {
+    parts[partName] = contents;
+    partTimes[partName] = currentTime();
+}
+
+///----------------------------------------------------------------------------
+/// findPart - Gets the contents of a part.
+/// @param name of the part
+/// @return a pointer to the contents, or NULL if there is no such part.
+///----------------------------------------------------------------------------
+
+const std::string* MemoryWorldStorage::findPart(const std::string& partName) const {
+
+    std::map<std::string, std::string>::const_iterator it = parts.find(partName);
+
+    if(it == parts.end()) {
+        return NULL;
+    }
+
+    return &it->second;
+
+}
+
+///----------------------------------------------------------------------------
+/// removePart - Removes a part.
+/// @param name of the part
+/// @return true if it was removed, false if there was no such part.
+///----------------------------------------------------------------------------
+
+bool MemoryWorldStorage::removePart(const std::string& partName) {
+    partTimes.erase(partName);
+    return parts.erase(partName) != 0;
+}
+
+///----------------------------------------------------------------------------
+/// clear - Removes every part, and drops any that were staged.
+///----------------------------------------------------------------------------
+
+void MemoryWorldStorage::clear() {
+    parts.clear();
+    partTimes.clear();
+    stagedParts.clear();
+}
+
+///----------------------------------------------------------------------------
+/// currentTime - Gets the time to stamp parts with as they change.
+/// @return the wall clock time, to the second, in nanoseconds since 1970.
+///----------------------------------------------------------------------------
+
+int64_t MemoryWorldStorage::currentTime() {
+    return static_cast<int64_t>(time(NULL)) * 1000000000LL;
+}
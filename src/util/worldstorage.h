@@ -0,0 +1,200 @@
+#ifndef __WORLDSTORAGE_H__
+#define __WORLDSTORAGE_H__
+
+#include <map>
+#include <string>
+#include "mappedfile.h"
+#include "../compat/stdint_compat.h"
+
+class FileTransaction;
+
+///----------------------------------------------------------------------------
+/// StoragePart - The contents of a part opened for reading from a storage.
+/// The data stays valid until the part is closed, opened again, or destroyed,
+/// and for an in-memory part, until the storage it came from is changed.
+///----------------------------------------------------------------------------
+
+class StoragePart {
+
+    public:
+
+        StoragePart();
+
+        bool openFile(const std::string& filePath);
+        void openMemory(const char* inData, const size_t& inSize);
+        void setNotFound();
+        void close();
+
+        const char* getData() const { return data; }
+        const size_t& getSize() const { return size; }
+        bool isOpen() const { return opened; }
+        bool wasNotFound() const { return notFound; }
+
+    private:
+
+        StoragePart(const StoragePart&) {};
+        void operator=(const StoragePart&) {};
+
+        MappedFile  mappedFile;
+        const char* data;
+        size_t      size;
+        bool        opened;
+        bool        notFound; // Why the last open failed.
+
+};
+
+///----------------------------------------------------------------------------
+/// PartStamp - The size of a part and when it was last changed, so callers
+/// can tell if it changed without reading it.
+///----------------------------------------------------------------------------
+
+struct PartStamp {
+    uint64_t    size;
+    int64_t     modifiedTime;   // Nanoseconds since 1970
+};
+
+///----------------------------------------------------------------------------
+/// WorldStorage - Where the files of a world are kept. Each file is a part,
+/// named the way it would be on disk (such as "WORLD.SG0" or "WORLD.T07"),
+/// so the readers and writers never need to know if it is on disk or not.
+/// Parts can be opened on several threads at once, but nothing can be
+/// written while anything is being read. Writes are staged, and only replace
+/// the parts once all of them have been committed.
+///----------------------------------------------------------------------------
+
+class WorldStorage {
+
+    public:
+
+        virtual ~WorldStorage() {}
+
+        ///--------------------------------------------------------------------
+        /// openPart - Opens a part for reading.
+        /// @param name of the part
+        /// @param (out) the part's contents
+        /// @return true if it was opened, false if not. If it was because the
+        /// part does not exist, the part's wasNotFound will return true.
+        ///--------------------------------------------------------------------
+
+        virtual bool openPart(const std::string& partName, StoragePart& outPart) const = 0;
+
+        ///--------------------------------------------------------------------
+        /// getPartStamp - Gets the size of a part, and when it was last
+        /// changed, without opening it.
+        /// @param name of the part
+        /// @param (out) the part's stamp
+        /// @return true if the part exists, false if it does not.
+        ///--------------------------------------------------------------------
+
+        virtual bool getPartStamp(const std::string& partName, PartStamp& outStamp) const = 0;
+
+        ///--------------------------------------------------------------------
+        /// addPart - Stages a part to be written by commitParts, replacing
+        /// any part with the same name.
+        /// @param name of the part
+        /// @return a reference to the buffer to put the part's contents in.
+        /// It stays valid until the parts are committed or discarded.
+        ///--------------------------------------------------------------------
+
+        virtual std::string& addPart(const std::string& partName) = 0;
+
+        ///--------------------------------------------------------------------
+        /// commitParts - Writes every part that was staged.
+        /// @throws runtime_error if they could not be written. The staged
+        /// parts are discarded either way.
+        ///--------------------------------------------------------------------
+
+        virtual void commitParts() = 0;
+
+        ///--------------------------------------------------------------------
+        /// discardParts - Drops every part that was staged without writing
+        /// any of them.
+        ///--------------------------------------------------------------------
+
+        virtual void discardParts() = 0;
+
+        ///--------------------------------------------------------------------
+        /// getPartPath - Gets a name for a part that no part of any other
+        /// storage has, for messages and for telling if a world is being
+        /// saved where it was read from.
+        ///--------------------------------------------------------------------
+
+        virtual std::string getPartPath(const std::string& partName) const = 0;
+
+};
+
+///----------------------------------------------------------------------------
+/// FileWorldStorage - Parts are files in a directory. MappedFile and
+/// FileTransaction do the reading and writing, so paths are UTF-8 and use the
+/// wide functions on Windows, and POSIX calls everywhere else.
+///----------------------------------------------------------------------------
+
+class FileWorldStorage : public WorldStorage {
+
+    public:
+
+        explicit FileWorldStorage(const std::string& inDirectory);
+        virtual ~FileWorldStorage();
+
+        virtual bool openPart(const std::string& partName, StoragePart& outPart) const;
+        virtual bool getPartStamp(const std::string& partName, PartStamp& outStamp) const;
+        virtual std::string& addPart(const std::string& partName);
+        virtual void commitParts();
+        virtual void discardParts();
+        virtual std::string getPartPath(const std::string& partName) const;
+
+        const std::string& getDirectory() const { return directory; }
+
+    private:
+
+        FileWorldStorage(const FileWorldStorage&) {};
+        void operator=(const FileWorldStorage&) {};
+
+        std::string         directory;  // Ends with a path separator, or is empty.
+        FileTransaction*    transaction;
+
+};
+
+///----------------------------------------------------------------------------
+/// MemoryWorldStorage - Parts are kept in memory, so worlds can be read and
+/// written without touching the disk. Parts opened for reading point into
+/// the storage instead of being copied. A part's modified time is the wall
+/// clock time, to the second, that it was last set or committed.
+///----------------------------------------------------------------------------
+
+class MemoryWorldStorage : public WorldStorage {
+
+    public:
+
+        MemoryWorldStorage();
+
+        virtual bool openPart(const std::string& partName, StoragePart& outPart) const;
+        virtual bool getPartStamp(const std::string& partName, PartStamp& outStamp) const;
+        virtual std::string& addPart(const std::string& partName);
+        virtual void commitParts();
+        virtual void discardParts();
+        virtual std::string getPartPath(const std::string& partName) const;
+
+        void setPart(const std::string& partName, const std::string& contents);
+        const std::string* findPart(const std::string& partName) const;
+        bool removePart(const std::string& partName);
+        void clear();
+
+        size_t getNumParts() const { return parts.size(); }
+        const std::map<std::string, std::string>& getParts() const { return parts; }
+
+    private:
+
+        MemoryWorldStorage(const MemoryWorldStorage&) {};
+        void operator=(const MemoryWorldStorage&) {};
+
+        static int64_t currentTime();
+
+        std::string                         location;
+        std::map<std::string, std::string>  parts;
+        std::map<std::string, int64_t>      partTimes;
+        std::map<std::string, std::string>  stagedParts;
+
+};
+
+#endif // __WORLDSTORAGE_H__
@@ -165,6 +165,66 @@ void GameMapPanel::onTileUpdated() {
     InvalidateRect();
 }
 
+///----------------------------------------------------------------------------
+/// onTilesUpdated - Only the tiles given changed, such as when a switch was
+/// toggled, so only draw them again.
+/// @param indices of the tiles to draw again
+///----------------------------------------------------------------------------
+
+void GameMapPanel::onTilesUpdated(const std::vector<int>& tileIndices) {
+
+    const GameMap* gameMap = gameWorldController->getGameMap();
+
+    if (!gameMap || !backBufferBMP.GetHandle()) {
+        onTileUpdated();
+        return;
+    }
+
+    CClientDC dc(*this);
+
+    CMemDC darkDC(dc);
+    darkDC.CreateCompatibleBitmap(dc, 1, 1);
+    darkDC.SolidFill(RGB(0, 0, 192), CRect(0, 0, 1, 1));
+
+    CMemDC lightOnDC(dc);
+    lightOnDC.CreateCompatibleBitmap(dc, 1, 1);
+    lightOnDC.SolidFill(RGB(255, 255, 0), CRect(0, 0, 1, 1));
+
+    CBitmap oldBMP;
+    oldBMP = backBufferDC.SelectObject(backBufferBMP);
+
+    const int selectedIndex = gameWorldController->getSelectedTileIndex();
+    const CPoint viewOffset = GetScrollPosition();
+
+    for (size_t i = 0; i < tileIndices.size(); ++i) {
+
+        const int& index = tileIndices[i];
+
+        if (!gameMap->isIndexInMapBounds(index)) {
+            continue;
+        }
+
+        drawTile(*gameMap, index, darkDC, lightOnDC);
+
+        int row = 0;
+        int col = 0;
+        gameMap->rowColFromIndex(row, col, index);
+
+        const int destX = col * scaledTileWidth;
+        const int destY = row * scaledTileHeight;
+
+        if (index == selectedIndex) {
+            DrawTileSelectionBox(backBufferDC, destX, destY, scaledTileWidth, scaledTileHeight, 2);
+        }
+
+        InvalidateRect(CRect(destX - viewOffset.x, destY - viewOffset.y,
+                             destX - viewOffset.x + scaledTileWidth, destY - viewOffset.y + scaledTileHeight));
+    }
+
+    backBufferDC.SelectObject(oldBMP);
+
+}
+
 //=============================================================================
 // Private Functions
 //=============================================================================
@@ -356,18 +416,13 @@ void GameMapPanel::updateBackBuffer() {
     
     backBufferBMP = CreateCompatibleBitmap(dc, mapWidth, mapHeight);
 
-    const std::vector<GameTile::DrawInfo> drawDataVec = gameMap->getTileDrawData();
+    const int numTiles = static_cast<int>(gameMap->getTiles().size());
 
-    if (backBufferBMP.GetHandle() && drawDataVec.size() != 0) {
+    if (backBufferBMP.GetHandle() && numTiles != 0) {
 
         CBitmap oldBMP;
         oldBMP = backBufferDC.SelectObject(backBufferBMP);
 
-        BLENDFUNCTION fn ={ 0 };
-        fn.BlendOp = AC_SRC_OVER;
-        fn.SourceConstantAlpha = 192;
-        fn.AlphaFormat = 0;
-
         CMemDC alphaDC(dc);
         alphaDC.CreateCompatibleBitmap(dc, 1, 1);
         alphaDC.SolidFill(RGB(0, 0, 192), CRect(0, 0, 1, 1));
@@ -376,57 +431,72 @@ void GameMapPanel::updateBackBuffer() {
         lightOnDC.CreateCompatibleBitmap(dc, 1, 1);
         lightOnDC.SolidFill(RGB(255, 255, 0), CRect(0, 0, 1, 1));
 
-        // TODO: it might be better to return a reference to the entire gamemap
-        // object as well   
+        for (int i = 0; i < numTiles; ++i) {
+            drawTile(*gameMap, i, alphaDC, lightOnDC);
+        }
 
-        const int mapCols = gameMap->getWidth();
-        const int mapRows = gameMap->getHeight();
+        const int selectedRow = gameWorldController->getSelectedRow();
+        const int selectedCol = gameWorldController->getSelectedCol();
 
-        for (int k = 0; k < mapRows; ++k) {
-            for (int i = 0; i < mapCols; ++i) {
+        DrawTileSelectionBox(backBufferDC, selectedCol * scaledTileWidth,
+                             selectedRow * scaledTileHeight, scaledTileWidth,
+                             scaledTileHeight, 2);
 
-                const GameTile::DrawInfo drawInfo = drawDataVec[(k * mapCols) + i];
+        backBufferDC.SelectObject(oldBMP);
 
-                const int srcX = drawInfo.spriteIndex * tileWidth;
-                const int srcY = (drawInfo.hasGate && gameMap->isConnectedToOnSwitch(k, i))
-                                 ? (TileModifiers::GateOpen + (drawInfo.spriteModifier & TileModifiers::DirtRoad)) * tileHeight
-                                 : drawInfo.spriteModifier * tileHeight;
+    }
+     
+}
 
 
-                const int destX = i * scaledTileWidth;
-                const int destY = k * scaledTileHeight;
+///----------------------------------------------------------------------------
+/// drawTile - Draws a tile to the back buffer, which must already be
+/// selected into its DC. Whether it is lit or its gate is open comes from
+/// the map, which keeps it up to date as switches change.
+/// @param the game map
+/// @param index of the tile to draw
+/// @param DC to shade dark tiles with
+/// @param DC to shade lit tiles with
+///----------------------------------------------------------------------------
 
-                backBufferDC.StretchBlt(destX, destY, scaledTileWidth, scaledTileHeight, tilesetDC,
-                                        srcX, srcY, tileWidth, tileHeight, SRCCOPY);
+void GameMapPanel::drawTile(const GameMap& gameMap, const int& index, CMemDC& darkDC, CMemDC& lightOnDC) {
 
-                if (drawInfo.dark) {
+    BLENDFUNCTION fn ={ 0 };
+    fn.BlendOp = AC_SRC_OVER;
+    fn.SourceConstantAlpha = 192;
+    fn.AlphaFormat = 0;
 
-                    if(gameMap->isConnectedToOnSwitch(k, i)) {
-                        AlphaBlend(backBufferDC.GetHDC(), destX, destY,
-                                   scaledTileWidth, scaledTileHeight, lightOnDC, 0, 0, 1, 1, fn);
-                    }
-                    else {
-                        AlphaBlend(backBufferDC.GetHDC(), destX, destY,
-                                   scaledTileWidth, scaledTileHeight, alphaDC, 0, 0, 1, 1, fn);
-                    }
-                }
+    const GameTile::DrawInfo drawInfo = gameMap.getTile(index).getDrawInfo();
+    const uint8_t& tileState = gameMap.getTileState(index);
 
-            }
-        }
+    int row = 0;
+    int col = 0;
+    gameMap.rowColFromIndex(row, col, index);
 
-        const int selectedRow = gameWorldController->getSelectedRow();
-        const int selectedCol = gameWorldController->getSelectedCol();
+    const int srcX = drawInfo.spriteIndex * tileWidth;
+    const int srcY = (tileState & TileStateFlags::GateOpen)
+                     ? (TileModifiers::GateOpen + (drawInfo.spriteModifier & TileModifiers::DirtRoad)) * tileHeight
+                     : drawInfo.spriteModifier * tileHeight;
 
-        DrawTileSelectionBox(backBufferDC, selectedCol * scaledTileWidth,
-                             selectedRow * scaledTileHeight, scaledTileWidth,
-                             scaledTileHeight, 2);
+    const int destX = col * scaledTileWidth;
+    const int destY = row * scaledTileHeight;
 
-        backBufferDC.SelectObject(oldBMP);
+    backBufferDC.StretchBlt(destX, destY, scaledTileWidth, scaledTileHeight, tilesetDC,
+                            srcX, srcY, tileWidth, tileHeight, SRCCOPY);
 
+    if (drawInfo.dark) {
+
+        if (tileState & TileStateFlags::Lit) {
+            AlphaBlend(backBufferDC.GetHDC(), destX, destY,
+                       scaledTileWidth, scaledTileHeight, lightOnDC, 0, 0, 1, 1, fn);
+        }
+        else {
+            AlphaBlend(backBufferDC.GetHDC(), destX, destY,
+                       scaledTileWidth, scaledTileHeight, darkDC, 0, 0, 1, 1, fn);
+        }
     }
-     
-}
 
+}
 
 ///----------------------------------------------------------------------------
 /// updateScrollSize - Updates the size of the scroll bars.
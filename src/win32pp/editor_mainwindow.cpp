@@ -360,20 +360,20 @@ void MainWindowFrame::updateHereLists(const bool objectsHere, const bool charsHe
     const int& selectedRow = row ? *row : gameWorldController->getSelectedRow();
     const int& selectedCol = col ? *col : gameWorldController->getSelectedCol();
     
-    // Update the character's on the new tile.
+    // Update the character's on the new tile. Only the indices of what is
+    // here are looked up, so nothing is copied.
 
     if(objectsHere) {
-        const std::vector<GameObject>& objectVec = gameMap->getGameObjectsAtRowCol(selectedRow, selectedCol);
-        entitiesHerePanel->updateObjectList(objectVec);
+        entitiesHerePanel->updateObjectList(gameMap->getGameObjects(),
+                                            gameMap->getObjectIndicesAtRowCol(selectedRow, selectedCol));
     }
 
     if(charsHere) {
-        const std::vector<GameCharacter>& charVec = gameMap->getGameCharactersAtRowCol(selectedRow, selectedCol);   
 
         const GameInfo& gameInfo = gameMap->getGameInfo();
 
-
-        entitiesHerePanel->updateCharacterList(charVec, 
+        entitiesHerePanel->updateCharacterList(gameMap->getGameCharacters(),
+                                              gameMap->getCharacterIndicesAtRowCol(selectedRow, selectedCol),
                                               (gameInfo.getPlayerStartX() == selectedCol && 
                                                gameInfo.getPlayerStartY() == selectedRow) ? true : false);
     }
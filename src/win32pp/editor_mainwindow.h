@@ -162,6 +162,7 @@ class MainWindowFrame : public CDockFrame, public MainWindowInterface, public Wi
         virtual bool startEditTileDescriptionDialog(const std::string& name, const std::string& description);
         virtual void finishedEditTileDescriptionDialog();
         virtual void onTileUpdated(const int& index, const int& tileUpdateFlags);
+        virtual void onSwitchToggled(const int& index, const std::vector<int>& changedTiles);
 
         virtual void onSelectedTileChanged();
         virtual void onDrawingTileChanged();
@@ -136,6 +136,22 @@ void MainWindowFrame::onTileUpdated(const int& index, const int& tileUpdateFlags
 
 }
 
+///----------------------------------------------------------------------------
+/// onSwitchToggled
+///----------------------------------------------------------------------------
+
+void MainWindowFrame::onSwitchToggled(const int& index, const std::vector<int>& changedTiles) {
+
+    updateFeatureMenu(index);
+
+    std::vector<int> tilesToDraw(changedTiles);
+    tilesToDraw.push_back(index);
+    gameMapPanel->onTilesUpdated(tilesToDraw);
+
+    updateTitleBar(true);
+
+}
+
 ///----------------------------------------------------------------------------
 /// onDrawingTileChanged
 ///----------------------------------------------------------------------------
@@ -435,10 +435,13 @@ void EntitiesHerePanel::clearLists() {
 
 ///----------------------------------------------------------------------------
 /// updateCharacterList - Updates the character's here listbox.
-/// @param a pointer to a vector with the list of characters in the game world. 
+/// @param a vector with the list of characters in the game world.
+/// @param indices of the characters in the list that are on the tile
+/// @param true if the player starts on the tile
 ///----------------------------------------------------------------------------
 
-void EntitiesHerePanel::updateCharacterList(const std::vector<GameCharacter>& characterList, const bool& playerHere) {
+void EntitiesHerePanel::updateCharacterList(const std::vector<GameCharacter>& characterList,
+                                            const std::vector<size_t>& charactersHere, const bool& playerHere) {
 
     charactersHereListBox.ClearStrings();
 
@@ -450,34 +453,29 @@ void EntitiesHerePanel::updateCharacterList(const std::vector<GameCharacter>& ch
 
     }
 
-    if (!characterList.empty()) {
-        const size_t charSize = characterList.size();
-
-        for (size_t i = 0; i < charSize; ++i) {
+    const size_t charSize = charactersHere.size();
 
-            charactersHereListBox.AddString(AtoT(characterList[i].getName().c_str(), CP_UTF8));
-        }
+    for (size_t i = 0; i < charSize; ++i) {
+        charactersHereListBox.AddString(AtoT(characterList[charactersHere[i]].getName().c_str(), CP_UTF8));
     }
 
 }
 
 ///----------------------------------------------------------------------------
 /// updateObjectList - Updates the object's here listbox.
-/// @param a pointer to a vector with the list of objects in the game world. 
+/// @param a vector with the list of objects in the game world.
+/// @param indices of the objects in the list that are on the tile
 ///----------------------------------------------------------------------------
 
-void EntitiesHerePanel::updateObjectList(const std::vector<GameObject>& objectList) {
+void EntitiesHerePanel::updateObjectList(const std::vector<GameObject>& objectList,
+                                         const std::vector<size_t>& objectsHere) {
 
     objectsHereListBox.ClearStrings();
 
-    if (!objectList.empty()) {
-        const size_t objSize = objectList.size();
+    const size_t objSize = objectsHere.size();
 
-        for (size_t i = 0; i < objSize; ++i) {
-
-            objectsHereListBox.AddString(AtoT(objectList[i].getName().c_str(), CP_UTF8));
-
-        }
+    for (size_t i = 0; i < objSize; ++i) {
+        objectsHereListBox.AddString(AtoT(objectList[objectsHere[i]].getName().c_str(), CP_UTF8));
     }
 
 }
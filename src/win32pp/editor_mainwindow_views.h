@@ -172,8 +172,9 @@ class EntitiesHerePanel : public PanelBaseClass {
         virtual LRESULT WndProc(UINT msg, WPARAM wParam, LPARAM lParam);
 
         void clearLists();
-        void updateCharacterList(const std::vector<GameCharacter>& characterList, const bool& playerHere);
-        void updateObjectList(const std::vector<GameObject>& objectList);
+        void updateCharacterList(const std::vector<GameCharacter>& characterList,
+                                 const std::vector<size_t>& charactersHere, const bool& playerHere);
+        void updateObjectList(const std::vector<GameObject>& objectList, const std::vector<size_t>& objectsHere);
 
     protected:
         
@@ -268,6 +269,7 @@ class GameMapPanel : public ScrollPanelBaseClass {
         void onMapSizeChanged();
         void onNewTileSelected();
         void onTileUpdated();
+        void onTilesUpdated(const std::vector<int>& tileIndices);
         
         void setTileset(CBitmap& inTileSet);
         void updateBackBuffer();
@@ -296,6 +298,7 @@ class GameMapPanel : public ScrollPanelBaseClass {
         LRESULT onKeyDown(const WORD& vKey, const WORD& keyData);
 
         void updateScrollSize();
+        void drawTile(const GameMap& gameMap, const int& index, CMemDC& darkDC, CMemDC& lightOnDC);
 
 		// Disable copy construction and assignment operator
         GameMapPanel(const GameMapPanel&);